@@ -0,0 +1,69 @@
+//
+//  BlockingQueue.h
+//
+//  Fila limitada entre threads (produtor/consumidor). push() bloqueia
+//  quando a fila está cheia, o que segura um estágio rápido para não
+//  acumular trabalho na memória; pop() bloqueia até ter item ou até a fila
+//  ser fechada.
+//
+
+#ifndef BlockingQueue_h
+#define BlockingQueue_h
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+template <typename T>
+class BlockingQueue {
+public:
+    explicit BlockingQueue(size_t capacity = 2) : capacity(capacity ? capacity : 1), closed(false) {}
+
+    // Devolve false se a fila já foi fechada (o item é descartado)
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this] { return closed || items.size() < capacity; });
+        if (closed) return false;
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    // Devolve false quando a fila foi fechada e não há mais itens
+    bool pop(T &item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this] { return closed || !items.empty(); });
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    // Como pop(), mas sem esperar: false se a fila está vazia agora
+    bool tryPop(T &item) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    // Sem novos itens; os que estão na fila ainda podem ser retirados
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+private:
+    std::deque<T> items;
+    size_t capacity;
+    bool closed;
+    std::mutex mutex;
+    std::condition_variable notEmpty, notFull;
+};
+
+#endif /* BlockingQueue_h */
@@ -0,0 +1,41 @@
+//
+//  ColorKey.h
+//
+//  Conversão de cor-chave em alfa real no momento da carga da textura.
+//  Em vez de testar (e descartar) cada fragmento a cada quadro no shader,
+//  os pixels de fundo viram alfa 0 uma única vez, e o shader do sprite pode
+//  dispensar o discard (mantendo o early-z do hardware).
+//
+
+#ifndef ColorKey_h
+#define ColorKey_h
+
+struct ColorKeyOptions {
+    unsigned char minChannel;  // r, g e b acima disso = fundo (0.95 * 255)
+    unsigned char minAlpha;    // alfa abaixo disso = transparente (0.1 * 255)
+    bool premultiply;          // grava rgb * a (usar glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA))
+
+    ColorKeyOptions() : minChannel(242), minAlpha(26), premultiply(true) {}
+};
+
+// Processa uma imagem RGBA de 8 bits (como devolvida por stbi_load com
+// desired_channels = 4). Pixels chaveados ficam (0,0,0,0) para não vazarem
+// cor na filtragem linear e nos mipmaps.
+inline void bakeColorKey(unsigned char *rgba, int width, int height,
+                         const ColorKeyOptions &opt = ColorKeyOptions()) {
+    int length = width * height * 4;
+    for (int i = 0; i < length; i += 4) {
+        unsigned char r = rgba[i], g = rgba[i+1], b = rgba[i+2], a = rgba[i+3];
+        bool keyed = (a < opt.minAlpha) ||
+                     (r > opt.minChannel && g > opt.minChannel && b > opt.minChannel);
+        if (keyed) {
+            rgba[i] = rgba[i+1] = rgba[i+2] = rgba[i+3] = 0;
+        } else if (opt.premultiply && a != 255) {
+            rgba[i]   = (unsigned char)((r * a + 127) / 255);
+            rgba[i+1] = (unsigned char)((g * a + 127) / 255);
+            rgba[i+2] = (unsigned char)((b * a + 127) / 255);
+        }
+    }
+}
+
+#endif /* ColorKey_h */
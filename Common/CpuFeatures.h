@@ -0,0 +1,78 @@
+//
+//  CpuFeatures.h
+//
+//  Detecção em tempo de execução das extensões SIMD usadas pelos kernels
+//  vetorizados (SSE2/AVX2). Em arquiteturas não-x86 tudo cai no caminho
+//  escalar.
+//
+
+#ifndef CpuFeatures_h
+#define CpuFeatures_h
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CPU_X86 1
+#include <immintrin.h>
+#else
+#define CPU_X86 0
+#endif
+
+// SSE2 faz parte da base do x86-64; em 32 bits depende de -msse2.
+#if CPU_X86 && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define CPU_HAS_SSE2 1
+#else
+#define CPU_HAS_SSE2 0
+#endif
+
+// Permite compilar funções AVX2 isoladas sem -mavx2 no projeto inteiro.
+#if CPU_X86 && (defined(__GNUC__) || defined(__clang__))
+#define CPU_HAS_AVX2_TARGET 1
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define CPU_HAS_AVX2_TARGET 0
+#define TARGET_AVX2
+#endif
+
+enum SimdLevel {
+    SIMD_SCALAR = 0,
+    SIMD_SSE2   = 1,
+    SIMD_AVX2   = 2
+};
+
+inline const char *simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SIMD_AVX2: return "avx2";
+        case SIMD_SSE2: return "sse2";
+        default:        return "scalar";
+    }
+}
+
+inline SimdLevel detectSimdLevel() {
+#if CPU_X86 && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return SIMD_AVX2;
+    if (CPU_HAS_SSE2 && __builtin_cpu_supports("sse2")) return SIMD_SSE2;
+    return SIMD_SCALAR;
+#elif CPU_HAS_SSE2
+    return SIMD_SSE2;
+#else
+    return SIMD_SCALAR;
+#endif
+}
+
+// Nível efetivo usado pelos kernels; pode ser rebaixado (ex.: benchmarks ou
+// comparação bit-a-bit com o caminho escalar) mas nunca acima do suportado.
+inline SimdLevel &activeSimdLevelRef() {
+    static SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+inline SimdLevel activeSimdLevel() {
+    return activeSimdLevelRef();
+}
+
+inline void setSimdLevel(SimdLevel level) {
+    SimdLevel supported = detectSimdLevel();
+    activeSimdLevelRef() = level < supported ? level : supported;
+}
+
+#endif /* CpuFeatures_h */
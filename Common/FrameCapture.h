@@ -0,0 +1,111 @@
+//
+//  FrameCapture.h
+//
+//  Modo de captura dos demos para os testes de regressão (golden_check):
+//
+//      demo --capture DIR [--frames N] [--every K] [--headless]
+//
+//  Roda N quadros com relógio fixo (1/60 s por quadro, sem depender do
+//  tempo real), sem teclado, numa janela invisível, e grava em DIR o
+//  framebuffer de cada K-ésimo quadro e do último como <demo>_<quadro>.ppm.
+//  Com --headless usa a plataforma nula da GLFW 3.4 com OSMesa, como o
+//  sprite_bench, para rodar sem servidor gráfico.
+//
+//  Uso nos demos: parse() antes do glfwInit, windowHints() antes do
+//  glfwCreateWindow, time() no lugar do glfwGetTime e endFrame() depois
+//  de desenhar e antes do glfwSwapBuffers.
+//
+
+#ifndef FrameCapture_h
+#define FrameCapture_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+class FrameCapture {
+public:
+    static constexpr double FRAME_DT = 1.0 / 60.0;
+
+    FrameCapture() : frames(60), every(0), frame(0), headless(false) {}
+
+    // Lê as opções de captura; as demais ficam para o demo
+    void parse(int argc, char **argv, const std::string &demoName) {
+        name = demoName;
+        for (int i = 1; i < argc; i++) {
+            std::string a = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (a == "--capture" && hasValue) dir = argv[++i];
+            else if (a == "--frames" && hasValue) frames = atoi(argv[++i]);
+            else if (a == "--every" && hasValue) every = atoi(argv[++i]);
+            else if (a == "--headless") headless = true;
+        }
+        if (frames < 1) frames = 1;
+        if (active() && headless) glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    }
+
+    bool active() const { return !dir.empty(); }
+
+    void windowHints() const {
+        if (!active()) return;
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        if (headless) glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+    }
+
+    // Tempo do quadro atual: fixo na captura, real fora dela
+    double time() const { return active() ? frame * FRAME_DT : glfwGetTime(); }
+
+    // Teclas e mouse são ignorados durante a captura
+    bool inputEnabled() const { return !active(); }
+
+    // Lê o quadro desenhado e o grava se for a vez dele. Devolve false
+    // depois do último quadro (o demo sai do laço) ou se a gravação falhar.
+    bool endFrame(GLFWwindow *window) {
+        if (!active()) return true;
+        frame++;
+        if (frame == frames || (every > 0 && frame % every == 0)) {
+            int w, h;
+            glfwGetFramebufferSize(window, &w, &h);
+            char suffix[32];
+            snprintf(suffix, sizeof(suffix), "_%04d.ppm", frame);
+            std::string path = dir + "/" + name + suffix;
+            if (!save(path, w, h)) {
+                fprintf(stderr, "Erro ao gravar %s\n", path.c_str());
+                glfwSetWindowShouldClose(window, 1);
+                return false;
+            }
+        }
+        if (frame >= frames) {
+            glfwSetWindowShouldClose(window, 1);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    std::string dir, name;
+    int frames, every, frame;
+    bool headless;
+
+    // Back buffer -> P6, de cima para baixo
+    static bool save(const std::string &path, int w, int h) {
+        std::vector<unsigned char> pixels((size_t)w * h * 3);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glReadBuffer(GL_BACK);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+        FILE *f = fopen(path.c_str(), "wb");
+        if (!f) return false;
+        bool ok = fprintf(f, "P6\n%d %d\n255\n", w, h) > 0;
+        size_t rowBytes = (size_t)w * 3;
+        for (int y = h - 1; y >= 0 && ok; y--) ok = fwrite(&pixels[rowBytes * y], 1, rowBytes, f) == rowBytes;
+        return fclose(f) == 0 && ok;
+    }
+};
+
+#endif /* FrameCapture_h */
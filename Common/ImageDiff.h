@@ -0,0 +1,200 @@
+//
+//  ImageDiff.h
+//
+//  Comparação de imagens de 8 bits com tolerância, para os testes de
+//  regressão de render (golden_check). Cada linha passa por um laço SIMD
+//  que calcula |a - b| de 16 (SSE2) ou 32 (AVX2) bytes por vez e acumula a
+//  soma (psadbw), o máximo e quantos bytes passam da tolerância. Só as
+//  linhas com algum byte fora da tolerância são revisitadas pixel a pixel
+//  para contar os pixels diferentes, então quadros iguais ou quase iguais
+//  custam uma leitura de cada imagem.
+//
+//  O mapa de calor mostra a referência escurecida em cinza e, por cima, os
+//  pixels fora da tolerância de vermelho (pouca diferença) a amarelo
+//  (diferença máxima).
+//
+
+#ifndef ImageDiff_h
+#define ImageDiff_h
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "CpuFeatures.h"
+#include "ThreadPool.h"
+
+#if CPU_HAS_SSE2
+#include <emmintrin.h>
+#endif
+#if CPU_HAS_AVX2_TARGET
+#include <immintrin.h>
+#endif
+
+// Resultado de um trecho de bytes
+struct ByteDiff {
+    uint64_t sum;  // soma de |a - b|
+    int maxDiff;
+    size_t over;   // bytes com |a - b| > tolerância
+
+    ByteDiff() : sum(0), maxDiff(0), over(0) {}
+};
+
+inline int countBits32(uint32_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcount(v);
+#else
+    int n = 0;
+    for (; v; v &= v - 1) n++;
+    return n;
+#endif
+}
+
+inline void diffBytesScalar(const unsigned char *a, const unsigned char *b, size_t n, int tolerance, ByteDiff &r) {
+    for (size_t i = 0; i < n; i++) {
+        int d = a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+        r.sum += (uint64_t)d;
+        if (d > r.maxDiff) r.maxDiff = d;
+        r.over += d > tolerance;
+    }
+}
+
+#if CPU_HAS_SSE2
+inline void diffBytesSSE2(const unsigned char *a, const unsigned char *b, size_t n, int tolerance, ByteDiff &r) {
+    const __m128i zero = _mm_setzero_si128(), tol = _mm_set1_epi8((char)tolerance);
+    __m128i sum = zero, mx = zero;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i)), vb = _mm_loadu_si128((const __m128i *)(b + i));
+        __m128i d = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(d, zero));
+        mx = _mm_max_epu8(mx, d);
+        // bytes em que d - tolerância não satura em 0
+        r.over += (size_t)countBits32(~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(d, tol), zero)) & 0xffff);
+    }
+    uint64_t lanes[2];
+    unsigned char bytes[16];
+    _mm_storeu_si128((__m128i *)lanes, sum);
+    _mm_storeu_si128((__m128i *)bytes, mx);
+    r.sum += lanes[0] + lanes[1];
+    for (int k = 0; k < 16; k++) r.maxDiff = bytes[k] > r.maxDiff ? bytes[k] : r.maxDiff;
+    diffBytesScalar(a + i, b + i, n - i, tolerance, r);
+}
+#endif
+
+#if CPU_HAS_AVX2_TARGET
+inline TARGET_AVX2 void diffBytesAVX2(const unsigned char *a, const unsigned char *b, size_t n, int tolerance, ByteDiff &r) {
+    const __m256i zero = _mm256_setzero_si256(), tol = _mm256_set1_epi8((char)tolerance);
+    __m256i sum = zero, mx = zero;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + i)), vb = _mm256_loadu_si256((const __m256i *)(b + i));
+        __m256i d = _mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va));
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(d, zero));
+        mx = _mm256_max_epu8(mx, d);
+        r.over += (size_t)countBits32(~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_subs_epu8(d, tol), zero)));
+    }
+    uint64_t lanes[4];
+    unsigned char bytes[32];
+    _mm256_storeu_si256((__m256i *)lanes, sum);
+    _mm256_storeu_si256((__m256i *)bytes, mx);
+    r.sum += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (int k = 0; k < 32; k++) r.maxDiff = bytes[k] > r.maxDiff ? bytes[k] : r.maxDiff;
+    diffBytesScalar(a + i, b + i, n - i, tolerance, r);
+}
+#endif
+
+inline void diffBytes(const unsigned char *a, const unsigned char *b, size_t n, int tolerance, ByteDiff &r) {
+    switch (activeSimdLevel()) {
+#if CPU_HAS_AVX2_TARGET
+        case SIMD_AVX2: diffBytesAVX2(a, b, n, tolerance, r); return;
+#endif
+#if CPU_HAS_SSE2
+        case SIMD_SSE2: diffBytesSSE2(a, b, n, tolerance, r); return;
+#endif
+        default: diffBytesScalar(a, b, n, tolerance, r);
+    }
+}
+
+// Pixels com algum canal fora da tolerância numa linha
+inline size_t countDifferentPixels(const unsigned char *a, const unsigned char *b, int w, int channels, int tolerance) {
+    size_t n = 0;
+    for (int x = 0; x < w; x++) {
+        for (int c = 0; c < channels; c++) {
+            int d = a[x * channels + c] - b[x * channels + c];
+            if (d > tolerance || -d > tolerance) {
+                n++;
+                break;
+            }
+        }
+    }
+    return n;
+}
+
+struct ImageDiffStats {
+    size_t pixels, different; // pixels com algum canal acima da tolerância
+    int maxDiff;
+    double meanDiff;          // média de |a - b| por amostra
+
+    ImageDiffStats() : pixels(0), different(0), maxDiff(0), meanDiff(0.0) {}
+};
+
+// Compara a e b (w x h, channels intercalados, linhas coladas) em faixas de
+// linhas, em paralelo se houver pool. tolerance em 0..255 por canal.
+inline ImageDiffStats compareImages(const unsigned char *a, const unsigned char *b, int w, int h, int channels,
+                                    int tolerance, ThreadPool *pool = NULL) {
+    const int BAND = 64;
+    size_t rowBytes = (size_t)w * channels, bands = (size_t)(h + BAND - 1) / BAND;
+    std::vector<ByteDiff> bandDiff(bands);
+    std::vector<size_t> bandPixels(bands, 0);
+    auto band = [&](size_t k) {
+        int y1 = (int)(k + 1) * BAND < h ? (int)(k + 1) * BAND : h;
+        for (int y = (int)k * BAND; y < y1; y++) {
+            const unsigned char *ra = a + rowBytes * y, *rb = b + rowBytes * y;
+            size_t before = bandDiff[k].over;
+            diffBytes(ra, rb, rowBytes, tolerance, bandDiff[k]);
+            if (bandDiff[k].over != before) bandPixels[k] += countDifferentPixels(ra, rb, w, channels, tolerance);
+        }
+    };
+    if (pool) {
+        pool->run(bands, band);
+    } else {
+        for (size_t k = 0; k < bands; k++) band(k);
+    }
+
+    ImageDiffStats s;
+    uint64_t sum = 0;
+    s.pixels = (size_t)w * h;
+    for (size_t k = 0; k < bands; k++) {
+        sum += bandDiff[k].sum;
+        s.maxDiff = bandDiff[k].maxDiff > s.maxDiff ? bandDiff[k].maxDiff : s.maxDiff;
+        s.different += bandPixels[k];
+    }
+    s.meanDiff = s.pixels ? (double)sum / ((double)s.pixels * channels) : 0.0;
+    return s;
+}
+
+// Mapa de calor RGB (w x h x 3) da diferença entre a (referência) e b
+inline void diffHeatmap(const unsigned char *a, const unsigned char *b, int w, int h, int channels, int tolerance,
+                        std::vector<unsigned char> &rgb) {
+    rgb.resize((size_t)w * h * 3);
+    for (size_t i = 0; i < (size_t)w * h; i++) {
+        const unsigned char *pa = a + i * channels, *pb = b + i * channels;
+        int d = 0, sum = 0;
+        for (int c = 0; c < channels; c++) {
+            int v = pa[c] > pb[c] ? pa[c] - pb[c] : pb[c] - pa[c];
+            d = v > d ? v : d;
+            sum += pa[c];
+        }
+        unsigned char *out = &rgb[i * 3];
+        if (d > tolerance) {
+            out[0] = 255;
+            out[1] = (unsigned char)((d - tolerance) * 255 / (255 - tolerance));
+            out[2] = 0;
+        } else {
+            out[0] = out[1] = out[2] = (unsigned char)(sum / channels / 4);
+        }
+    }
+}
+
+#endif /* ImageDiff_h */
@@ -0,0 +1,70 @@
+//
+//  DiamondView.h
+//  ExercSlidemap
+//
+//  Mapa isométrico em losango: a coluna anda para nordeste e a linha para
+//  sudeste, então o tile (0,0) fica no canto da esquerda do losango.
+//
+
+#ifndef DiamondView_h
+#define DiamondView_h
+
+#include "TilemapView.h"
+#include <math.h>
+
+class DiamondView : public TilemapView {
+public:
+    // Canto inferior esquerdo do retângulo do tile (tw x th)
+    void computeDrawPosition(const int col, const int row, const float tw, const float th, float &targetx, float &targety) const {
+        targetx = (col + row) * tw / 2;
+        targety = (col - row) * th / 2;
+    }
+
+    // Inversa de computeDrawPosition: em coordenadas giradas o losango do
+    // tile vira um quadrado unitário centrado em (col, row)
+    void computeMouseMap(int &col, int &row, const float tw, const float th, const float mx, const float my) const {
+        float tw2 = tw / 2.0f;
+        float th2 = th / 2.0f;
+
+        float u = (mx - tw2) / tw2; // col + row
+        float v = (my - th2) / th2; // col - row
+        col = (int)floorf((u + v) / 2.0f + 0.5f);
+        row = (int)floorf((u - v) / 2.0f + 0.5f);
+    }
+
+    void computeTileWalking(int &col, int &row, const int direction) const {
+        switch(direction){
+            case DIRECTION_NORTH:
+                col++;
+                row--;
+                break;
+            case DIRECTION_EAST:
+                col++;
+                row++;
+                break;
+            case DIRECTION_SOUTH:
+                col--;
+                row++;
+                break;
+            case DIRECTION_WEST:
+                col--;
+                row--;
+                break;
+            case DIRECTION_NORTHEAST:
+                col++;
+                break;
+            case DIRECTION_SOUTHEAST:
+                row++;
+                break;
+            case DIRECTION_SOUTHWEST:
+                col--;
+                break;
+            case DIRECTION_NORTHWEST:
+                row--;
+                break;
+        }
+    }
+
+};
+
+#endif /* DiamondView_h */
@@ -0,0 +1,572 @@
+//
+//  Resize.h
+//
+//  Redimensionamento de imagens de 8 bits (1 a 4 canais intercalados) e
+//  geração da cadeia de mipmaps na CPU, para as ferramentas de imagem e
+//  para os carregadores de textura (no lugar de glGenerateMipmap).
+//
+//  Filtros separáveis em float: caixa (cobertura de área), bilinear
+//  (tenda) e Lanczos-3, alargados na redução para não serrilhar. Com sRGB
+//  as cores são filtradas em luz linear (o alfa, quando existe, já é
+//  linear); é o que mantém o brilho médio dos mipmaps.
+//
+//  SIMD (SSE2/AVX2): a passada vertical para qualquer número de canais; a
+//  horizontal e a conversão para bytes só para RGBA (1 a 3 canais ficam
+//  no escalar).
+//
+//  - resizeImage: faixas de linhas de saída independentes (cada uma refaz
+//    as linhas horizontais de que precisa, como o halo do Stream.h) cujo
+//    buffer intermediário cabe no cache; as faixas podem ir para um
+//    ThreadPool e o resultado não depende do número de threads.
+//  - buildMipChain: uma única passada pela imagem original. Cada linha de
+//    um nível, ao ficar pronta, já alimenta o nível seguinte, e cada nível
+//    guarda só as poucas linhas que o filtro vertical usa. Todos os níveis
+//    saem da imagem em float, sem arredondar o nível anterior para 8 bits.
+//    Tamanhos ímpares usam a caixa com cobertura fracionária (nenhum pixel
+//    da borda é descartado).
+//
+
+#ifndef Resize_h
+#define Resize_h
+
+#include <math.h>
+#include <string.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "CpuFeatures.h"
+#include "ThreadPool.h"
+
+enum ResizeFilter {
+    RESIZE_BOX,
+    RESIZE_BILINEAR,
+    RESIZE_LANCZOS
+};
+
+inline const char *resizeFilterName(ResizeFilter filter) {
+    switch (filter) {
+        case RESIZE_BOX:      return "box";
+        case RESIZE_BILINEAR: return "bilinear";
+        default:              return "lanczos";
+    }
+}
+
+inline bool parseResizeFilter(const std::string &name, ResizeFilter &filter) {
+    if (name == "box") filter = RESIZE_BOX;
+    else if (name == "bilinear") filter = RESIZE_BILINEAR;
+    else if (name == "lanczos") filter = RESIZE_LANCZOS;
+    else return false;
+    return true;
+}
+
+// Buffer intermediário de cada faixa do resizeImage
+const size_t RESIZE_BAND_BYTES = 128 << 10;
+const int RESIZE_MIN_BAND = 16;
+
+/*------------------------------ sRGB <-> linear -----------------------------*/
+
+const int LINEAR_TO_SRGB_SIZE = 16384;
+
+inline const float *srgbToLinearTable() {
+    static const std::vector<float> table = [] {
+        std::vector<float> t(256);
+        for (int i = 0; i < 256; i++) {
+            double c = i / 255.0;
+            t[i] = (float)(c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4));
+        }
+        return t;
+    }();
+    return table.data();
+}
+
+// Índice = linear * (LINEAR_TO_SRGB_SIZE - 1) arredondado
+inline const unsigned char *linearToSrgbTable() {
+    static const std::vector<unsigned char> table = [] {
+        std::vector<unsigned char> t(LINEAR_TO_SRGB_SIZE);
+        for (int i = 0; i < LINEAR_TO_SRGB_SIZE; i++) {
+            double l = (double)i / (LINEAR_TO_SRGB_SIZE - 1);
+            double c = l <= 0.0031308 ? l * 12.92 : 1.055 * pow(l, 1.0 / 2.4) - 0.055;
+            t[i] = (unsigned char)(c * 255.0 + 0.5);
+        }
+        return t;
+    }();
+    return table.data();
+}
+
+// O último canal de imagens com 2 ou 4 canais é alfa e fica linear
+inline bool resizeChannelIsColor(int c, int channels, bool srgb) {
+    return srgb && !((channels == 2 || channels == 4) && c == channels - 1);
+}
+
+inline const float *byteToUnitTable() {
+    static const std::vector<float> table = [] {
+        std::vector<float> t(256);
+        for (int i = 0; i < 256; i++) t[i] = i * (1.0f / 255.0f);
+        return t;
+    }();
+    return table.data();
+}
+
+inline void bytesToFloat(const unsigned char *in, float *out, int pixels, int channels, bool srgb) {
+    const float *lut[4];
+    for (int c = 0; c < channels; c++) {
+        lut[c] = resizeChannelIsColor(c, channels, srgb) ? srgbToLinearTable() : byteToUnitTable();
+    }
+    if (channels == 4) {
+        for (int i = 0; i < pixels; i++, in += 4, out += 4) {
+            out[0] = lut[0][in[0]]; out[1] = lut[1][in[1]]; out[2] = lut[2][in[2]]; out[3] = lut[3][in[3]];
+        }
+        return;
+    }
+    for (int i = 0; i < pixels; i++) {
+        for (int c = 0; c < channels; c++, in++, out++) *out = lut[c][*in];
+    }
+}
+
+// Índices já limitados a 0..scale: tabela sRGB para cor, o próprio índice
+// para canais lineares
+inline void indexToBytes(const int *k, unsigned char *out, int n, int channels, bool srgb) {
+    const unsigned char *lut = linearToSrgbTable();
+    if (channels == 4 && srgb) {
+        for (int i = 0; i < n; i += 4) {
+            out[i] = lut[k[i]]; out[i+1] = lut[k[i+1]]; out[i+2] = lut[k[i+2]]; out[i+3] = (unsigned char)k[i+3];
+        }
+        return;
+    }
+    bool color[4];
+    for (int c = 0; c < channels; c++) color[c] = resizeChannelIsColor(c, channels, srgb);
+    for (int i = 0, c = 0; i < n; i++, c = c + 1 == channels ? 0 : c + 1) {
+        out[i] = color[c] ? lut[k[i]] : (unsigned char)k[i];
+    }
+}
+
+inline void floatToBytesScalar(const float *in, unsigned char *out, int pixels, int channels, bool srgb) {
+    float scale[4];
+    for (int c = 0; c < channels; c++) {
+        scale[c] = resizeChannelIsColor(c, channels, srgb) ? (float)(LINEAR_TO_SRGB_SIZE - 1) : 255.0f;
+    }
+    int n = pixels * channels, k[64];
+    for (int i0 = 0; i0 < n; i0 += 64) {
+        int m = n - i0 < 64 ? n - i0 : 64;
+        for (int i = 0; i < m; i++) {
+            float v = in[i0 + i];
+            v = v < 0.0f ? 0.0f : v > 1.0f ? 1.0f : v;
+            k[i] = (int)(v * scale[(i0 + i) % channels] + 0.5f);
+        }
+        indexToBytes(k, out + i0, m, channels, srgb);
+    }
+}
+
+#if CPU_HAS_SSE2
+// RGBA: limita, escala e converte quatro amostras (um pixel) por vez;
+// só a busca na tabela sRGB fica escalar
+inline void floatToBytesRGBA_SSE2(const float *in, unsigned char *out, int pixels, bool srgb) {
+    float s = srgb ? (float)(LINEAR_TO_SRGB_SIZE - 1) : 255.0f;
+    const __m128 scale = _mm_setr_ps(s, s, s, 255.0f), half = _mm_set1_ps(0.5f);
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+    if (!srgb) {
+        for (int p = 0; p < pixels; p++) {
+            __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + (size_t)p * 4), zero), one);
+            __m128i i32 = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half));
+            __m128i i16 = _mm_packs_epi32(i32, i32);
+            int packed = _mm_cvtsi128_si32(_mm_packus_epi16(i16, i16));
+            memcpy(out + (size_t)p * 4, &packed, 4);
+        }
+        return;
+    }
+    alignas(16) int k[64];
+    for (int p0 = 0; p0 < pixels; p0 += 16) {
+        int m = pixels - p0 < 16 ? pixels - p0 : 16;
+        for (int p = 0; p < m; p++) {
+            __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + (size_t)(p0 + p) * 4), zero), one);
+            _mm_store_si128((__m128i *)(k + p * 4), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half)));
+        }
+        indexToBytes(k, out + (size_t)p0 * 4, m * 4, 4, srgb);
+    }
+}
+#endif
+
+#if CPU_HAS_AVX2_TARGET
+// RGBA: como o SSE2, com dois pixels por registrador
+inline TARGET_AVX2 void floatToBytesRGBA_AVX2(const float *in, unsigned char *out, int pixels, bool srgb) {
+    float s = srgb ? (float)(LINEAR_TO_SRGB_SIZE - 1) : 255.0f;
+    const __m256 scale = _mm256_setr_ps(s, s, s, 255.0f, s, s, s, 255.0f), half = _mm256_set1_ps(0.5f);
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+    int p = 0;
+    if (!srgb) {
+        for (; p + 2 <= pixels; p += 2) {
+            __m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + (size_t)p * 4), zero), one);
+            __m256i i32 = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(v, scale), half));
+            __m128i i16 = _mm_packs_epi32(_mm256_castsi256_si128(i32), _mm256_extracti128_si256(i32, 1));
+            _mm_storel_epi64((__m128i *)(out + (size_t)p * 4), _mm_packus_epi16(i16, i16));
+        }
+        floatToBytesScalar(in + (size_t)p * 4, out + (size_t)p * 4, pixels - p, 4, srgb);
+        return;
+    }
+    alignas(32) int k[64];
+    for (int p0 = 0; p0 < pixels; p0 += 16) {
+        int m = pixels - p0 < 16 ? pixels - p0 : 16;
+        for (p = 0; p + 2 <= m; p += 2) {
+            __m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + (size_t)(p0 + p) * 4), zero), one);
+            _mm256_store_si256((__m256i *)(k + p * 4), _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(v, scale), half)));
+        }
+        if (p < m) {
+            __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + (size_t)(p0 + p) * 4), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+            __m128 sc = _mm_setr_ps(s, s, s, 255.0f);
+            _mm_store_si128((__m128i *)(k + p * 4), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, sc), _mm_set1_ps(0.5f))));
+        }
+        indexToBytes(k, out + (size_t)p0 * 4, m * 4, 4, srgb);
+    }
+}
+#endif
+
+// Só RGBA tem caminho SIMD; com 1 a 3 canais a conversão é escalar
+inline void floatToBytes(const float *in, unsigned char *out, int pixels, int channels, bool srgb) {
+    if (channels == 4) {
+        switch (activeSimdLevel()) {
+#if CPU_HAS_AVX2_TARGET
+            case SIMD_AVX2: floatToBytesRGBA_AVX2(in, out, pixels, srgb); return;
+#endif
+#if CPU_HAS_SSE2
+            case SIMD_SSE2: floatToBytesRGBA_SSE2(in, out, pixels, srgb); return;
+#endif
+            default: break;
+        }
+    }
+    floatToBytesScalar(in, out, pixels, channels, srgb);
+}
+
+/*---------------------------------- pesos ----------------------------------*/
+
+// Para cada pixel de saída: primeira entrada e taps pesos (zeros no fim
+// quando o pixel usa menos entradas). Bordas repetem o pixel da borda.
+struct ResizeWeights {
+    int taps;
+    std::vector<int> first, count;
+    std::vector<float> weights; // [saída * taps + k]
+
+    const float *of(int o) const { return &weights[(size_t)o * taps]; }
+};
+
+inline double resizeKernel(ResizeFilter filter, double x) {
+    x = fabs(x);
+    if (filter == RESIZE_BILINEAR) return x < 1.0 ? 1.0 - x : 0.0;
+    if (x < 1e-8) return 1.0;
+    if (x >= 3.0) return 0.0;
+    double px = 3.14159265358979323846 * x;
+    return 3.0 * sin(px) * sin(px / 3.0) / (px * px);
+}
+
+inline ResizeWeights resizeWeights(int srcSize, int dstSize, ResizeFilter filter) {
+    double scale = (double)dstSize / srcSize;
+    double fs = scale < 1.0 ? 1.0 / scale : 1.0; // largura do filtro em pixels de entrada
+    double support = (filter == RESIZE_BOX ? 0.5 : filter == RESIZE_BILINEAR ? 1.0 : 3.0) * fs;
+
+    std::vector<std::vector<double> > all(dstSize);
+    std::vector<int> first(dstSize);
+    int taps = 1;
+    for (int o = 0; o < dstSize; o++) {
+        double center = (o + 0.5) / scale;
+        int lo = (int)floor(center - support), hi = (int)ceil(center + support);
+        int a = lo < 0 ? 0 : lo, b = hi > srcSize ? srcSize : hi;
+        if (b <= a) { a = lo < srcSize ? (lo < 0 ? 0 : lo) : srcSize - 1; b = a + 1; }
+        std::vector<double> w(b - a, 0.0);
+        double sum = 0.0;
+        for (int i = lo; i < hi; i++) {
+            double v;
+            if (filter == RESIZE_BOX) {
+                // cobertura de [i, i+1) pela caixa [center - fs/2, center + fs/2)
+                double l = center - 0.5 * fs, r = center + 0.5 * fs;
+                v = (r < i + 1 ? r : i + 1) - (l > i ? l : i);
+                if (v < 0.0) v = 0.0;
+            } else {
+                v = resizeKernel(filter, (i + 0.5 - center) / fs);
+            }
+            int k = i < a ? a : i >= b ? b - 1 : i;
+            w[k - a] += v;
+            sum += v;
+        }
+        size_t s0 = 0, s1 = w.size();
+        while (s0 + 1 < s1 && fabs(w[s0]) < 1e-9) s0++;
+        while (s1 > s0 + 1 && fabs(w[s1 - 1]) < 1e-9) s1--;
+        if (fabs(sum) < 1e-12) sum = 1.0;
+        a += (int)s0;
+        b = a + (int)(s1 - s0);
+        first[o] = a;
+        all[o].assign(w.begin() + s0, w.begin() + s1);
+        for (double &v : all[o]) v /= sum;
+        if (b - a > taps) taps = b - a;
+    }
+
+    ResizeWeights r;
+    r.taps = taps;
+    r.first = first;
+    r.count.resize(dstSize);
+    r.weights.assign((size_t)dstSize * taps, 0.0f);
+    for (int o = 0; o < dstSize; o++) {
+        r.count[o] = (int)all[o].size();
+        for (int k = 0; k < r.count[o]; k++) r.weights[(size_t)o * taps + k] = (float)all[o][k];
+    }
+    return r;
+}
+
+/*---------------------------- kernels por linha ----------------------------*/
+
+// Horizontal: out[o] = soma_k w[o][k] * in[first[o] + k], por canal
+inline void resampleRowScalar(const float *in, float *out, int dstWidth, int channels, const ResizeWeights &wx) {
+    for (int o = 0; o < dstWidth; o++) {
+        const float *w = wx.of(o), *p = in + (size_t)wx.first[o] * channels;
+        for (int c = 0; c < channels; c++) {
+            float acc = 0.0f;
+            for (int k = 0; k < wx.count[o]; k++) acc += w[k] * p[k * channels + c];
+            out[o * channels + c] = acc;
+        }
+    }
+}
+
+#if CPU_HAS_SSE2
+// RGBA: um pixel por registrador, mesma ordem de somas do escalar
+inline void resampleRowRGBA_SSE2(const float *in, float *out, int dstWidth, const ResizeWeights &wx) {
+    for (int o = 0; o < dstWidth; o++) {
+        const float *w = wx.of(o), *p = in + (size_t)wx.first[o] * 4;
+        __m128 acc = _mm_setzero_ps();
+        for (int k = 0; k < wx.count[o]; k++) {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[k]), _mm_loadu_ps(p + k * 4)));
+        }
+        _mm_storeu_ps(out + o * 4, acc);
+    }
+}
+#endif
+
+#if CPU_HAS_AVX2_TARGET
+// RGBA: dois pixels de saída por registrador (um em cada metade). Os taps
+// além do menor dos dois count seguem só na metade que ainda os usa. Com
+// FMA, como resampleColumnsAVX2: pode diferir do SSE2 no último bit.
+inline TARGET_AVX2 void resampleRowRGBA_AVX2(const float *in, float *out, int dstWidth, const ResizeWeights &wx) {
+    int o = 0;
+    for (; o + 2 <= dstWidth; o += 2) {
+        const float *w0 = wx.of(o), *w1 = wx.of(o + 1);
+        const float *p0 = in + (size_t)wx.first[o] * 4, *p1 = in + (size_t)wx.first[o + 1] * 4;
+        int c0 = wx.count[o], c1 = wx.count[o + 1], both = c0 < c1 ? c0 : c1;
+        __m256 acc = _mm256_setzero_ps();
+        int k = 0;
+        for (; k < both; k++) {
+            __m256 v = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p0 + k * 4)), _mm_loadu_ps(p1 + k * 4), 1);
+            __m256 wk = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(w0[k])), _mm_set1_ps(w1[k]), 1);
+            acc = _mm256_fmadd_ps(wk, v, acc);
+        }
+        __m128 a0 = _mm256_castps256_ps128(acc), a1 = _mm256_extractf128_ps(acc, 1);
+        for (int j = k; j < c0; j++) a0 = _mm_fmadd_ps(_mm_set1_ps(w0[j]), _mm_loadu_ps(p0 + j * 4), a0);
+        for (int j = k; j < c1; j++) a1 = _mm_fmadd_ps(_mm_set1_ps(w1[j]), _mm_loadu_ps(p1 + j * 4), a1);
+        _mm_storeu_ps(out + o * 4, a0);
+        _mm_storeu_ps(out + o * 4 + 4, a1);
+    }
+    if (o < dstWidth) {
+        const float *w = wx.of(o), *p = in + (size_t)wx.first[o] * 4;
+        __m128 acc = _mm_setzero_ps();
+        for (int k = 0; k < wx.count[o]; k++) acc = _mm_fmadd_ps(_mm_set1_ps(w[k]), _mm_loadu_ps(p + k * 4), acc);
+        _mm_storeu_ps(out + o * 4, acc);
+    }
+}
+#endif
+
+// Só RGBA tem caminho SIMD na horizontal; a vertical (resampleColumns) é
+// vetorizada para qualquer número de canais
+inline void resampleRow(const float *in, float *out, int dstWidth, int channels, const ResizeWeights &wx) {
+    if (channels == 4) {
+        switch (activeSimdLevel()) {
+#if CPU_HAS_AVX2_TARGET
+            case SIMD_AVX2: resampleRowRGBA_AVX2(in, out, dstWidth, wx); return;
+#endif
+#if CPU_HAS_SSE2
+            case SIMD_SSE2: resampleRowRGBA_SSE2(in, out, dstWidth, wx); return;
+#endif
+            default: break;
+        }
+    }
+    resampleRowScalar(in, out, dstWidth, channels, wx);
+}
+
+// Vertical: out[i] = soma_k w[k] * rows[k][i]
+inline void resampleColumnsScalar(const float *const *rows, const float *w, int taps, float *out, int n) {
+    for (int i = 0; i < n; i++) {
+        float acc = 0.0f;
+        for (int k = 0; k < taps; k++) acc += w[k] * rows[k][i];
+        out[i] = acc;
+    }
+}
+
+#if CPU_HAS_SSE2
+inline void resampleColumnsSSE2(const float *const *rows, const float *w, int taps, float *out, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 acc = _mm_setzero_ps();
+        for (int k = 0; k < taps; k++) {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[k]), _mm_loadu_ps(rows[k] + i)));
+        }
+        _mm_storeu_ps(out + i, acc);
+    }
+    for (; i < n; i++) {
+        float acc = 0.0f;
+        for (int k = 0; k < taps; k++) acc += w[k] * rows[k][i];
+        out[i] = acc;
+    }
+}
+#endif
+
+#if CPU_HAS_AVX2_TARGET
+inline TARGET_AVX2 void resampleColumnsAVX2(const float *const *rows, const float *w, int taps, float *out, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 acc = _mm256_setzero_ps();
+        for (int k = 0; k < taps; k++) {
+            acc = _mm256_fmadd_ps(_mm256_set1_ps(w[k]), _mm256_loadu_ps(rows[k] + i), acc);
+        }
+        _mm256_storeu_ps(out + i, acc);
+    }
+    for (; i < n; i++) {
+        float acc = 0.0f;
+        for (int k = 0; k < taps; k++) acc = fmaf(w[k], rows[k][i], acc);
+        out[i] = acc;
+    }
+}
+#endif
+
+inline void resampleColumns(const float *const *rows, const float *w, int taps, float *out, int n) {
+    switch (activeSimdLevel()) {
+#if CPU_HAS_AVX2_TARGET
+        case SIMD_AVX2: resampleColumnsAVX2(rows, w, taps, out, n); return;
+#endif
+#if CPU_HAS_SSE2
+        case SIMD_SSE2: resampleColumnsSSE2(rows, w, taps, out, n); return;
+#endif
+        default: resampleColumnsScalar(rows, w, taps, out, n);
+    }
+}
+
+/*------------------------------- redimensionar ------------------------------*/
+
+// src (sw x sh) -> dst (dw x dh), channels canais. pool = NULL roda na
+// thread chamadora.
+inline void resizeImage(const unsigned char *src, int sw, int sh, unsigned char *dst, int dw, int dh,
+                        int channels, ResizeFilter filter, bool srgb, ThreadPool *pool = NULL) {
+    ResizeWeights wx = resizeWeights(sw, dw, filter), wy = resizeWeights(sh, dh, filter);
+    size_t rowFloats = (size_t)dw * channels;
+
+    // linhas de saída por faixa: as linhas horizontais que a faixa usa cabem
+    // em RESIZE_BAND_BYTES, mas com pelo menos RESIZE_MIN_BAND linhas para
+    // que as linhas refeitas nas bordas da faixa não dominem
+    int budgetRows = (int)(RESIZE_BAND_BYTES / (rowFloats * sizeof(float)));
+    int band = (int)((double)(budgetRows - wy.taps) * dh / sh);
+    if (band < RESIZE_MIN_BAND) band = RESIZE_MIN_BAND;
+    size_t bands = (size_t)(dh + band - 1) / band;
+
+    auto runBand = [&](size_t b) {
+        int o0 = (int)b * band, o1 = o0 + band < dh ? o0 + band : dh;
+        int y0 = sh, y1 = 0;
+        for (int o = o0; o < o1; o++) {
+            if (wy.first[o] < y0) y0 = wy.first[o];
+            if (wy.first[o] + wy.count[o] > y1) y1 = wy.first[o] + wy.count[o];
+        }
+        std::vector<float> line((size_t)sw * channels), rows((size_t)(y1 - y0) * rowFloats), out(rowFloats);
+        for (int y = y0; y < y1; y++) {
+            bytesToFloat(src + (size_t)y * sw * channels, line.data(), sw, channels, srgb);
+            resampleRow(line.data(), &rows[(size_t)(y - y0) * rowFloats], dw, channels, wx);
+        }
+        std::vector<const float *> taps(wy.taps);
+        for (int o = o0; o < o1; o++) {
+            for (int k = 0; k < wy.count[o]; k++) taps[k] = &rows[(size_t)(wy.first[o] + k - y0) * rowFloats];
+            resampleColumns(taps.data(), wy.of(o), wy.count[o], out.data(), (int)rowFloats);
+            floatToBytes(out.data(), dst + (size_t)o * rowFloats, dw, channels, srgb);
+        }
+    };
+    if (pool) {
+        pool->run(bands, runBand);
+    } else {
+        for (size_t b = 0; b < bands; b++) runBand(b);
+    }
+}
+
+/*--------------------------------- mipmaps ---------------------------------*/
+
+struct MipLevel {
+    int width, height;
+    std::vector<unsigned char> pixels;
+};
+
+// Número de níveis abaixo do original até 1x1 (tamanhos do OpenGL:
+// metade arredondada para baixo, mínimo 1)
+inline int mipLevelCount(int w, int h) {
+    int n = 0;
+    while (w > 1 || h > 1) {
+        w = w > 1 ? w / 2 : 1;
+        h = h > 1 ? h / 2 : 1;
+        n++;
+    }
+    return n;
+}
+
+// Níveis 1..n (o nível 0 é a própria src) com a caixa em luz linear.
+// maxLevels = 0 gera até 1x1.
+inline std::vector<MipLevel> buildMipChain(const unsigned char *src, int w, int h, int channels, bool srgb,
+                                           int maxLevels = 0) {
+    int n = mipLevelCount(w, h);
+    if (maxLevels > 0 && maxLevels < n) n = maxLevels;
+
+    struct Stage {
+        int inW, w, h;
+        ResizeWeights wx, wy;
+        std::vector<float> ring; // últimas wy.taps linhas já reduzidas na horizontal
+        std::vector<float> out;  // linha pronta, em float, para o próximo nível
+        int nextOut;
+    };
+    std::vector<MipLevel> levels(n);
+    std::vector<Stage> stages(n);
+    int lw = w, lh = h;
+    for (int i = 0; i < n; i++) {
+        Stage &s = stages[i];
+        s.inW = lw;
+        s.w = lw > 1 ? lw / 2 : 1;
+        s.h = lh > 1 ? lh / 2 : 1;
+        s.wx = resizeWeights(lw, s.w, RESIZE_BOX);
+        s.wy = resizeWeights(lh, s.h, RESIZE_BOX);
+        s.ring.resize((size_t)s.wy.taps * s.w * channels);
+        s.out.resize((size_t)s.w * channels);
+        s.nextOut = 0;
+        levels[i].width = s.w;
+        levels[i].height = s.h;
+        levels[i].pixels.resize((size_t)s.w * s.h * channels);
+        lw = s.w;
+        lh = s.h;
+    }
+
+    std::vector<const float *> taps;
+    // Linha y (float) do nível i entra no estágio i, que gera o nível i+1
+    std::function<void(int, int, const float *)> feed = [&](int i, int y, const float *row) {
+        if (i >= n) return;
+        Stage &s = stages[i];
+        size_t rowFloats = (size_t)s.w * channels;
+        int slot = y % s.wy.taps;
+        resampleRow(row, &s.ring[slot * rowFloats], s.w, channels, s.wx);
+        while (s.nextOut < s.h && s.wy.first[s.nextOut] + s.wy.count[s.nextOut] - 1 <= y) {
+            int o = s.nextOut++;
+            taps.resize(s.wy.count[o]);
+            for (int k = 0; k < s.wy.count[o]; k++) {
+                taps[k] = &s.ring[(size_t)((s.wy.first[o] + k) % s.wy.taps) * rowFloats];
+            }
+            resampleColumns(taps.data(), s.wy.of(o), s.wy.count[o], s.out.data(), (int)rowFloats);
+            floatToBytes(s.out.data(), &levels[i].pixels[(size_t)o * rowFloats], s.w, channels, srgb);
+            feed(i + 1, o, s.out.data());
+        }
+    };
+
+    std::vector<float> line((size_t)w * channels);
+    for (int y = 0; y < h && n > 0; y++) {
+        bytesToFloat(src + (size_t)y * w * channels, line.data(), w, channels, srgb);
+        feed(0, y, line.data());
+    }
+    return levels;
+}
+
+#endif /* Resize_h */
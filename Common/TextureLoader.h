@@ -0,0 +1,283 @@
+//
+//  TextureLoader.h
+//
+//  Carga de texturas compartilhada pelos demos. load() devolve na hora o
+//  nome da textura do OpenGL, já com um placeholder 1x1, e a imagem é
+//  decodificada (stbi_load) em threads de trabalho junto com a cor-chave
+//  (ColorKey.h) e os mipmaps (Resize.h). O envio para a GPU fica na thread
+//  do GL: update(), uma vez por quadro, envia o que já foi decodificado
+//  por um pixel buffer (PBO) até um limite de bytes por quadro, e a
+//  textura troca o placeholder pela imagem sem mudar de nome. Com várias
+//  texturas a decodificação dos PNGs corre em paralelo, em vez de uma
+//  depois da outra antes do primeiro quadro.
+//
+//  As texturas são sempre RGBA de 8 bits e a primeira linha da imagem é a
+//  de cima (como o stbi_load devolve), a não ser com flipVertically.
+//  finish() espera todas as cargas pendentes (quadros determinísticos na
+//  captura, ou quando o tamanho da imagem é necessário antes do laço).
+//
+//  Uso: definir STB_IMAGE_IMPLEMENTATION num .cpp do executável, como já
+//  fazem os demos. As texturas pertencem a quem chamou load().
+//
+
+#ifndef TextureLoader_h
+#define TextureLoader_h
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+#ifndef STBI_INCLUDE_STB_IMAGE_H
+#include <stb_image.h>
+#endif
+
+#include "BlockingQueue.h"
+#include "ColorKey.h"
+#include "Resize.h"
+
+struct TextureOptions {
+    bool flipVertically;    // primeira linha embaixo (v = 0 na base da imagem)
+    bool colorKey;          // fundo claro vira alfa 0 (ColorKey.h)
+    ColorKeyOptions key;
+    bool mipmaps;           // cadeia na CPU em luz linear (buildMipChain)
+    GLint wrap, minFilter, magFilter;
+    bool anisotropy;        // filtragem anisotrópica máxima, se houver a extensão
+    unsigned char placeholder[4]; // cor RGBA enquanto a imagem não chega
+
+    TextureOptions()
+        : flipVertically(false), colorKey(false), mipmaps(false), wrap(GL_CLAMP_TO_EDGE), minFilter(GL_LINEAR),
+          magFilter(GL_LINEAR), anisotropy(false) {
+        memset(placeholder, 0, sizeof(placeholder));
+    }
+};
+
+enum TextureState { TEXTURE_LOADING, TEXTURE_READY, TEXTURE_FAILED };
+
+struct TextureInfo {
+    std::string path;
+    int width, height;  // 1x1 (placeholder) até ficar pronta
+    int fileChannels;   // canais do arquivo
+    TextureState state;
+
+    TextureInfo() : width(1), height(1), fileChannels(0), state(TEXTURE_LOADING) {}
+};
+
+// Inverte as linhas de uma imagem no lugar
+inline void flipImageRows(unsigned char *pixels, int w, int h, int channels) {
+    size_t rowBytes = (size_t)w * channels;
+    std::vector<unsigned char> tmp(rowBytes);
+    for (int y = 0; y < h / 2; y++) {
+        unsigned char *top = pixels + rowBytes * y, *bottom = pixels + rowBytes * (h - 1 - y);
+        memcpy(tmp.data(), top, rowBytes);
+        memcpy(top, bottom, rowBytes);
+        memcpy(bottom, tmp.data(), rowBytes);
+    }
+}
+
+class TextureLoader {
+public:
+    // threads = 0 usa os núcleos lógicos menos o da thread do GL.
+    // uploadBudget: bytes enviados por update() (pelo menos uma textura).
+    explicit TextureLoader(unsigned threads = 0, size_t uploadBudget = 8u << 20)
+        : requests(std::numeric_limits<size_t>::max()), decoded(2), budget(uploadBudget), inFlight(0), pbo(0),
+          stopping(false) {
+        if (threads == 0) {
+            unsigned cores = std::thread::hardware_concurrency();
+            threads = cores > 1 ? cores - 1 : 1;
+        }
+        for (unsigned i = 0; i < threads; i++) {
+            workers.push_back(std::thread(&TextureLoader::workerLoop, this));
+        }
+    }
+
+    // Não usa o GL: o PBO já foi apagado quando nada ficou pendente
+    ~TextureLoader() {
+        stopping = true;
+        requests.close();
+        decoded.close();
+        for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+    }
+
+    // Na thread do GL. Cria a textura com o placeholder e pede a decodificação.
+    GLuint load(const std::string &path, const TextureOptions &options = TextureOptions()) {
+        GLuint id;
+        GLint previous;
+        glGenTextures(1, &id);
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+        glBindTexture(GL_TEXTURE_2D, id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, options.wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, options.wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, options.minFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, options.magFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        if (options.anisotropy && (GLAD_GL_EXT_texture_filter_anisotropic || GLAD_GL_ARB_texture_filter_anisotropic)) {
+            GLfloat maxAniso = 0.0f;
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAniso);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, maxAniso);
+        }
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, options.placeholder);
+        glBindTexture(GL_TEXTURE_2D, (GLuint)previous);
+
+        TextureInfo &info = textures[id];
+        info.path = path;
+        inFlight++;
+        Request r;
+        r.id = id;
+        r.path = path;
+        r.options = options;
+        requests.push(r);
+        return id;
+    }
+
+    // Na thread do GL, uma vez por quadro: envia as imagens já decodificadas
+    void update() {
+        size_t sent = 0;
+        Decoded d;
+        while (sent < budget && inFlight > 0 && decoded.tryPop(d)) sent += upload(d);
+    }
+
+    // Espera e envia todas as cargas pendentes; false se alguma falhou
+    bool finish() {
+        Decoded d;
+        while (inFlight > 0 && decoded.pop(d)) upload(d);
+        for (std::map<GLuint, TextureInfo>::const_iterator it = textures.begin(); it != textures.end(); ++it) {
+            if (it->second.state == TEXTURE_FAILED) return false;
+        }
+        return true;
+    }
+
+    size_t pending() const { return inFlight; }
+
+    // NULL se a textura não veio deste loader
+    const TextureInfo *info(GLuint id) const {
+        std::map<GLuint, TextureInfo>::const_iterator it = textures.find(id);
+        return it == textures.end() ? NULL : &it->second;
+    }
+
+private:
+    TextureLoader(const TextureLoader &);
+    TextureLoader &operator=(const TextureLoader &);
+
+    struct Request {
+        GLuint id;
+        std::string path;
+        TextureOptions options;
+    };
+
+    struct StbiFree {
+        void operator()(unsigned char *p) const { stbi_image_free(p); }
+    };
+
+    struct Decoded {
+        GLuint id;
+        int width, height, fileChannels;
+        std::unique_ptr<unsigned char, StbiFree> pixels; // nível 0, RGBA; vazio se falhou
+        std::vector<MipLevel> mips;
+        std::string error;
+
+        Decoded() : id(0), width(0), height(0), fileChannels(0) {}
+    };
+
+    void workerLoop() {
+        Request r;
+        while (!stopping && requests.pop(r)) {
+            Decoded d;
+            d.id = r.id;
+            d.pixels.reset(stbi_load(r.path.c_str(), &d.width, &d.height, &d.fileChannels, 4));
+            if (!d.pixels) {
+                const char *reason = stbi_failure_reason();
+                d.error = reason ? reason : "erro desconhecido";
+            } else {
+                unsigned char *p = d.pixels.get();
+                if (r.options.flipVertically) flipImageRows(p, d.width, d.height, 4);
+                if (r.options.colorKey) bakeColorKey(p, d.width, d.height, r.options.key);
+                if (r.options.mipmaps) d.mips = buildMipChain(p, d.width, d.height, 4, true);
+            }
+            if (!decoded.push(std::move(d))) return;
+        }
+    }
+
+    // Copia todos os níveis para o PBO (recriado a cada textura, para não
+    // esperar o envio anterior) e cria os níveis a partir dele. Devolve os
+    // bytes enviados.
+    size_t upload(Decoded &d) {
+        inFlight--;
+        TextureInfo &info = textures[d.id];
+        if (!d.pixels) {
+            info.state = TEXTURE_FAILED;
+            fprintf(stderr, "Falha ao carregar textura %s: %s\n", info.path.c_str(), d.error.c_str());
+            releasePBO();
+            return 0;
+        }
+        size_t level0 = (size_t)d.width * d.height * 4, total = level0;
+        for (size_t i = 0; i < d.mips.size(); i++) total += d.mips[i].pixels.size();
+
+        if (!pbo) glGenBuffers(1, &pbo);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)total, NULL, GL_STREAM_DRAW);
+        unsigned char *mapped = (unsigned char *)glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+        if (mapped) {
+            size_t offset = level0;
+            memcpy(mapped, d.pixels.get(), level0);
+            for (size_t i = 0; i < d.mips.size(); i++) {
+                memcpy(mapped + offset, d.mips[i].pixels.data(), d.mips[i].pixels.size());
+                offset += d.mips[i].pixels.size();
+            }
+            // com falha no unmap (conteúdo perdido) envia da memória da CPU
+            if (!glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER)) mapped = NULL;
+        }
+        if (!mapped) glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        GLint previous;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+        glBindTexture(GL_TEXTURE_2D, d.id);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        // com o PBO ligado o último argumento é o deslocamento dentro dele
+        const void *base = mapped ? NULL : d.pixels.get();
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, d.width, d.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, base);
+        size_t offset = level0;
+        for (size_t i = 0; i < d.mips.size(); i++) {
+            const void *level = mapped ? (const void *)offset : d.mips[i].pixels.data();
+            glTexImage2D(GL_TEXTURE_2D, (GLint)i + 1, GL_RGBA, d.mips[i].width, d.mips[i].height, 0, GL_RGBA,
+                         GL_UNSIGNED_BYTE, level);
+            offset += d.mips[i].pixels.size();
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)d.mips.size());
+        glBindTexture(GL_TEXTURE_2D, (GLuint)previous);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        info.width = d.width;
+        info.height = d.height;
+        info.fileChannels = d.fileChannels;
+        info.state = TEXTURE_READY;
+        d.pixels.reset();
+        d.mips.clear();
+        releasePBO();
+        return total;
+    }
+
+    // Sem cargas pendentes o PBO não é mais necessário
+    void releasePBO() {
+        if (inFlight == 0 && pbo) {
+            glDeleteBuffers(1, &pbo);
+            pbo = 0;
+        }
+    }
+
+    std::vector<std::thread> workers;
+    BlockingQueue<Request> requests;
+    BlockingQueue<Decoded> decoded; // limitada: segura a decodificação se o GL não consome
+    std::map<GLuint, TextureInfo> textures;
+    size_t budget, inFlight;
+    GLuint pbo;
+    std::atomic<bool> stopping;
+};
+
+#endif /* TextureLoader_h */
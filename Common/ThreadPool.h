@@ -0,0 +1,102 @@
+//
+//  ThreadPool.h
+//
+//  Pool fixo de threads para laços paralelos do tipo "faça as tarefas
+//  0..n-1". As threads ficam vivas entre chamadas; cada tarefa é pega por
+//  um contador atômico e a thread que chama run() também trabalha.
+//
+
+#ifndef ThreadPool_h
+#define ThreadPool_h
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // threads = 0 usa todos os núcleos lógicos
+    explicit ThreadPool(unsigned threads = 0) : generation(0), stopping(false), job(NULL), taskCount(0), pending(0) {
+        if (threads == 0) threads = std::thread::hardware_concurrency();
+        if (threads == 0) threads = 1;
+        // a thread chamadora conta como uma
+        for (unsigned i = 1; i < threads; i++) {
+            workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+    }
+
+    unsigned size() const { return (unsigned)workers.size() + 1; }
+
+    // Executa fn(0) .. fn(tasks-1) e só retorna quando todas terminarem.
+    // Não é reentrante: fn não deve chamar run() no mesmo pool.
+    void run(size_t tasks, const std::function<void(size_t)> &fn) {
+        if (tasks == 0) return;
+        if (workers.empty() || tasks == 1) {
+            for (size_t i = 0; i < tasks; i++) fn(i);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &fn;
+            taskCount = tasks;
+            next.store(0);
+            pending = workers.size();
+            generation++;
+        }
+        wake.notify_all();
+        work();
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return pending == 0; });
+        job = NULL;
+    }
+
+private:
+    ThreadPool(const ThreadPool &);
+    ThreadPool &operator=(const ThreadPool &);
+
+    void work() {
+        for (size_t i = next.fetch_add(1); i < taskCount; i = next.fetch_add(1)) {
+            (*job)(i);
+        }
+    }
+
+    void workerLoop() {
+        unsigned long seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            work();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) done.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    unsigned long generation;
+    bool stopping;
+
+    const std::function<void(size_t)> *job;
+    size_t taskCount;
+    std::atomic<size_t> next;
+    size_t pending;
+};
+
+#endif /* ThreadPool_h */
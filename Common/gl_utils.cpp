@@ -13,6 +13,7 @@
 | it is really making life easier.                                             |
 \******************************************************************************/
 #include "gl_utils.h"
+#include "FrameCapture.h"
 
 #include <stdio.h>
 #include <time.h>
@@ -80,7 +81,7 @@ bool gl_log_err (const char* message, ...) {
 }
 
 /*--------------------------------GLFW3 and GLEW------------------------------*/
-bool start_gl () {
+bool start_gl (const FrameCapture* capture) {
 	gl_log ("starting GLFW %s", glfwGetVersionString ());
 	
 	glfwSetErrorCallback (glfw_error_callback);
@@ -101,6 +102,8 @@ bool start_gl () {
 		vmode->width, vmode->height, "Extended GL Init", mon, NULL
 	);*/
 
+	if (capture) capture->windowHints ();
+
 	g_window = glfwCreateWindow (
 		g_gl_width, g_gl_height, "Extended Init.", NULL, NULL
 	);
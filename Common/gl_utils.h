@@ -25,6 +25,8 @@
 
 using namespace std;
 
+class FrameCapture;
+
 /*------------------------------GLOBAL VARIABLES------------------------------*/
 extern int g_gl_width;
 extern int g_gl_height;
@@ -35,7 +37,8 @@ bool gl_log (const char* message, ...);
 /* same as gl_log except also prints to stderr */
 bool gl_log_err (const char* message, ...);
 /*--------------------------------GLFW3 and GLEW------------------------------*/
-bool start_gl ();
+/* capture: modo de captura dos testes de regressão (FrameCapture.h) */
+bool start_gl (const FrameCapture* capture = NULL);
 void glfw_error_callback (int error, const char* description);
 void glfw_window_size_callback (GLFWwindow* window, int width, int height);
 void _update_fps_counter (GLFWwindow* window);
@@ -0,0 +1,164 @@
+//
+//  Batch.h
+//
+//  Processamento em lote: aplica um FilterPipeline a uma lista de imagens
+//  com três estágios em threads separadas, ligados por filas curtas:
+//
+//      leitura (N+1)  ->  filtros (N)  ->  escrita (N-1)
+//
+//  A leitura e a escrita de disco se sobrepõem aos filtros, e as filas
+//  limitadas deixam no máximo alguns quadros na memória ao mesmo tempo.
+//
+
+#ifndef Batch_h
+#define Batch_h
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BlockingQueue.h"
+#include "PPM.h"
+#include "Pipeline.h"
+
+enum BatchFormat {
+    BATCH_KEEP,   // mesmo formato da entrada (texto ou binário)
+    BATCH_BINARY, // sempre P6
+    BATCH_TEXT    // sempre P3
+};
+
+struct BatchOptions {
+    std::vector<std::string> inputs; // arquivos de entrada
+    std::string outDir;
+    BatchFormat format;
+    size_t queueDepth;               // quadros em espera entre estágios
+    // Outro executor dos filtros (GPU, GLFilters.h), chamado na thread dos
+    // filtros; devolve false para a imagem ir pelos kernels da CPU
+    std::function<bool(const ImageView &)> offload;
+
+    BatchOptions() : format(BATCH_KEEP), queueDepth(2) {}
+};
+
+struct BatchStats {
+    size_t done, failed;
+    double seconds, megapixels;
+};
+
+inline bool isPNMPath(const std::filesystem::path &p) {
+    std::string ext = p.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".ppm" || ext == ".pgm" || ext == ".pnm";
+}
+
+// Arquivo avulso ou todos os .ppm/.pgm/.pnm de um diretório (ordem alfabética)
+inline bool addBatchInput(const std::string &path, std::vector<std::string> &inputs) {
+    std::error_code ec;
+    if (std::filesystem::is_directory(path, ec)) {
+        std::vector<std::string> found;
+        for (std::filesystem::directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->is_regular_file(ec) && isPNMPath(it->path())) found.push_back(it->path().string());
+        }
+        std::sort(found.begin(), found.end());
+        inputs.insert(inputs.end(), found.begin(), found.end());
+        return !ec;
+    }
+    if (!std::filesystem::exists(path, ec)) return false;
+    inputs.push_back(path);
+    return true;
+}
+
+// Lista de arquivos, um caminho por linha (linhas vazias e # são ignoradas)
+inline bool addBatchList(const std::string &listFile, std::vector<std::string> &inputs) {
+    std::ifstream in(listFile);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        line = trimSpaces(line);
+        if (!line.empty() && line[0] != '#') inputs.push_back(line);
+    }
+    return true;
+}
+
+struct BatchJob {
+    std::string input, output;
+    std::unique_ptr<PPMImage> image;
+};
+
+inline BatchStats runBatch(const BatchOptions &options, const FilterPipeline &pipeline, RowExecutor &executor) {
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point t0 = Clock::now();
+    BatchStats stats = { 0, 0, 0.0, 0.0 };
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.outDir, ec);
+
+    BlockingQueue<BatchJob> loaded(options.queueDepth), filtered(options.queueDepth);
+    size_t readFailures = 0;
+
+    std::thread reader([&] {
+        for (size_t i = 0; i < options.inputs.size(); i++) {
+            BatchJob job;
+            job.input = options.inputs[i];
+            job.output = (std::filesystem::path(options.outDir) /
+                          std::filesystem::path(job.input).filename()).string();
+            // o binário fica mapeado da entrada: sobrescrever o próprio arquivo não é permitido
+            std::error_code same;
+            if (std::filesystem::equivalent(job.input, job.output, same)) {
+                fprintf(stderr, "Saída igual à entrada, ignorado: %s\n", job.input.c_str());
+                readFailures++;
+                continue;
+            }
+            job.image.reset(new PPMImage());
+            if (!job.image->load(job.input)) {
+                readFailures++;
+                continue;
+            }
+            job.image->toRGB();
+            loaded.push(std::move(job));
+        }
+        loaded.close();
+    });
+
+    std::thread writer([&] {
+        BatchJob job;
+        while (filtered.pop(job)) {
+            PPMImage &img = *job.image;
+            bool binary = options.format == BATCH_BINARY || (options.format == BATCH_KEEP && img.isBinary());
+            bool ok = binary ? savePPMBinary(job.output, img.data, img.width, img.height, 3, NULL, img.maxValue)
+                             : savePPMText(job.output, img.data, img.width, img.height, 3, NULL, img.maxValue);
+            if (ok) {
+                stats.done++;
+                stats.megapixels += (double)img.width * img.height / 1e6;
+            } else {
+                fprintf(stderr, "Erro ao gravar %s\n", job.output.c_str());
+                stats.failed++;
+            }
+            job.image.reset();
+        }
+    });
+
+    // Os filtros rodam nesta thread, usando o pool do executor
+    BatchJob job;
+    while (loaded.pop(job)) {
+        PPMImage &img = *job.image;
+        ImageView view = ImageView::interleaved(img.data, img.width, img.height, 3, 0, img.bytesPerSample());
+        if (!options.offload || !options.offload(view)) pipeline.run(executor, view);
+        filtered.push(std::move(job));
+    }
+    filtered.close();
+
+    reader.join();
+    writer.join();
+    stats.failed += readFailures;
+    stats.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    return stats;
+}
+
+#endif /* Batch_h */
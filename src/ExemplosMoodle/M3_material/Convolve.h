@@ -0,0 +1,589 @@
+//
+//  Convolve.h
+//
+//  Filtros de vizinhança sobre imagens de 8 ou 16 bits: borramento de caixa e
+//  gaussiano, máscara de nitidez (unsharp) e bordas de Sobel. Os borramentos
+//  e o unsharp tratam os canais um a um e aceitam os dois layouts (Image.h):
+//  no planar cada plano é filtrado como imagem de um canal; o Sobel usa a
+//  luminância e quer RGB intercalado.
+//
+//  Todos são separáveis (passada horizontal e depois vertical) e rodam em
+//  blocos de colunas x linhas do tamanho do cache, lendo de src e gravando
+//  em dst (buffers diferentes). Cada bloco relê as linhas/colunas de borda
+//  de que precisa, então os blocos são independentes e o resultado não
+//  depende do número de threads. Bordas da imagem repetem o pixel da borda.
+//
+//  - caixa: somas corridas nas duas direções, O(1) por pixel para qualquer
+//    raio;
+//  - gaussiano: convolução direta em float até raio 8; acima disso, três
+//    caixas sucessivas (aproximação do gaussiano), também O(1) por pixel.
+//
+
+#ifndef Convolve_h
+#define Convolve_h
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#include "Filters.h"
+#include "Image.h"
+#include "RowExecutor.h"
+
+const int MAX_BLUR_RADIUS = 1000;   // somas da caixa cabem em int32 (8 e 16 bits)
+const int MAX_BLUR_RADIUS16 = 90;   // caixa 2D de 16 bits numa passada só
+const int GAUSS_DIRECT_RADIUS = 8;  // acima disso o gaussiano vira 3 caixas
+
+inline int clampInt(int v, int lo, int hi) { return v < lo ? lo : v > hi ? hi : v; }
+
+// Maior amostra de T: 255 ou 65535
+template <typename T>
+constexpr int sampleMax() { return (int)(T)~0u; }
+
+// Linha de w pixels de cn canais, de x0-pad até x1+pad, com as bordas
+// repetidas
+inline void paddedRow(const unsigned char *row, int w, int cn, int x0, int x1, int pad, unsigned char *out) {
+    int first = x0 - pad, last = x1 + pad; // [first, last)
+    int a = clampInt(first, 0, w), b = clampInt(last, 0, w);
+    unsigned char *o = out;
+    for (int x = first; x < a; x++, o += cn) memcpy(o, row, cn);
+    if (b > a) {
+        memcpy(o, row + (size_t)a * cn, (size_t)(b - a) * cn);
+        o += (size_t)(b - a) * cn;
+    }
+    for (int x = b < a ? a : b; x < last; x++, o += cn) memcpy(o, row + (size_t)(w - 1) * cn, cn);
+}
+
+/*---------------------------- kernels por linha ----------------------------*/
+
+// out[i] = soma_k w[k] * pad[i + cn*k]: convolução horizontal de cn canais
+// intercalados, canal por canal, sem separar os canais.
+inline void convolveRowScalar(const float *pad, float *out, int n, const float *w, int taps, int cn) {
+    for (int i = 0; i < n; i++) {
+        float acc = 0.0f;
+        for (int k = 0; k < taps; k++) acc += w[k] * pad[i + cn * k];
+        out[i] = acc;
+    }
+}
+
+// Soma ponderada de taps linhas, arredondada para amostras de T
+template <typename T>
+inline void convolveColumnsScalar(const float *const *rows, const float *w, int taps, T *dst, int n) {
+    for (int i = 0; i < n; i++) {
+        float acc = 0.0f;
+        for (int k = 0; k < taps; k++) acc += w[k] * rows[k][i];
+        int v = (int)(acc + 0.5f);
+        dst[i] = (T)clampInt(v, 0, sampleMax<T>());
+    }
+}
+
+// Grava col * inv arredondado e avança a soma corrida: col += add - sub
+template <typename T>
+inline void boxColumnsScalar(int *col, const int *add, const int *sub, float inv, T *dst, int n) {
+    for (int i = 0; i < n; i++) {
+        int v = (int)((float)col[i] * inv + 0.5f);
+        dst[i] = (T)clampInt(v, 0, sampleMax<T>());
+        if (add) col[i] += add[i] - sub[i];
+    }
+}
+
+#if CPU_HAS_SSE2
+inline void convolveRowSSE2(const float *pad, float *out, int n, const float *w, int taps, int cn) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 acc = _mm_setzero_ps();
+        for (int k = 0; k < taps; k++) {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[k]), _mm_loadu_ps(pad + i + cn * k)));
+        }
+        _mm_storeu_ps(out + i, acc);
+    }
+    convolveRowScalar(pad + i, out + i, n - i, w, taps, cn);
+}
+
+static inline void storeRounded4_SSE2(__m128 v, unsigned char *dst) {
+    __m128i i32 = _mm_cvttps_epi32(_mm_add_ps(v, _mm_set1_ps(0.5f)));
+    __m128i i16 = _mm_packs_epi32(i32, i32);
+    int packed = _mm_cvtsi128_si32(_mm_packus_epi16(i16, i16));
+    memcpy(dst, &packed, 4);
+}
+
+// SSE2 só empacota 32 -> 16 bits com sinal: desloca para -32768..32767,
+// empacota e volta
+static inline void storeRounded4_SSE2(__m128 v, uint16_t *dst) {
+    __m128i i32 = _mm_sub_epi32(_mm_cvttps_epi32(_mm_add_ps(v, _mm_set1_ps(0.5f))), _mm_set1_epi32(32768));
+    __m128i i16 = _mm_xor_si128(_mm_packs_epi32(i32, i32), _mm_set1_epi16((short)0x8000));
+    _mm_storel_epi64((__m128i *)dst, i16);
+}
+
+template <typename T>
+inline void convolveColumnsSSE2(const float *const *rows, const float *w, int taps, T *dst, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 acc = _mm_setzero_ps();
+        for (int k = 0; k < taps; k++) {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[k]), _mm_loadu_ps(rows[k] + i)));
+        }
+        storeRounded4_SSE2(acc, dst + i);
+    }
+    const float *rest[2 * GAUSS_DIRECT_RADIUS + 1];
+    for (int k = 0; k < taps; k++) rest[k] = rows[k] + i;
+    convolveColumnsScalar(rest, w, taps, dst + i, n - i);
+}
+
+template <typename T>
+inline void boxColumnsSSE2(int *col, const int *add, const int *sub, float inv, T *dst, int n) {
+    int i = 0;
+    const __m128 vinv = _mm_set1_ps(inv);
+    for (; i + 4 <= n; i += 4) {
+        __m128i c = _mm_loadu_si128((const __m128i *)(col + i));
+        storeRounded4_SSE2(_mm_mul_ps(_mm_cvtepi32_ps(c), vinv), dst + i);
+        if (add) {
+            __m128i d = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(add + i)), _mm_loadu_si128((const __m128i *)(sub + i)));
+            _mm_storeu_si128((__m128i *)(col + i), _mm_add_epi32(c, d));
+        }
+    }
+    boxColumnsScalar(col + i, add ? add + i : NULL, sub ? sub + i : NULL, inv, dst + i, n - i);
+}
+#endif /* CPU_HAS_SSE2 */
+
+#if CPU_HAS_AVX2_TARGET
+inline TARGET_AVX2 void convolveRowAVX2(const float *pad, float *out, int n, const float *w, int taps, int cn) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 acc = _mm256_setzero_ps();
+        for (int k = 0; k < taps; k++) {
+            acc = _mm256_fmadd_ps(_mm256_set1_ps(w[k]), _mm256_loadu_ps(pad + i + cn * k), acc);
+        }
+        _mm256_storeu_ps(out + i, acc);
+    }
+    convolveRowScalar(pad + i, out + i, n - i, w, taps, cn);
+}
+
+static inline TARGET_AVX2 void storeRounded8_AVX2(__m256 v, unsigned char *dst) {
+    __m256i i32 = _mm256_cvttps_epi32(_mm256_add_ps(v, _mm256_set1_ps(0.5f)));
+    __m128i i16 = _mm_packs_epi32(_mm256_castsi256_si128(i32), _mm256_extracti128_si256(i32, 1));
+    _mm_storel_epi64((__m128i *)dst, _mm_packus_epi16(i16, i16));
+}
+
+static inline TARGET_AVX2 void storeRounded8_AVX2(__m256 v, uint16_t *dst) {
+    __m256i i32 = _mm256_cvttps_epi32(_mm256_add_ps(v, _mm256_set1_ps(0.5f)));
+    _mm_storeu_si128((__m128i *)dst, _mm_packus_epi32(_mm256_castsi256_si128(i32), _mm256_extracti128_si256(i32, 1)));
+}
+
+template <typename T>
+inline TARGET_AVX2 void convolveColumnsAVX2(const float *const *rows, const float *w, int taps, T *dst, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 acc = _mm256_setzero_ps();
+        for (int k = 0; k < taps; k++) {
+            acc = _mm256_fmadd_ps(_mm256_set1_ps(w[k]), _mm256_loadu_ps(rows[k] + i), acc);
+        }
+        storeRounded8_AVX2(acc, dst + i);
+    }
+    const float *rest[2 * GAUSS_DIRECT_RADIUS + 1];
+    for (int k = 0; k < taps; k++) rest[k] = rows[k] + i;
+    convolveColumnsScalar(rest, w, taps, dst + i, n - i);
+}
+
+template <typename T>
+inline TARGET_AVX2 void boxColumnsAVX2(int *col, const int *add, const int *sub, float inv, T *dst, int n) {
+    int i = 0;
+    const __m256 vinv = _mm256_set1_ps(inv);
+    for (; i + 8 <= n; i += 8) {
+        __m256i c = _mm256_loadu_si256((const __m256i *)(col + i));
+        storeRounded8_AVX2(_mm256_mul_ps(_mm256_cvtepi32_ps(c), vinv), dst + i);
+        if (add) {
+            __m256i d = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(add + i)),
+                                         _mm256_loadu_si256((const __m256i *)(sub + i)));
+            _mm256_storeu_si256((__m256i *)(col + i), _mm256_add_epi32(c, d));
+        }
+    }
+    boxColumnsScalar(col + i, add ? add + i : NULL, sub ? sub + i : NULL, inv, dst + i, n - i);
+}
+#endif /* CPU_HAS_AVX2_TARGET */
+
+// O AVX2 usa FMA: o gaussiano direto pode diferir em 1 nível do escalar/SSE2
+// em alguns pixels. Para um mesmo nível SIMD a saída não muda com o número
+// de threads.
+inline void convolveRow(const float *pad, float *out, int n, const float *w, int taps, int cn) {
+    switch (activeSimdLevel()) {
+#if CPU_HAS_AVX2_TARGET
+        case SIMD_AVX2: convolveRowAVX2(pad, out, n, w, taps, cn); return;
+#endif
+#if CPU_HAS_SSE2
+        case SIMD_SSE2: convolveRowSSE2(pad, out, n, w, taps, cn); return;
+#endif
+        default: convolveRowScalar(pad, out, n, w, taps, cn);
+    }
+}
+
+template <typename T>
+inline void convolveColumns(const float *const *rows, const float *w, int taps, T *dst, int n) {
+    switch (activeSimdLevel()) {
+#if CPU_HAS_AVX2_TARGET
+        case SIMD_AVX2: convolveColumnsAVX2(rows, w, taps, dst, n); return;
+#endif
+#if CPU_HAS_SSE2
+        case SIMD_SSE2: convolveColumnsSSE2(rows, w, taps, dst, n); return;
+#endif
+        default: convolveColumnsScalar(rows, w, taps, dst, n);
+    }
+}
+
+template <typename T>
+inline void boxColumns(int *col, const int *add, const int *sub, float inv, T *dst, int n) {
+    switch (activeSimdLevel()) {
+#if CPU_HAS_AVX2_TARGET
+        case SIMD_AVX2: boxColumnsAVX2(col, add, sub, inv, dst, n); return;
+#endif
+#if CPU_HAS_SSE2
+        case SIMD_SSE2: boxColumnsSSE2(col, add, sub, inv, dst, n); return;
+#endif
+        default: boxColumnsScalar(col, add, sub, inv, dst, n);
+    }
+}
+
+/*------------------------------- tamanho dos blocos -------------------------*/
+
+// Largura do bloco (em pixels) para que bytesPerPixelColumn * largura caiba
+// na metade do L2, e nunca menor que 4 raios (senão a borda relida domina).
+inline int tileWidthFor(int w, size_t bytesPerPixelColumn, int radius) {
+    size_t fit = (l2CacheBytes() / 2) / (bytesPerPixelColumn ? bytesPerPixelColumn : 1);
+    int tile = (int)(fit < 64 ? 64 : fit);
+    if (tile < 4 * radius) tile = 4 * radius;
+    return tile < w ? tile : w;
+}
+
+// Altura do bloco: no mínimo 4 raios pelo mesmo motivo
+inline int tileHeightFor(int h, int radius) {
+    int tile = 64 > 4 * radius ? 64 : 4 * radius;
+    return tile < h ? tile : h;
+}
+
+/*--------------------------------- caixa -----------------------------------*/
+
+// Somas horizontais de 2r+1 pixels para x0..x1 de uma linha preenchida
+// por paddedRow(..., r + 1): pad[0] corresponde a x0 - r - 1.
+template <typename T>
+inline void boxRowSums(const T *pad, int count, int r, int cn, int *out) {
+    for (int c = 0; c < cn; c++) {
+        int s = 0;
+        for (int k = 1; k <= 2 * r + 1; k++) s += pad[k * cn + c];
+        out[c] = s;
+        for (int x = 1; x < count; x++) {
+            s += pad[(x + 2 * r + 1) * cn + c] - pad[x * cn + c];
+            out[x * cn + c] = s;
+        }
+    }
+}
+
+// Raios independentes na horizontal (rx) e na vertical (ry); rx ou ry zero
+// dá uma passada só numa direção.
+template <typename T>
+inline void boxBlurTiles(RowExecutor &executor, const ImageView &src, const ImageView &dst, int rx, int ry) {
+    int w = src.width, h = src.height, cn = src.channels;
+    float inv = 1.0f / (float)((2 * rx + 1) * (2 * ry + 1));
+    int tileW = tileWidthFor(w, (size_t)cn * 4 * 3, rx); // soma da coluna + duas linhas de somas
+    int tileH = tileHeightFor(h, ry);
+
+    executor.forEachTile(w, h, tileW, tileH, [&](int x0, int x1, int y0, int y1) {
+        int count = x1 - x0, n = count * cn;
+        std::vector<T> pad((size_t)(count + 2 * rx + 2) * cn);
+        std::vector<int> col(n, 0), add(n), sub(n);
+        auto rowSums = [&](int y, int *out) {
+            paddedRow(src.row(clampInt(y, 0, h - 1)), w, cn * (int)sizeof(T), x0, x1, rx + 1, (unsigned char *)pad.data());
+            boxRowSums(pad.data(), count, rx, cn, out);
+        };
+
+        for (int y = y0 - ry; y <= y0 + ry; y++) {
+            rowSums(y, add.data());
+            for (int i = 0; i < n; i++) col[i] += add[i];
+        }
+        for (int y = y0; y < y1; y++) {
+            T *out = (T *)dst.row(y) + (size_t)x0 * cn;
+            if (y + 1 == y1) {
+                boxColumns(col.data(), NULL, NULL, inv, out, n);
+                break;
+            }
+            rowSums(y + ry + 1, add.data());
+            rowSums(y - ry, sub.data());
+            boxColumns(col.data(), add.data(), sub.data(), inv, out, n);
+        }
+    });
+}
+
+// Em 16 bits a soma de (2r+1)^2 amostras só cabe em int32 até
+// MAX_BLUR_RADIUS16; acima disso a caixa vira uma passada horizontal e uma
+// vertical (a soma de 2r+1 amostras cabe até MAX_BLUR_RADIUS), com um
+// arredondamento a mais entre as duas.
+inline void boxBlur(RowExecutor &executor, const ImageView &src, const ImageView &dst, int radius) {
+    if (src.planar()) {
+        for (int c = 0; c < src.channels; c++) boxBlur(executor, src.plane(c), dst.plane(c), radius);
+        return;
+    }
+    int r = clampInt(radius, 0, MAX_BLUR_RADIUS);
+    if (r == 0) {
+        copyImage(executor, src, dst);
+    } else if (src.wide() && r > MAX_BLUR_RADIUS16) {
+        Image tmp(src.width, src.height, src.channels, LAYOUT_INTERLEAVED, src.depth);
+        boxBlurTiles<uint16_t>(executor, src, tmp.view(), r, 0);
+        boxBlurTiles<uint16_t>(executor, tmp.view(), dst, 0, r);
+    } else if (src.wide()) {
+        boxBlurTiles<uint16_t>(executor, src, dst, r, r);
+    } else {
+        boxBlurTiles<unsigned char>(executor, src, dst, r, r);
+    }
+}
+
+/*------------------------------- gaussiano ---------------------------------*/
+
+inline std::vector<float> gaussianWeights(double sigma, int radius) {
+    std::vector<float> w(2 * radius + 1);
+    double sum = 0.0;
+    for (int k = -radius; k <= radius; k++) sum += exp(-(k * k) / (2.0 * sigma * sigma));
+    for (int k = -radius; k <= radius; k++) w[k + radius] = (float)(exp(-(k * k) / (2.0 * sigma * sigma)) / sum);
+    return w;
+}
+
+// Convolução direta, separável, com anel de 2r+1 linhas já filtradas na
+// horizontal por bloco. src e dst intercalados (ou um plano só).
+template <typename T>
+inline void gaussianDirectTiles(RowExecutor &executor, const ImageView &src, const ImageView &dst, double sigma, int r) {
+    std::vector<float> weights = gaussianWeights(sigma, r);
+    int w = src.width, h = src.height, cn = src.channels;
+    int taps = 2 * r + 1;
+    int tileW = tileWidthFor(w, (size_t)taps * cn * sizeof(float), r);
+    int tileH = tileHeightFor(h, r);
+
+    executor.forEachTile(w, h, tileW, tileH, [&](int x0, int x1, int y0, int y1) {
+        int count = x1 - x0, n = count * cn;
+        std::vector<T> pad((size_t)(count + 2 * r) * cn);
+        std::vector<float> padF(pad.size());
+        std::vector<float> ring((size_t)taps * n);
+        const float *rows[2 * GAUSS_DIRECT_RADIUS + 1];
+
+        // linha filtrada na horizontal de y vai para o slot (y - y0 + r) % taps
+        auto filterRow = [&](int y) {
+            paddedRow(src.row(clampInt(y, 0, h - 1)), w, cn * (int)sizeof(T), x0, x1, r, (unsigned char *)pad.data());
+            for (size_t i = 0; i < pad.size(); i++) padF[i] = pad[i];
+            convolveRow(padF.data(), &ring[(size_t)((y - y0 + r) % taps) * n], n, weights.data(), taps, cn);
+        };
+
+        for (int y = y0 - r; y < y0 + r; y++) filterRow(y);
+        for (int y = y0; y < y1; y++) {
+            filterRow(y + r);
+            for (int k = 0; k < taps; k++) rows[k] = &ring[(size_t)((y - y0 + k) % taps) * n];
+            convolveColumns(rows, weights.data(), taps, (T *)dst.row(y) + (size_t)x0 * cn, n);
+        }
+    });
+}
+
+inline void gaussianDirect(RowExecutor &executor, const ImageView &src, const ImageView &dst, double sigma, int r) {
+    if (src.wide()) {
+        gaussianDirectTiles<uint16_t>(executor, src, dst, sigma, r);
+    } else {
+        gaussianDirectTiles<unsigned char>(executor, src, dst, sigma, r);
+    }
+}
+
+// Larguras de 3 caixas cuja composição aproxima o gaussiano de sigma
+inline void boxesForGauss(double sigma, int radii[3]) {
+    const int passes = 3;
+    double ideal = sqrt(12.0 * sigma * sigma / passes + 1.0);
+    int wl = (int)floor(ideal);
+    if (wl % 2 == 0) wl--;
+    int wu = wl + 2;
+    double mIdeal = (12.0 * sigma * sigma - passes * wl * wl - 4.0 * passes * wl - 3.0 * passes) / (-4.0 * wl - 4.0);
+    int m = (int)floor(mIdeal + 0.5);
+    for (int i = 0; i < passes; i++) radii[i] = ((i < m ? wl : wu) - 1) / 2;
+}
+
+// Se as três caixas do sigma cabem em MAX_BLUR_RADIUS (o parser recusa o
+// resto, em vez de deixar boxBlur cortar o raio e borrar menos)
+inline bool gaussianFits(double sigma) {
+    if (sigma <= 0.0 || (int)ceil(3.0 * sigma) <= GAUSS_DIRECT_RADIUS) return true;
+    if (sigma > 2.0 * MAX_BLUR_RADIUS) return false; // raios bem acima do limite
+    int radii[3];
+    boxesForGauss(sigma, radii);
+    return radii[0] <= MAX_BLUR_RADIUS && radii[1] <= MAX_BLUR_RADIUS && radii[2] <= MAX_BLUR_RADIUS;
+}
+
+// Alcance do gaussianBlur em linhas (direto ou soma das três caixas)
+inline int gaussianHalo(double sigma) {
+    if (sigma <= 0.0) return 0;
+    int r = (int)ceil(3.0 * sigma);
+    if (r <= GAUSS_DIRECT_RADIUS) return r;
+    int radii[3];
+    boxesForGauss(sigma, radii);
+    int total = 0;
+    for (int i = 0; i < 3; i++) total += clampInt(radii[i], 0, MAX_BLUR_RADIUS); // como em boxBlur
+    return total;
+}
+
+inline void gaussianBlur(RowExecutor &executor, const ImageView &src, const ImageView &dst, double sigma) {
+    if (sigma <= 0.0) {
+        copyImage(executor, src, dst);
+        return;
+    }
+    if (src.planar()) {
+        for (int c = 0; c < src.channels; c++) gaussianBlur(executor, src.plane(c), dst.plane(c), sigma);
+        return;
+    }
+    int r = (int)ceil(3.0 * sigma);
+    if (r <= GAUSS_DIRECT_RADIUS) {
+        gaussianDirect(executor, src, dst, sigma, r);
+        return;
+    }
+    int radii[3];
+    boxesForGauss(sigma, radii);
+    Image tmp(src.width, src.height, src.channels, LAYOUT_INTERLEAVED, src.depth);
+    boxBlur(executor, src, dst, radii[0]);
+    boxBlur(executor, dst, tmp.view(), radii[1]);
+    boxBlur(executor, tmp.view(), dst, radii[2]);
+}
+
+/*-------------------------------- unsharp ----------------------------------*/
+
+// Soma src + ganho * (src - borrado) sobre o borrado, amostra a amostra
+template <typename T>
+inline void unsharpApply(RowExecutor &executor, const ImageView &src, const ImageView &dst, int gain, int threshold) {
+    size_t n = src.rowBytes() / sizeof(T);
+    executor.forEachBand(src.height, (size_t)src.width * src.channels * sizeof(T), [&](int y0, int y1) {
+        for (int c = 0; c < src.planes(); c++) {
+            for (int y = y0; y < y1; y++) {
+                const T *s = (const T *)src.row(y, c);
+                T *blur = (T *)dst.row(y, c);
+                for (size_t i = 0; i < n; i++) {
+                    int diff = s[i] - blur[i];
+                    // 64 bits: diff de 16 bits vezes o ganho Q8 pode passar de int32
+                    int64_t v = (diff >= threshold || -diff >= threshold) ? s[i] + (((int64_t)diff * gain + 128) >> 8) : s[i];
+                    blur[i] = (T)(v < 0 ? 0 : v > sampleMax<T>() ? sampleMax<T>() : v);
+                }
+            }
+        }
+    });
+}
+
+// dst = src + amount * (src - gauss(src)), só onde |src - gauss| >= threshold
+// (threshold na escala das amostras: 0..255 ou 0..65535)
+inline void unsharpMask(RowExecutor &executor, const ImageView &src, const ImageView &dst,
+                        double amount, double sigma, int threshold) {
+    gaussianBlur(executor, src, dst, sigma);
+    int gain = (int)floor(amount * 256.0 + 0.5); // Q8
+    if (src.wide()) {
+        unsharpApply<uint16_t>(executor, src, dst, gain, threshold);
+    } else {
+        unsharpApply<unsigned char>(executor, src, dst, gain, threshold);
+    }
+}
+
+/*--------------------------------- Sobel -----------------------------------*/
+
+// Luminância (pesos Q15 do grayScale) de uma linha. S são as somas
+// intermediárias: short com 8 bits, int com 16.
+template <typename T, typename S>
+inline void lumaRow(const T *row, int w, S *out) {
+    GrayWeights g = grayWeightsLuma();
+    for (int x = 0; x < w; x++) {
+        out[x] = (S)(((uint32_t)row[3*x] * g.r + (uint32_t)row[3*x+1] * g.g + (uint32_t)row[3*x+2] * g.b) >> 15);
+    }
+}
+
+// Parte horizontal do Sobel: suavização [1 2 1] e derivada [-1 0 1]
+template <typename S>
+inline void sobelRow(const S *luma, int w, S *smooth, S *diff) {
+    for (int x = 0; x < w; x++) {
+        int l = luma[x > 0 ? x - 1 : 0], c = luma[x], r = luma[x + 1 < w ? x + 1 : w - 1];
+        smooth[x] = (S)(l + 2 * c + r);
+        diff[x] = (S)(r - l);
+    }
+}
+
+// Parte vertical: gx = d(y-1) + 2d(y) + d(y+1), gy = s(y+1) - s(y-1).
+// Magnitude (|gx| + |gy|) / 2, saturada no máximo de T.
+template <typename S, typename T>
+inline void sobelMagnitudeScalar(const S *sUp, const S *sDown, const S *dUp, const S *dMid,
+                                 const S *dDown, T *mag, int w) {
+    for (int x = 0; x < w; x++) {
+        int gx = dUp[x] + 2 * dMid[x] + dDown[x];
+        int gy = sDown[x] - sUp[x];
+        int m = ((gx < 0 ? -gx : gx) + (gy < 0 ? -gy : gy) + 1) >> 1;
+        mag[x] = (T)(m > sampleMax<T>() ? sampleMax<T>() : m);
+    }
+}
+
+#if CPU_HAS_SSE2
+inline void sobelMagnitudeSSE2(const short *sUp, const short *sDown, const short *dUp, const short *dMid,
+                               const short *dDown, unsigned char *mag, int w) {
+    const __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi16(1);
+    int x = 0;
+    for (; x + 16 <= w; x += 16) {
+        __m128i m[2];
+        for (int half = 0; half < 2; half++) {
+            int i = x + 8 * half;
+            __m128i mid = _mm_loadu_si128((const __m128i *)(dMid + i));
+            __m128i gx = _mm_add_epi16(_mm_add_epi16(_mm_loadu_si128((const __m128i *)(dUp + i)), _mm_add_epi16(mid, mid)),
+                                       _mm_loadu_si128((const __m128i *)(dDown + i)));
+            __m128i gy = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)(sDown + i)), _mm_loadu_si128((const __m128i *)(sUp + i)));
+            __m128i ax = _mm_max_epi16(gx, _mm_sub_epi16(zero, gx));
+            __m128i ay = _mm_max_epi16(gy, _mm_sub_epi16(zero, gy));
+            m[half] = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(ax, ay), one), 1);
+        }
+        _mm_storeu_si128((__m128i *)(mag + x), _mm_packus_epi16(m[0], m[1]));
+    }
+    sobelMagnitudeScalar(sUp + x, sDown + x, dUp + x, dMid + x, dDown + x, mag + x, w - x);
+}
+#endif
+
+// Magnitude de uma linha; só a versão de 8 bits tem SSE2
+inline void sobelMagnitude(const short *sUp, const short *sDown, const short *dUp, const short *dMid,
+                           const short *dDown, unsigned char *mag, int w) {
+#if CPU_HAS_SSE2
+    if (activeSimdLevel() >= SIMD_SSE2) {
+        sobelMagnitudeSSE2(sUp, sDown, dUp, dMid, dDown, mag, w);
+        return;
+    }
+#endif
+    sobelMagnitudeScalar(sUp, sDown, dUp, dMid, dDown, mag, w);
+}
+
+inline void sobelMagnitude(const int *sUp, const int *sDown, const int *dUp, const int *dMid,
+                           const int *dDown, uint16_t *mag, int w) {
+    sobelMagnitudeScalar(sUp, sDown, dUp, dMid, dDown, mag, w);
+}
+
+template <typename T, typename S>
+inline void sobelEdgesBands(RowExecutor &executor, const ImageView &src, const ImageView &dst) {
+    int w = src.width, h = src.height;
+    executor.forEachBand(h, (size_t)w * 3 * sizeof(T), [&](int y0, int y1) {
+        std::vector<S> luma(w), s[3], d[3];
+        std::vector<T> mag(w);
+        for (int k = 0; k < 3; k++) { s[k].resize(w); d[k].resize(w); }
+        // linhas y-1, y, y+1 em rodízio: slot (y + 1) % 3
+        auto load = [&](int y) {
+            int slot = (y + 1) % 3;
+            lumaRow((const T *)src.row(clampInt(y, 0, h - 1)), w, luma.data());
+            sobelRow(luma.data(), w, s[slot].data(), d[slot].data());
+        };
+        load(y0 - 1);
+        load(y0);
+        for (int y = y0; y < y1; y++) {
+            load(y + 1);
+            int up = y % 3, mid = (y + 1) % 3, down = (y + 2) % 3;
+            sobelMagnitude(s[up].data(), s[down].data(), d[up].data(), d[mid].data(), d[down].data(), mag.data(), w);
+            T *out = (T *)dst.row(y);
+            for (int x = 0; x < w; x++) out[3*x] = out[3*x+1] = out[3*x+2] = mag[x];
+        }
+    });
+}
+
+// Bordas de Sobel sobre a luminância, em tons de cinza (RGB intercalado)
+inline void sobelEdges(RowExecutor &executor, const ImageView &src, const ImageView &dst) {
+    if (src.wide()) {
+        sobelEdgesBands<uint16_t, int>(executor, src, dst);
+    } else {
+        sobelEdgesBands<unsigned char, short>(executor, src, dst);
+    }
+}
+
+#endif /* Convolve_h */
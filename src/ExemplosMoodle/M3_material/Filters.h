@@ -0,0 +1,685 @@
+//
+//  Filters.h
+//
+//  Kernels dos filtros por pixel do exemplo_03 (chroma-key, tons de cinza,
+//  colorização e negativo) sobre RGB intercalado de 8 bits. Cada filtro tem
+//  um caminho escalar e versões SSE2/AVX2 escolhidas em tempo de execução
+//  (CpuFeatures.h); todos usam a mesma aritmética inteira e produzem saída
+//  idêntica bit a bit.
+//
+//  As versões de 16 bits (uint16_t em 0..65535, ver PPM.h) recebem as cores
+//  em 0..255 e as esticam (x 257). Negativo e colorização são XOR/OR sobre
+//  os bytes e têm SSE2 e AVX2; tons de cinza e chroma-key precisam separar
+//  os canais de 16 bits com pshufb e só têm AVX2 além do escalar.
+//
+
+#ifndef Filters_h
+#define Filters_h
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "CpuFeatures.h"
+
+// Pesos de tons de cinza em ponto fixo Q15 (somam 32768, ou 32769 na média
+// simples para que 255 continue 255). cinza = (r*wr + g*wg + b*wb) >> 15.
+struct GrayWeights {
+    int r, g, b;
+};
+
+inline GrayWeights grayWeightsAverage() { GrayWeights w = { 10923, 10923, 10923 }; return w; }
+inline GrayWeights grayWeightsLuma()    { GrayWeights w = { 6963, 23442, 2363 }; return w; } // 0.2125 0.7154 0.0721
+
+// Limiar da chave em distância ao quadrado: d/dmax < t  <=>  d² < t²·dmax²,
+// com dmax² = 3·255². Devolve o menor inteiro T tal que d² < T equivale ao
+// teste original, dispensando sqrt por pixel.
+inline int chromaKeyThreshold(double tolerance) {
+    if (tolerance <= 0.0) return 0;
+    double t = tolerance * tolerance * 195075.0;
+    if (t > 195076.0) return 195076;
+    return (int)ceil(t);
+}
+
+/*-------------------------------- ESCALAR ----------------------------------*/
+
+inline void negativeScalar(unsigned char *data, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) data[i] ^= 255;
+}
+
+inline void colorizeScalar(unsigned char *data, size_t pixels, unsigned char r, unsigned char g, unsigned char b) {
+    for (size_t i = 0; i < pixels * 3; i += 3) {
+        data[i]   |= r;
+        data[i+1] |= g;
+        data[i+2] |= b;
+    }
+}
+
+inline void grayScaleScalar(unsigned char *data, size_t pixels, GrayWeights w) {
+    for (size_t i = 0; i < pixels * 3; i += 3) {
+        int v = (data[i] * w.r + data[i+1] * w.g + data[i+2] * w.b) >> 15;
+        data[i] = data[i+1] = data[i+2] = (unsigned char)(v > 255 ? 255 : v);
+    }
+}
+
+inline void chromaKeyScalar(unsigned char *data, size_t pixels, int r, int g, int b, int threshold) {
+    for (size_t i = 0; i < pixels * 3; i += 3) {
+        int dr = data[i] - r, dg = data[i+1] - g, db = data[i+2] - b;
+        if (dr * dr + dg * dg + db * db < threshold) {
+            data[i] = data[i+1] = data[i+2] = 0;
+        }
+    }
+}
+
+/*--------------------------------- SSE2 ------------------------------------*/
+#if CPU_HAS_SSE2
+
+// Separa 16 pixels RGB (48 bytes) em três registradores r, g, b usando só
+// unpacks (SSE2 não tem pshufb).
+static inline void loadDeinterleaveRGB_SSE2(const unsigned char *p, __m128i &a, __m128i &b, __m128i &c) {
+    __m128i t00 = _mm_loadu_si128((const __m128i *)p);
+    __m128i t01 = _mm_loadu_si128((const __m128i *)(p + 16));
+    __m128i t02 = _mm_loadu_si128((const __m128i *)(p + 32));
+
+    __m128i t10 = _mm_unpacklo_epi8(t00, _mm_unpackhi_epi64(t01, t01));
+    __m128i t11 = _mm_unpacklo_epi8(_mm_unpackhi_epi64(t00, t00), t02);
+    __m128i t12 = _mm_unpacklo_epi8(t01, _mm_unpackhi_epi64(t02, t02));
+
+    __m128i t20 = _mm_unpacklo_epi8(t10, _mm_unpackhi_epi64(t11, t11));
+    __m128i t21 = _mm_unpacklo_epi8(_mm_unpackhi_epi64(t10, t10), t12);
+    __m128i t22 = _mm_unpacklo_epi8(t11, _mm_unpackhi_epi64(t12, t12));
+
+    __m128i t30 = _mm_unpacklo_epi8(t20, _mm_unpackhi_epi64(t21, t21));
+    __m128i t31 = _mm_unpacklo_epi8(_mm_unpackhi_epi64(t20, t20), t22);
+    __m128i t32 = _mm_unpacklo_epi8(t21, _mm_unpackhi_epi64(t22, t22));
+
+    a = _mm_unpacklo_epi8(t30, _mm_unpackhi_epi64(t31, t31));
+    b = _mm_unpacklo_epi8(_mm_unpackhi_epi64(t30, t30), t32);
+    c = _mm_unpacklo_epi8(t31, _mm_unpackhi_epi64(t32, t32));
+}
+
+// Inverso de loadDeinterleaveRGB_SSE2.
+static inline void storeInterleaveRGB_SSE2(unsigned char *p, __m128i a, __m128i b, __m128i c) {
+    __m128i z = _mm_setzero_si128();
+    __m128i ab0 = _mm_unpacklo_epi8(a, b);
+    __m128i ab1 = _mm_unpackhi_epi8(a, b);
+    __m128i c0 = _mm_unpacklo_epi8(c, z);
+    __m128i c1 = _mm_unpackhi_epi8(c, z);
+
+    __m128i p00 = _mm_unpacklo_epi16(ab0, c0);
+    __m128i p01 = _mm_unpackhi_epi16(ab0, c0);
+    __m128i p02 = _mm_unpacklo_epi16(ab1, c1);
+    __m128i p03 = _mm_unpackhi_epi16(ab1, c1);
+
+    __m128i p10 = _mm_unpacklo_epi32(p00, p01);
+    __m128i p11 = _mm_unpackhi_epi32(p00, p01);
+    __m128i p12 = _mm_unpacklo_epi32(p02, p03);
+    __m128i p13 = _mm_unpackhi_epi32(p02, p03);
+
+    __m128i p20 = _mm_unpacklo_epi64(p10, p11);
+    __m128i p21 = _mm_unpackhi_epi64(p10, p11);
+    __m128i p22 = _mm_unpacklo_epi64(p12, p13);
+    __m128i p23 = _mm_unpackhi_epi64(p12, p13);
+
+    p20 = _mm_slli_si128(p20, 1);
+    p22 = _mm_slli_si128(p22, 1);
+
+    __m128i p30 = _mm_slli_epi64(_mm_unpacklo_epi32(p20, p21), 8);
+    __m128i p31 = _mm_srli_epi64(_mm_unpackhi_epi32(p20, p21), 8);
+    __m128i p32 = _mm_slli_epi64(_mm_unpacklo_epi32(p22, p23), 8);
+    __m128i p33 = _mm_srli_epi64(_mm_unpackhi_epi32(p22, p23), 8);
+
+    __m128i p40 = _mm_unpacklo_epi64(p30, p31);
+    __m128i p41 = _mm_unpackhi_epi64(p30, p31);
+    __m128i p42 = _mm_unpacklo_epi64(p32, p33);
+    __m128i p43 = _mm_unpackhi_epi64(p32, p33);
+
+    _mm_storeu_si128((__m128i *)p,        _mm_or_si128(_mm_srli_si128(p40, 2), _mm_slli_si128(p41, 10)));
+    _mm_storeu_si128((__m128i *)(p + 16), _mm_or_si128(_mm_srli_si128(p41, 6), _mm_slli_si128(p42, 6)));
+    _mm_storeu_si128((__m128i *)(p + 32), _mm_or_si128(_mm_srli_si128(p42, 10), _mm_slli_si128(p43, 2)));
+}
+
+// (x*wx + y*wy + z*wz) >> 15 para 8 amostras de 16 bits, via madd em 32 bits.
+static inline __m128i weightedSum8_SSE2(__m128i x, __m128i y, __m128i z, __m128i wxy, __m128i wz0) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(x, y), wxy),
+                               _mm_madd_epi16(_mm_unpacklo_epi16(z, zero), wz0));
+    __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(x, y), wxy),
+                               _mm_madd_epi16(_mm_unpackhi_epi16(z, zero), wz0));
+    return _mm_packs_epi32(_mm_srai_epi32(lo, 15), _mm_srai_epi32(hi, 15));
+}
+
+// Soma dos quadrados (x² + y² + z²) de 8 diferenças de 16 bits, em 32
+// bits: lo com as amostras 0..3, hi com 4..7.
+static inline void squaredDistance8_SSE2(__m128i x, __m128i y, __m128i z, __m128i &lo, __m128i &hi) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i xylo = _mm_unpacklo_epi16(x, y), xyhi = _mm_unpackhi_epi16(x, y);
+    __m128i zlo = _mm_unpacklo_epi16(z, zero), zhi = _mm_unpackhi_epi16(z, zero);
+    lo = _mm_add_epi32(_mm_madd_epi16(xylo, xylo), _mm_madd_epi16(zlo, zlo));
+    hi = _mm_add_epi32(_mm_madd_epi16(xyhi, xyhi), _mm_madd_epi16(zhi, zhi));
+}
+
+// Distância comparada com o limiar: máscara 16 bits (0xffff = dentro da chave)
+static inline __m128i keyMask8_SSE2(__m128i x, __m128i y, __m128i z, __m128i threshold) {
+    __m128i lo, hi;
+    squaredDistance8_SSE2(x, y, z, lo, hi);
+    return _mm_packs_epi32(_mm_cmpgt_epi32(threshold, lo), _mm_cmpgt_epi32(threshold, hi));
+}
+
+inline void negativeSSE2(unsigned char *data, size_t bytes) {
+    const __m128i ones = _mm_set1_epi8((char)0xff);
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+        _mm_storeu_si128((__m128i *)(data + i), _mm_xor_si128(v, ones));
+    }
+    negativeScalar(data + i, bytes - i);
+}
+
+// OR com um padrão de 48 bytes (16 pixels) alinhado ao início dos pixels.
+inline void colorizeSSE2(unsigned char *data, size_t pixels, unsigned char r, unsigned char g, unsigned char b) {
+    unsigned char pattern[48];
+    for (int k = 0; k < 48; k += 3) { pattern[k] = r; pattern[k+1] = g; pattern[k+2] = b; }
+    __m128i m0 = _mm_loadu_si128((const __m128i *)pattern);
+    __m128i m1 = _mm_loadu_si128((const __m128i *)(pattern + 16));
+    __m128i m2 = _mm_loadu_si128((const __m128i *)(pattern + 32));
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        unsigned char *p = data + i * 3;
+        _mm_storeu_si128((__m128i *)p,        _mm_or_si128(_mm_loadu_si128((const __m128i *)p), m0));
+        _mm_storeu_si128((__m128i *)(p + 16), _mm_or_si128(_mm_loadu_si128((const __m128i *)(p + 16)), m1));
+        _mm_storeu_si128((__m128i *)(p + 32), _mm_or_si128(_mm_loadu_si128((const __m128i *)(p + 32)), m2));
+    }
+    colorizeScalar(data + i * 3, pixels - i, r, g, b);
+}
+
+inline void grayScaleSSE2(unsigned char *data, size_t pixels, GrayWeights w) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wrg = _mm_set_epi16((short)w.g, (short)w.r, (short)w.g, (short)w.r,
+                                      (short)w.g, (short)w.r, (short)w.g, (short)w.r);
+    const __m128i wb0 = _mm_set_epi16(0, (short)w.b, 0, (short)w.b, 0, (short)w.b, 0, (short)w.b);
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        unsigned char *p = data + i * 3;
+        __m128i r, g, b;
+        loadDeinterleaveRGB_SSE2(p, r, g, b);
+        __m128i lo = weightedSum8_SSE2(_mm_unpacklo_epi8(r, zero), _mm_unpacklo_epi8(g, zero),
+                                       _mm_unpacklo_epi8(b, zero), wrg, wb0);
+        __m128i hi = weightedSum8_SSE2(_mm_unpackhi_epi8(r, zero), _mm_unpackhi_epi8(g, zero),
+                                       _mm_unpackhi_epi8(b, zero), wrg, wb0);
+        __m128i gray = _mm_packus_epi16(lo, hi);
+        storeInterleaveRGB_SSE2(p, gray, gray, gray);
+    }
+    grayScaleScalar(data + i * 3, pixels - i, w);
+}
+
+inline void chromaKeySSE2(unsigned char *data, size_t pixels, int kr, int kg, int kb, int threshold) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i vr = _mm_set1_epi16((short)kr), vg = _mm_set1_epi16((short)kg), vb = _mm_set1_epi16((short)kb);
+    const __m128i vt = _mm_set1_epi32(threshold);
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        unsigned char *p = data + i * 3;
+        __m128i r, g, b;
+        loadDeinterleaveRGB_SSE2(p, r, g, b);
+        __m128i lo = keyMask8_SSE2(_mm_sub_epi16(_mm_unpacklo_epi8(r, zero), vr),
+                                   _mm_sub_epi16(_mm_unpacklo_epi8(g, zero), vg),
+                                   _mm_sub_epi16(_mm_unpacklo_epi8(b, zero), vb), vt);
+        __m128i hi = keyMask8_SSE2(_mm_sub_epi16(_mm_unpackhi_epi8(r, zero), vr),
+                                   _mm_sub_epi16(_mm_unpackhi_epi8(g, zero), vg),
+                                   _mm_sub_epi16(_mm_unpackhi_epi8(b, zero), vb), vt);
+        __m128i keep = _mm_xor_si128(_mm_packs_epi16(lo, hi), _mm_set1_epi8((char)0xff));
+        storeInterleaveRGB_SSE2(p, _mm_and_si128(r, keep), _mm_and_si128(g, keep), _mm_and_si128(b, keep));
+    }
+    chromaKeyScalar(data + i * 3, pixels - i, kr, kg, kb, threshold);
+}
+
+#endif /* CPU_HAS_SSE2 */
+
+/*--------------------------------- AVX2 ------------------------------------*/
+#if CPU_HAS_AVX2_TARGET
+
+// Máscaras pshufb para separar/juntar 16 pixels (48 bytes = 3 vetores de
+// 16). deinterleave[c][v]: bytes do canal c vindos do vetor v;
+// interleave[v][c]: bytes do vetor de saída v vindos do canal c.
+struct RGBShuffleMasks {
+    signed char deinterleave[3][3][16];
+    signed char interleave[3][3][16];
+
+    RGBShuffleMasks() {
+        memset(deinterleave, -1, sizeof(deinterleave));
+        memset(interleave, -1, sizeof(interleave));
+        for (int pixel = 0; pixel < 16; pixel++) {
+            for (int c = 0; c < 3; c++) {
+                int byte = pixel * 3 + c;
+                deinterleave[c][byte / 16][pixel] = (signed char)(byte % 16);
+                interleave[byte / 16][c][byte % 16] = (signed char)pixel;
+            }
+        }
+    }
+};
+
+inline const RGBShuffleMasks &rgbShuffleMasks() {
+    static const RGBShuffleMasks masks;
+    return masks;
+}
+
+static inline TARGET_AVX2 __m256i loadMask_AVX2(const signed char *m) {
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)m));
+}
+
+// 32 pixels (96 bytes): a faixa baixa de cada registrador recebe os pixels
+// 0..15 e a alta os pixels 16..31, e cada uma é separada com pshufb.
+static inline TARGET_AVX2 void loadDeinterleaveRGB_AVX2(const unsigned char *p, __m256i &r, __m256i &g, __m256i &b) {
+    const RGBShuffleMasks &m = rgbShuffleMasks();
+    __m256i v[3];
+    for (int k = 0; k < 3; k++) {
+        v[k] = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(p + 16 * k))),
+            _mm_loadu_si128((const __m128i *)(p + 48 + 16 * k)), 1);
+    }
+    __m256i *out[3] = { &r, &g, &b };
+    for (int c = 0; c < 3; c++) {
+        *out[c] = _mm256_or_si256(
+            _mm256_or_si256(_mm256_shuffle_epi8(v[0], loadMask_AVX2(m.deinterleave[c][0])),
+                            _mm256_shuffle_epi8(v[1], loadMask_AVX2(m.deinterleave[c][1]))),
+            _mm256_shuffle_epi8(v[2], loadMask_AVX2(m.deinterleave[c][2])));
+    }
+}
+
+static inline TARGET_AVX2 void storeInterleaveRGB_AVX2(unsigned char *p, __m256i r, __m256i g, __m256i b) {
+    const RGBShuffleMasks &m = rgbShuffleMasks();
+    for (int k = 0; k < 3; k++) {
+        __m256i v = _mm256_or_si256(
+            _mm256_or_si256(_mm256_shuffle_epi8(r, loadMask_AVX2(m.interleave[k][0])),
+                            _mm256_shuffle_epi8(g, loadMask_AVX2(m.interleave[k][1]))),
+            _mm256_shuffle_epi8(b, loadMask_AVX2(m.interleave[k][2])));
+        _mm_storeu_si128((__m128i *)(p + 16 * k), _mm256_castsi256_si128(v));
+        _mm_storeu_si128((__m128i *)(p + 48 + 16 * k), _mm256_extracti128_si256(v, 1));
+    }
+}
+
+static inline TARGET_AVX2 __m256i weightedSum16_AVX2(__m256i x, __m256i y, __m256i z, __m256i wxy, __m256i wz0) {
+    __m256i zero = _mm256_setzero_si256();
+    __m256i lo = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(x, y), wxy),
+                                  _mm256_madd_epi16(_mm256_unpacklo_epi16(z, zero), wz0));
+    __m256i hi = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(x, y), wxy),
+                                  _mm256_madd_epi16(_mm256_unpackhi_epi16(z, zero), wz0));
+    return _mm256_packs_epi32(_mm256_srai_epi32(lo, 15), _mm256_srai_epi32(hi, 15));
+}
+
+// Como squaredDistance8_SSE2, em cada faixa de 128 bits
+static inline TARGET_AVX2 void squaredDistance16_AVX2(__m256i x, __m256i y, __m256i z, __m256i &lo, __m256i &hi) {
+    __m256i zero = _mm256_setzero_si256();
+    __m256i xylo = _mm256_unpacklo_epi16(x, y), xyhi = _mm256_unpackhi_epi16(x, y);
+    __m256i zlo = _mm256_unpacklo_epi16(z, zero), zhi = _mm256_unpackhi_epi16(z, zero);
+    lo = _mm256_add_epi32(_mm256_madd_epi16(xylo, xylo), _mm256_madd_epi16(zlo, zlo));
+    hi = _mm256_add_epi32(_mm256_madd_epi16(xyhi, xyhi), _mm256_madd_epi16(zhi, zhi));
+}
+
+static inline TARGET_AVX2 __m256i keyMask16_AVX2(__m256i x, __m256i y, __m256i z, __m256i threshold) {
+    __m256i lo, hi;
+    squaredDistance16_AVX2(x, y, z, lo, hi);
+    return _mm256_packs_epi32(_mm256_cmpgt_epi32(threshold, lo), _mm256_cmpgt_epi32(threshold, hi));
+}
+
+inline TARGET_AVX2 void negativeAVX2(unsigned char *data, size_t bytes) {
+    const __m256i ones = _mm256_set1_epi8((char)0xff);
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + i));
+        _mm256_storeu_si256((__m256i *)(data + i), _mm256_xor_si256(v, ones));
+    }
+    negativeScalar(data + i, bytes - i);
+}
+
+inline TARGET_AVX2 void colorizeAVX2(unsigned char *data, size_t pixels, unsigned char r, unsigned char g, unsigned char b) {
+    unsigned char pattern[96];
+    for (int k = 0; k < 96; k += 3) { pattern[k] = r; pattern[k+1] = g; pattern[k+2] = b; }
+    __m256i m0 = _mm256_loadu_si256((const __m256i *)pattern);
+    __m256i m1 = _mm256_loadu_si256((const __m256i *)(pattern + 32));
+    __m256i m2 = _mm256_loadu_si256((const __m256i *)(pattern + 64));
+    size_t i = 0;
+    for (; i + 32 <= pixels; i += 32) {
+        unsigned char *p = data + i * 3;
+        _mm256_storeu_si256((__m256i *)p,        _mm256_or_si256(_mm256_loadu_si256((const __m256i *)p), m0));
+        _mm256_storeu_si256((__m256i *)(p + 32), _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(p + 32)), m1));
+        _mm256_storeu_si256((__m256i *)(p + 64), _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(p + 64)), m2));
+    }
+    colorizeScalar(data + i * 3, pixels - i, r, g, b);
+}
+
+inline TARGET_AVX2 void grayScaleAVX2(unsigned char *data, size_t pixels, GrayWeights w) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i wrg = _mm256_set1_epi32((int)(((unsigned)w.g << 16) | (unsigned)w.r));
+    const __m256i wb0 = _mm256_set1_epi32(w.b);
+    size_t i = 0;
+    for (; i + 32 <= pixels; i += 32) {
+        unsigned char *p = data + i * 3;
+        __m256i r, g, b;
+        loadDeinterleaveRGB_AVX2(p, r, g, b);
+        __m256i lo = weightedSum16_AVX2(_mm256_unpacklo_epi8(r, zero), _mm256_unpacklo_epi8(g, zero),
+                                        _mm256_unpacklo_epi8(b, zero), wrg, wb0);
+        __m256i hi = weightedSum16_AVX2(_mm256_unpackhi_epi8(r, zero), _mm256_unpackhi_epi8(g, zero),
+                                        _mm256_unpackhi_epi8(b, zero), wrg, wb0);
+        __m256i gray = _mm256_packus_epi16(lo, hi);
+        storeInterleaveRGB_AVX2(p, gray, gray, gray);
+    }
+    grayScaleScalar(data + i * 3, pixels - i, w);
+}
+
+inline TARGET_AVX2 void chromaKeyAVX2(unsigned char *data, size_t pixels, int kr, int kg, int kb, int threshold) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i vr = _mm256_set1_epi16((short)kr), vg = _mm256_set1_epi16((short)kg), vb = _mm256_set1_epi16((short)kb);
+    const __m256i vt = _mm256_set1_epi32(threshold);
+    const __m256i ones = _mm256_set1_epi8((char)0xff);
+    size_t i = 0;
+    for (; i + 32 <= pixels; i += 32) {
+        unsigned char *p = data + i * 3;
+        __m256i r, g, b;
+        loadDeinterleaveRGB_AVX2(p, r, g, b);
+        __m256i lo = keyMask16_AVX2(_mm256_sub_epi16(_mm256_unpacklo_epi8(r, zero), vr),
+                                    _mm256_sub_epi16(_mm256_unpacklo_epi8(g, zero), vg),
+                                    _mm256_sub_epi16(_mm256_unpacklo_epi8(b, zero), vb), vt);
+        __m256i hi = keyMask16_AVX2(_mm256_sub_epi16(_mm256_unpackhi_epi8(r, zero), vr),
+                                    _mm256_sub_epi16(_mm256_unpackhi_epi8(g, zero), vg),
+                                    _mm256_sub_epi16(_mm256_unpackhi_epi8(b, zero), vb), vt);
+        __m256i keep = _mm256_xor_si256(_mm256_packs_epi16(lo, hi), ones);
+        storeInterleaveRGB_AVX2(p, _mm256_and_si256(r, keep), _mm256_and_si256(g, keep), _mm256_and_si256(b, keep));
+    }
+    chromaKeyScalar(data + i * 3, pixels - i, kr, kg, kb, threshold);
+}
+
+#endif /* CPU_HAS_AVX2_TARGET */
+
+/*------------------------------- DESPACHO ----------------------------------*/
+
+inline void applyNegative(unsigned char *data, size_t pixels) {
+    switch (activeSimdLevel()) {
+#if CPU_HAS_AVX2_TARGET
+        case SIMD_AVX2: negativeAVX2(data, pixels * 3); return;
+#endif
+#if CPU_HAS_SSE2
+        case SIMD_SSE2: negativeSSE2(data, pixels * 3); return;
+#endif
+        default: negativeScalar(data, pixels * 3);
+    }
+}
+
+inline void applyColorize(unsigned char *data, size_t pixels, int r, int g, int b) {
+    unsigned char cr = (unsigned char)r, cg = (unsigned char)g, cb = (unsigned char)b;
+    switch (activeSimdLevel()) {
+#if CPU_HAS_AVX2_TARGET
+        case SIMD_AVX2: colorizeAVX2(data, pixels, cr, cg, cb); return;
+#endif
+#if CPU_HAS_SSE2
+        case SIMD_SSE2: colorizeSSE2(data, pixels, cr, cg, cb); return;
+#endif
+        default: colorizeScalar(data, pixels, cr, cg, cb);
+    }
+}
+
+inline void applyGrayScale(unsigned char *data, size_t pixels, GrayWeights w) {
+    switch (activeSimdLevel()) {
+#if CPU_HAS_AVX2_TARGET
+        case SIMD_AVX2: grayScaleAVX2(data, pixels, w); return;
+#endif
+#if CPU_HAS_SSE2
+        case SIMD_SSE2: grayScaleSSE2(data, pixels, w); return;
+#endif
+        default: grayScaleScalar(data, pixels, w);
+    }
+}
+
+// threshold = chromaKeyThreshold(tolerância)
+inline void applyChromaKey(unsigned char *data, size_t pixels, int r, int g, int b, int threshold) {
+    switch (activeSimdLevel()) {
+#if CPU_HAS_AVX2_TARGET
+        case SIMD_AVX2: chromaKeyAVX2(data, pixels, r, g, b, threshold); return;
+#endif
+#if CPU_HAS_SSE2
+        case SIMD_SSE2: chromaKeySSE2(data, pixels, r, g, b, threshold); return;
+#endif
+        default: chromaKeyScalar(data, pixels, r, g, b, threshold);
+    }
+}
+
+/*------------------------------- 16 BITS -----------------------------------*/
+
+// Mesmo teste de chromaKeyThreshold com dmax² = 3·65535² (cabe em 64 bits)
+inline int64_t chromaKeyThreshold16(double tolerance) {
+    if (tolerance <= 0.0) return 0;
+    const double dmax2 = 3.0 * 65535.0 * 65535.0;
+    double t = tolerance * tolerance * dmax2;
+    if (t > dmax2 + 1.0) return (int64_t)dmax2 + 1;
+    return (int64_t)ceil(t);
+}
+
+inline uint16_t widenColor(int c) { return (uint16_t)((c < 0 ? 0 : c > 255 ? 255 : c) * 257); }
+
+inline void colorize16Scalar(uint16_t *data, size_t pixels, uint16_t r, uint16_t g, uint16_t b) {
+    for (size_t i = 0; i < pixels * 3; i += 3) {
+        data[i]   |= r;
+        data[i+1] |= g;
+        data[i+2] |= b;
+    }
+}
+
+// Produtos de até 65535 x 32769 cabem em 32 bits sem sinal
+inline void grayScale16Scalar(uint16_t *data, size_t pixels, GrayWeights w) {
+    for (size_t i = 0; i < pixels * 3; i += 3) {
+        uint32_t v = (data[i] * (uint32_t)w.r + data[i+1] * (uint32_t)w.g + data[i+2] * (uint32_t)w.b) >> 15;
+        data[i] = data[i+1] = data[i+2] = (uint16_t)(v > 65535 ? 65535 : v);
+    }
+}
+
+inline void chromaKey16Scalar(uint16_t *data, size_t pixels, int r, int g, int b, int64_t threshold) {
+    for (size_t i = 0; i < pixels * 3; i += 3) {
+        int64_t dr = data[i] - r, dg = data[i+1] - g, db = data[i+2] - b;
+        if (dr * dr + dg * dg + db * db < threshold) {
+            data[i] = data[i+1] = data[i+2] = 0;
+        }
+    }
+}
+
+#if CPU_HAS_SSE2
+// Padrão de 24 amostras (8 pixels) em três registradores
+inline void colorize16SSE2(uint16_t *data, size_t pixels, uint16_t r, uint16_t g, uint16_t b) {
+    uint16_t pattern[24];
+    for (int k = 0; k < 24; k += 3) { pattern[k] = r; pattern[k+1] = g; pattern[k+2] = b; }
+    __m128i m[3];
+    for (int k = 0; k < 3; k++) m[k] = _mm_loadu_si128((const __m128i *)(pattern + 8 * k));
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        uint16_t *p = data + i * 3;
+        for (int k = 0; k < 3; k++) {
+            __m128i *q = (__m128i *)(p + 8 * k);
+            _mm_storeu_si128(q, _mm_or_si128(_mm_loadu_si128(q), m[k]));
+        }
+    }
+    colorize16Scalar(data + i * 3, pixels - i, r, g, b);
+}
+#endif /* CPU_HAS_SSE2 */
+
+#if CPU_HAS_AVX2_TARGET
+inline TARGET_AVX2 void colorize16AVX2(uint16_t *data, size_t pixels, uint16_t r, uint16_t g, uint16_t b) {
+    uint16_t pattern[48];
+    for (int k = 0; k < 48; k += 3) { pattern[k] = r; pattern[k+1] = g; pattern[k+2] = b; }
+    __m256i m[3];
+    for (int k = 0; k < 3; k++) m[k] = _mm256_loadu_si256((const __m256i *)(pattern + 16 * k));
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        uint16_t *p = data + i * 3;
+        for (int k = 0; k < 3; k++) {
+            __m256i *q = (__m256i *)(p + 16 * k);
+            _mm256_storeu_si256(q, _mm256_or_si256(_mm256_loadu_si256(q), m[k]));
+        }
+    }
+    colorize16Scalar(data + i * 3, pixels - i, r, g, b);
+}
+
+// Como RGBShuffleMasks, para amostras de 2 bytes: 8 pixels por vetor de 16
+struct RGB16ShuffleMasks {
+    signed char deinterleave[3][3][16];
+    signed char interleave[3][3][16];
+
+    RGB16ShuffleMasks() {
+        memset(deinterleave, -1, sizeof(deinterleave));
+        memset(interleave, -1, sizeof(interleave));
+        for (int pixel = 0; pixel < 8; pixel++) {
+            for (int c = 0; c < 3; c++) {
+                int byte = (pixel * 3 + c) * 2;
+                for (int half = 0; half < 2; half++) {
+                    deinterleave[c][byte / 16][pixel * 2 + half] = (signed char)(byte % 16 + half);
+                    interleave[byte / 16][c][byte % 16 + half] = (signed char)(pixel * 2 + half);
+                }
+            }
+        }
+    }
+};
+
+inline const RGB16ShuffleMasks &rgb16ShuffleMasks() {
+    static const RGB16ShuffleMasks masks;
+    return masks;
+}
+
+// 16 pixels (96 bytes): pixels 0..7 na faixa baixa, 8..15 na alta
+static inline TARGET_AVX2 void loadDeinterleaveRGB16_AVX2(const uint16_t *p, __m256i &r, __m256i &g, __m256i &b) {
+    const RGB16ShuffleMasks &m = rgb16ShuffleMasks();
+    const unsigned char *bytes = (const unsigned char *)p;
+    __m256i v[3];
+    for (int k = 0; k < 3; k++) {
+        v[k] = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(bytes + 16 * k))),
+            _mm_loadu_si128((const __m128i *)(bytes + 48 + 16 * k)), 1);
+    }
+    __m256i *out[3] = { &r, &g, &b };
+    for (int c = 0; c < 3; c++) {
+        *out[c] = _mm256_or_si256(
+            _mm256_or_si256(_mm256_shuffle_epi8(v[0], loadMask_AVX2(m.deinterleave[c][0])),
+                            _mm256_shuffle_epi8(v[1], loadMask_AVX2(m.deinterleave[c][1]))),
+            _mm256_shuffle_epi8(v[2], loadMask_AVX2(m.deinterleave[c][2])));
+    }
+}
+
+static inline TARGET_AVX2 void storeInterleaveRGB16_AVX2(uint16_t *p, __m256i r, __m256i g, __m256i b) {
+    const RGB16ShuffleMasks &m = rgb16ShuffleMasks();
+    unsigned char *bytes = (unsigned char *)p;
+    for (int k = 0; k < 3; k++) {
+        __m256i v = _mm256_or_si256(
+            _mm256_or_si256(_mm256_shuffle_epi8(r, loadMask_AVX2(m.interleave[k][0])),
+                            _mm256_shuffle_epi8(g, loadMask_AVX2(m.interleave[k][1]))),
+            _mm256_shuffle_epi8(b, loadMask_AVX2(m.interleave[k][2])));
+        _mm_storeu_si128((__m128i *)(bytes + 16 * k), _mm256_castsi256_si128(v));
+        _mm_storeu_si128((__m128i *)(bytes + 48 + 16 * k), _mm256_extracti128_si256(v, 1));
+    }
+}
+
+// x * w em 32 bits (w < 32768): metades baixa e alta de cada faixa
+static inline TARGET_AVX2 void mulWide16_AVX2(__m256i x, __m256i w, __m256i &lo, __m256i &hi) {
+    __m256i pl = _mm256_mullo_epi16(x, w), ph = _mm256_mulhi_epu16(x, w);
+    lo = _mm256_unpacklo_epi16(pl, ph);
+    hi = _mm256_unpackhi_epi16(pl, ph);
+}
+
+inline TARGET_AVX2 void grayScale16AVX2(uint16_t *data, size_t pixels, GrayWeights w) {
+    const __m256i wr = _mm256_set1_epi16((short)w.r), wg = _mm256_set1_epi16((short)w.g),
+                  wb = _mm256_set1_epi16((short)w.b);
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        uint16_t *p = data + i * 3;
+        __m256i r, g, b, rl, rh, gl, gh, bl, bh;
+        loadDeinterleaveRGB16_AVX2(p, r, g, b);
+        mulWide16_AVX2(r, wr, rl, rh);
+        mulWide16_AVX2(g, wg, gl, gh);
+        mulWide16_AVX2(b, wb, bl, bh);
+        __m256i lo = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(rl, gl), bl), 15);
+        __m256i hi = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(rh, gh), bh), 15);
+        __m256i gray = _mm256_packus_epi32(lo, hi); // satura 65536 (média simples) em 65535
+        storeInterleaveRGB16_AVX2(p, gray, gray, gray);
+    }
+    grayScale16Scalar(data + i * 3, pixels - i, w);
+}
+
+// d² em 64 bits para os 8 inteiros de 32 bits de d: pares e ímpares
+static inline TARGET_AVX2 void square64_AVX2(__m256i d, __m256i &even, __m256i &odd) {
+    __m256i o = _mm256_srli_epi64(d, 32);
+    even = _mm256_mul_epi32(d, d);
+    odd = _mm256_mul_epi32(o, o);
+}
+
+// Máscara de 32 bits (d² < threshold) para metade dos pixels
+static inline TARGET_AVX2 __m256i keyMask32_AVX2(__m256i dr, __m256i dg, __m256i db, __m256i threshold) {
+    __m256i re, ro, ge, go, be, bo;
+    square64_AVX2(dr, re, ro);
+    square64_AVX2(dg, ge, go);
+    square64_AVX2(db, be, bo);
+    __m256i even = _mm256_cmpgt_epi64(threshold, _mm256_add_epi64(_mm256_add_epi64(re, ge), be));
+    __m256i odd = _mm256_cmpgt_epi64(threshold, _mm256_add_epi64(_mm256_add_epi64(ro, go), bo));
+    return _mm256_blend_epi32(even, odd, 0xAA);
+}
+
+inline TARGET_AVX2 void chromaKey16AVX2(uint16_t *data, size_t pixels, int kr, int kg, int kb, int64_t threshold) {
+    const __m256i zero = _mm256_setzero_si256(), ones = _mm256_set1_epi32(-1);
+    const __m256i vr = _mm256_set1_epi32(kr), vg = _mm256_set1_epi32(kg), vb = _mm256_set1_epi32(kb);
+    const __m256i t = _mm256_set1_epi64x(threshold);
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        uint16_t *p = data + i * 3;
+        __m256i r, g, b;
+        loadDeinterleaveRGB16_AVX2(p, r, g, b);
+        __m256i lo = keyMask32_AVX2(_mm256_sub_epi32(_mm256_unpacklo_epi16(r, zero), vr),
+                                    _mm256_sub_epi32(_mm256_unpacklo_epi16(g, zero), vg),
+                                    _mm256_sub_epi32(_mm256_unpacklo_epi16(b, zero), vb), t);
+        __m256i hi = keyMask32_AVX2(_mm256_sub_epi32(_mm256_unpackhi_epi16(r, zero), vr),
+                                    _mm256_sub_epi32(_mm256_unpackhi_epi16(g, zero), vg),
+                                    _mm256_sub_epi32(_mm256_unpackhi_epi16(b, zero), vb), t);
+        __m256i keep = _mm256_xor_si256(_mm256_packs_epi32(lo, hi), ones);
+        storeInterleaveRGB16_AVX2(p, _mm256_and_si256(r, keep), _mm256_and_si256(g, keep), _mm256_and_si256(b, keep));
+    }
+    chromaKey16Scalar(data + i * 3, pixels - i, kr, kg, kb, threshold);
+}
+#endif /* CPU_HAS_AVX2_TARGET */
+
+// Complemento a 65535 = XOR de todos os bytes
+inline void applyNegative16(uint16_t *data, size_t pixels) {
+    applyNegative((unsigned char *)data, pixels * 2);
+}
+
+inline void applyColorize16(uint16_t *data, size_t pixels, int r, int g, int b) {
+    uint16_t cr = widenColor(r), cg = widenColor(g), cb = widenColor(b);
+    switch (activeSimdLevel()) {
+#if CPU_HAS_AVX2_TARGET
+        case SIMD_AVX2: colorize16AVX2(data, pixels, cr, cg, cb); return;
+#endif
+#if CPU_HAS_SSE2
+        case SIMD_SSE2: colorize16SSE2(data, pixels, cr, cg, cb); return;
+#endif
+        default: colorize16Scalar(data, pixels, cr, cg, cb);
+    }
+}
+
+inline void applyGrayScale16(uint16_t *data, size_t pixels, GrayWeights w) {
+#if CPU_HAS_AVX2_TARGET
+    if (activeSimdLevel() >= SIMD_AVX2) {
+        grayScale16AVX2(data, pixels, w);
+        return;
+    }
+#endif
+    grayScale16Scalar(data, pixels, w);
+}
+
+// Cor-chave em 0..255; threshold = chromaKeyThreshold16(tolerância)
+inline void applyChromaKey16(uint16_t *data, size_t pixels, int r, int g, int b, int64_t threshold) {
+    int kr = widenColor(r), kg = widenColor(g), kb = widenColor(b);
+#if CPU_HAS_AVX2_TARGET
+    if (activeSimdLevel() >= SIMD_AVX2) {
+        chromaKey16AVX2(data, pixels, kr, kg, kb, threshold);
+        return;
+    }
+#endif
+    chromaKey16Scalar(data, pixels, kr, kg, kb, threshold);
+}
+
+#endif /* Filters_h */
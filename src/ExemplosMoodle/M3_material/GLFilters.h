@@ -0,0 +1,356 @@
+//
+//  GLFilters.h
+//
+//  Backend OpenGL dos filtros ponto a ponto. A imagem sobe como textura
+//  inteira (RGB8UI), um fragment shader gerado a partir do pipeline roda
+//  todas as operações numa passada só para um FBO RGBA8UI, e o resultado
+//  volta por dois pixel buffers (PBO) alternados: enquanto um bloco é
+//  copiado para um buffer de resultado, o seguinte já está sendo lido. A
+//  imagem só é sobrescrita depois que todos os blocos voltaram sem erro. As contas são as
+//  mesmas dos kernels da CPU, em inteiros, e a saída é idêntica bit a bit.
+//
+//  Roda chroma-key, tons de cinza, colorização e negativo (FilterOp::glsl)
+//  e qualquer tabela por canal (gamma, levels e tabelas fundidas). Imagens
+//  de 16 bits, filtros de vizinhança e análises (histogramas) ficam com a
+//  CPU: runFilters escolhe sozinho.
+//
+//  O contexto é 3.3 core sem janela visível. Sem display (servidor, CI),
+//  usa a plataforma nula da GLFW 3.4 com EGL (Mesa surfaceless, llvmpipe)
+//  ou OSMesa; LIBGL_ALWAYS_SOFTWARE=1 força o llvmpipe mesmo com GPU.
+//
+
+#ifndef GLFilters_h
+#define GLFilters_h
+
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "Pipeline.h"
+
+const int GL_FILTER_TILE = 2048; // lado máximo de cada bloco enviado à GPU
+
+class GLFilterBackend {
+public:
+    GLFilterBackend() : window(NULL), program(0), vao(0), fbo(0), srcTex(0), dstTex(0), lutTex(0),
+                        tileW(0), tileH(0), maxTile(0) { pbo[0] = pbo[1] = 0; }
+    ~GLFilterBackend() { shutdown(); }
+
+    // Cria o contexto e os objetos fixos; em caso de erro explica em error
+    bool init(std::string &error) {
+        if (window) return true;
+        glfwSetErrorCallback(errorCallback);
+        lastError().clear();
+        if (!createContext()) {
+            error = lastError().empty() ? "sem contexto OpenGL 3.3" : lastError();
+            return false;
+        }
+        glfwMakeContextCurrent(window);
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+            error = "falha ao carregar as funções OpenGL";
+            shutdown();
+            return false;
+        }
+        rendererName = (const char *)glGetString(GL_RENDERER);
+
+        GLint maxSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+        maxTile = maxSize < GL_FILTER_TILE ? maxSize : GL_FILTER_TILE;
+        glGenVertexArrays(1, &vao);
+        glGenFramebuffers(1, &fbo);
+        glGenTextures(1, &srcTex);
+        glGenTextures(1, &dstTex);
+        glGenTextures(1, &lutTex);
+        glGenBuffers(2, pbo);
+        if (glGetError() != GL_NO_ERROR) {
+            error = "falha ao criar os objetos OpenGL";
+            shutdown();
+            return false;
+        }
+        return true;
+    }
+
+    void shutdown() {
+        if (!window) return;
+        glfwMakeContextCurrent(window);
+        if (program) glDeleteProgram(program);
+        glDeleteVertexArrays(1, &vao);
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteTextures(1, &srcTex);
+        glDeleteTextures(1, &dstTex);
+        glDeleteTextures(1, &lutTex);
+        glDeleteBuffers(2, pbo);
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        window = NULL;
+        program = 0;
+        tileW = tileH = 0;
+        programSource.clear();
+    }
+
+    bool ready() const { return window != NULL; }
+    const std::string &renderer() const { return rendererName; }
+
+    // RGB intercalado de 8 bits e só operações com shader ou tabela
+    static bool supports(const FilterPipeline &pipeline, const ImageView &image) {
+        if (image.wide() || image.planar() || image.channels != 3 || image.stride % 3 != 0) return false;
+        for (const FilterOp &op : pipeline.steps()) {
+            if (op.area || op.analyze || op.wholeImage || (op.glsl.empty() && !op.lut)) return false;
+        }
+        return !pipeline.empty();
+    }
+
+    // Em caso de erro devolve false e a imagem fica como estava, para a CPU
+    // poder rodar o pipeline nela
+    bool run(const FilterPipeline &pipeline, const ImageView &image, std::string &error) {
+        if (!window || !supports(pipeline, image)) {
+            error = "pipeline ou imagem sem suporte na GPU";
+            return false;
+        }
+        glfwMakeContextCurrent(window);
+        // erros pendentes de antes não são desta chamada
+        while (glGetError() != GL_NO_ERROR) {}
+        if (!prepareProgram(pipeline, error)) return false;
+        allocateTiles(image.width < maxTile ? image.width : maxTile, image.height < maxTile ? image.height : maxTile);
+
+        glUseProgram(program);
+        glBindVertexArray(vao);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, lutTex);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, srcTex);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)(image.stride / 3));
+
+        struct Tile { int x, y, w, h; };
+        std::vector<Tile> tiles;
+        for (int y = 0; y < image.height; y += tileH) {
+            for (int x = 0; x < image.width; x += tileW) {
+                tiles.push_back({ x, y, image.width - x < tileW ? image.width - x : tileW,
+                                  image.height - y < tileH ? image.height - y : tileH });
+            }
+        }
+        // bloco k: envia, desenha e pede a leitura no PBO k % 2; depois copia
+        // o bloco k - 1, cuja leitura já teve o desenho de k para terminar
+        size_t rowBytes = (size_t)image.width * 3;
+        result.resize(rowBytes * image.height);
+        for (size_t k = 0; k <= tiles.size(); k++) {
+            if (k < tiles.size()) {
+                const Tile &t = tiles[k];
+                glPixelStorei(GL_UNPACK_SKIP_PIXELS, t.x);
+                glPixelStorei(GL_UNPACK_SKIP_ROWS, t.y);
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, t.w, t.h, GL_RGB_INTEGER, GL_UNSIGNED_BYTE, image.data);
+                glViewport(0, 0, t.w, t.h);
+                glDrawArrays(GL_TRIANGLES, 0, 3);
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo[k % 2]);
+                glReadPixels(0, 0, t.w, t.h, GL_RGB_INTEGER, GL_UNSIGNED_BYTE, 0);
+            }
+            if (k > 0 && !copyTile(result.data(), rowBytes, tiles[k - 1], pbo[(k - 1) % 2])) {
+                error = "falha ao mapear o PBO";
+                break;
+            }
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+        GLenum status = glGetError();
+        if (status != GL_NO_ERROR && error.empty()) error = "erro OpenGL " + std::to_string(status);
+        if (!error.empty()) return false;
+        for (int y = 0; y < image.height; y++) memcpy(image.row(y), &result[rowBytes * y], rowBytes);
+        return true;
+    }
+
+private:
+    GLFWwindow *window;
+    GLuint program, vao, fbo, srcTex, dstTex, lutTex, pbo[2];
+    int tileW, tileH, maxTile;
+    std::string rendererName, programSource;
+    std::vector<unsigned char> result; // blocos lidos, até a imagem toda voltar
+
+    static std::string &lastError() {
+        static std::string message;
+        return message;
+    }
+
+    static void errorCallback(int, const char *description) { lastError() = description; }
+
+    // Plataforma padrão (janela escondida); sem display, plataforma nula com
+    // EGL e depois com OSMesa
+    bool createContext() {
+        struct Attempt { int platform, api; };
+        const Attempt attempts[] = {
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+            { GLFW_ANY_PLATFORM, GLFW_NATIVE_CONTEXT_API },
+            { GLFW_PLATFORM_NULL, GLFW_EGL_CONTEXT_API },
+            { GLFW_PLATFORM_NULL, GLFW_OSMESA_CONTEXT_API },
+#else
+            { 0, GLFW_NATIVE_CONTEXT_API },
+#endif
+        };
+        for (const Attempt &a : attempts) {
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+            glfwInitHint(GLFW_PLATFORM, a.platform);
+#endif
+            if (!glfwInit()) continue;
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, a.api);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+            glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+            glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+            window = glfwCreateWindow(16, 16, "filtros", NULL, NULL);
+            if (window) return true;
+            glfwTerminate();
+        }
+        return false;
+    }
+
+    static GLuint compile(GLenum type, const std::string &source, std::string &error) {
+        GLuint shader = glCreateShader(type);
+        const char *text = source.c_str();
+        glShaderSource(shader, 1, &text, NULL);
+        glCompileShader(shader);
+        GLint ok = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+        if (!ok) {
+            char log[1024];
+            glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+            error = std::string("shader: ") + log;
+            glDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    }
+
+    // Um shader por pipeline: as operações viram trechos em sequência sobre
+    // uvec3 c; tabelas usam linhas da textura de tabelas (3 por operação)
+    bool prepareProgram(const FilterPipeline &pipeline, std::string &error) {
+        std::vector<FilterOp> fused = FilterPipeline::fuseLuts(pipeline.steps());
+        std::string steps;
+        std::vector<unsigned char> luts;
+        for (const FilterOp &op : fused) {
+            if (!op.glsl.empty()) {
+                steps += "    { " + op.glsl + " }\n";
+                continue;
+            }
+            int row = (int)(luts.size() / 256);
+            for (int ch = 0; ch < 3; ch++) luts.insert(luts.end(), op.lut->ch[ch].v, op.lut->ch[ch].v + 256);
+            steps += "    c = uvec3(lookup(c.r, " + std::to_string(row) + "), lookup(c.g, " + std::to_string(row + 1) +
+                     "), lookup(c.b, " + std::to_string(row + 2) + "));\n";
+        }
+        if (!luts.empty()) {
+            glBindTexture(GL_TEXTURE_2D, lutTex);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, 256, (GLsizei)(luts.size() / 256), 0, GL_RED_INTEGER,
+                         GL_UNSIGNED_BYTE, luts.data());
+            setNearest();
+        }
+
+        std::string fragment =
+            "#version 330 core\n"
+            "uniform usampler2D image;\n"
+            "uniform usampler2D luts;\n"
+            "out uvec4 color;\n"
+            "uint lookup(uint v, int row) { return texelFetch(luts, ivec2(int(v), row), 0).r; }\n"
+            "void main() {\n"
+            "    uvec3 c = texelFetch(image, ivec2(gl_FragCoord.xy), 0).rgb;\n" + steps +
+            "    color = uvec4(c, 255u);\n"
+            "}\n";
+        if (program && fragment == programSource) return true;
+
+        // triângulo que cobre a tela, sem vértices
+        const std::string vertex =
+            "#version 330 core\n"
+            "void main() {\n"
+            "    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+            "    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);\n"
+            "}\n";
+        GLuint vs = compile(GL_VERTEX_SHADER, vertex, error);
+        GLuint fs = vs ? compile(GL_FRAGMENT_SHADER, fragment, error) : 0;
+        if (!fs) {
+            if (vs) glDeleteShader(vs);
+            return false;
+        }
+        GLuint p = glCreateProgram();
+        glAttachShader(p, vs);
+        glAttachShader(p, fs);
+        glLinkProgram(p);
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+        GLint ok = 0;
+        glGetProgramiv(p, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            char log[1024];
+            glGetProgramInfoLog(p, sizeof(log), NULL, log);
+            error = std::string("link: ") + log;
+            glDeleteProgram(p);
+            return false;
+        }
+        if (program) glDeleteProgram(program);
+        program = p;
+        programSource = fragment;
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "image"), 0);
+        glUniform1i(glGetUniformLocation(program, "luts"), 1);
+        return true;
+    }
+
+    static void setNearest() {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+
+    // Texturas de origem e destino e os dois PBOs para blocos de até w x h
+    void allocateTiles(int w, int h) {
+        if (w <= tileW && h <= tileH) return;
+        tileW = w > tileW ? w : tileW;
+        tileH = h > tileH ? h : tileH;
+        glBindTexture(GL_TEXTURE_2D, srcTex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8UI, tileW, tileH, 0, GL_RGB_INTEGER, GL_UNSIGNED_BYTE, NULL);
+        setNearest();
+        glBindTexture(GL_TEXTURE_2D, dstTex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8UI, tileW, tileH, 0, GL_RGBA_INTEGER, GL_UNSIGNED_BYTE, NULL);
+        setNearest();
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dstTex, 0);
+        for (int i = 0; i < 2; i++) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo[i]);
+            glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)tileW * tileH * 3, NULL, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    // Bloco lido no PBO para dst (RGB com rowBytes por linha)
+    template <typename Tile>
+    static bool copyTile(unsigned char *dst, size_t dstRowBytes, const Tile &t, GLuint buffer) {
+        size_t rowBytes = (size_t)t.w * 3;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+        const unsigned char *p = (const unsigned char *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                                                                         (GLsizeiptr)(rowBytes * t.h), GL_MAP_READ_BIT);
+        if (!p) return false;
+        for (int y = 0; y < t.h; y++) memcpy(dst + dstRowBytes * (t.y + y) + (size_t)t.x * 3, p + rowBytes * y, rowBytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        return true;
+    }
+};
+
+// GPU quando houver contexto e o pipeline couber nos shaders; senão (ou se
+// a GPU falhar, sem ter mexido na imagem) os kernels da CPU. Devolve true
+// se rodou na GPU.
+inline bool runFilters(GLFilterBackend *gl, const FilterPipeline &pipeline, RowExecutor &executor,
+                       const ImageView &image) {
+    std::string error;
+    if (gl && gl->ready() && GLFilterBackend::supports(pipeline, image) && gl->run(pipeline, image, error)) return true;
+    if (!error.empty()) fprintf(stderr, "GPU: %s; usando a CPU\n", error.c_str());
+    pipeline.run(executor, image);
+    return false;
+}
+
+#endif /* GLFilters_h */
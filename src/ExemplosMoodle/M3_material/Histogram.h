@@ -0,0 +1,246 @@
+//
+//  Histogram.h
+//
+//  Histogramas por canal e os filtros que dependem deles (níveis
+//  automáticos e equalização). Cada tarefa conta num histograma próprio e
+//  no fim os parciais são somados: nenhum contador é compartilhado entre
+//  threads. O mapeamento resultante vira uma RgbLut e é aplicado pelo
+//  caminho de tabelas (Lut.h); são duas passadas, uma só de leitura.
+//
+
+#ifndef Histogram_h
+#define Histogram_h
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "Image.h"
+#include "Lut.h"
+#include "RowExecutor.h"
+
+struct Histogram {
+    uint64_t counts[3][256];
+    uint64_t pixels;
+
+    Histogram() { clear(); }
+    void clear() { memset(counts, 0, sizeof(counts)); pixels = 0; }
+
+    void add(const Histogram &other) {
+        for (int c = 0; c < 3; c++) {
+            for (int v = 0; v < 256; v++) counts[c][v] += other.counts[c][v];
+        }
+        pixels += other.pixels;
+    }
+};
+
+// Conta um trecho de pixels. Quatro cópias de cada tabela evitam que
+// valores repetidos seguidos esperem pelo incremento anterior do mesmo
+// contador.
+inline void histogramRange(const unsigned char *p, size_t pixels, Histogram &out) {
+    std::vector<uint32_t> sub(4 * 3 * 256, 0);
+    uint32_t *h0 = &sub[0], *h1 = &sub[768], *h2 = &sub[1536], *h3 = &sub[2304];
+    size_t i = 0;
+    // contadores de 32 bits: descarrega antes de estourar
+    const size_t flushEvery = (size_t)1 << 30;
+    while (i < pixels) {
+        size_t end = pixels - i > flushEvery ? i + flushEvery : pixels;
+        for (; i + 4 <= end; i += 4) {
+            const unsigned char *q = p + i * 3;
+            h0[q[0]]++; h0[256 + q[1]]++;  h0[512 + q[2]]++;
+            h1[q[3]]++; h1[256 + q[4]]++;  h1[512 + q[5]]++;
+            h2[q[6]]++; h2[256 + q[7]]++;  h2[512 + q[8]]++;
+            h3[q[9]]++; h3[256 + q[10]]++; h3[512 + q[11]]++;
+        }
+        for (; i < end; i++) {
+            const unsigned char *q = p + i * 3;
+            h0[q[0]]++; h0[256 + q[1]]++; h0[512 + q[2]]++;
+        }
+        for (int c = 0; c < 3; c++) {
+            for (int v = 0; v < 256; v++) {
+                int k = c * 256 + v;
+                out.counts[c][v] += (uint64_t)h0[k] + h1[k] + h2[k] + h3[k];
+                h0[k] = h1[k] = h2[k] = h3[k] = 0;
+            }
+        }
+    }
+    out.pixels += pixels;
+}
+
+// Blocos de linhas, alguns por thread; cada um com o seu histograma
+inline Histogram computeHistogram(RowExecutor &executor, const unsigned char *data, int w, int h) {
+    size_t chunks = (size_t)executor.threads() * 4;
+    if (chunks > (size_t)h) chunks = (size_t)h;
+    std::vector<Histogram> partial(chunks);
+    executor.threadPool().run(chunks, [&](size_t k) {
+        int y0 = (int)((size_t)h * k / chunks), y1 = (int)((size_t)h * (k + 1) / chunks);
+        histogramRange(data + (size_t)y0 * w * 3, (size_t)(y1 - y0) * w, partial[k]);
+    });
+    Histogram total;
+    for (size_t k = 0; k < chunks; k++) total.add(partial[k]);
+    return total;
+}
+
+// Um trecho de um plano só, contando em counts (256 entradas)
+inline void histogramPlaneRange(const unsigned char *p, size_t n, uint64_t *counts) {
+    uint32_t sub[4][256];
+    memset(sub, 0, sizeof(sub));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        sub[0][p[i]]++; sub[1][p[i+1]]++; sub[2][p[i+2]]++; sub[3][p[i+3]]++;
+    }
+    for (; i < n; i++) sub[0][p[i]]++;
+    for (int v = 0; v < 256; v++) counts[v] += (uint64_t)sub[0][v] + sub[1][v] + sub[2][v] + sub[3][v];
+}
+
+// Vista RGB em qualquer layout, com stride; linha a linha quando as linhas
+// não são coladas
+inline Histogram computeHistogram(RowExecutor &executor, const ImageView &image) {
+    if (!image.planar() && image.contiguous()) return computeHistogram(executor, image.data, image.width, image.height);
+    int h = image.height;
+    size_t chunks = (size_t)executor.threads() * 4;
+    if (chunks > (size_t)h) chunks = (size_t)h;
+    std::vector<Histogram> partial(chunks);
+    executor.threadPool().run(chunks, [&](size_t k) {
+        int y0 = (int)((size_t)h * k / chunks), y1 = (int)((size_t)h * (k + 1) / chunks);
+        for (int y = y0; y < y1; y++) {
+            if (image.planar()) {
+                for (int c = 0; c < 3; c++) histogramPlaneRange(image.row(y, c), image.width, partial[k].counts[c]);
+                partial[k].pixels += image.width;
+            } else {
+                histogramRange(image.row(y), image.width, partial[k]);
+            }
+        }
+    });
+    Histogram total;
+    for (size_t k = 0; k < chunks; k++) total.add(partial[k]);
+    return total;
+}
+
+// Níveis automáticos: em cada canal, o intervalo que sobra ao descartar a
+// fração clip dos pixels mais escuros e dos mais claros vira 0..255.
+inline RgbLut autoLevelsLut(const Histogram &hist, double clip) {
+    RgbLut out;
+    uint64_t limit = (uint64_t)(clip * (double)hist.pixels);
+    for (int c = 0; c < 3; c++) {
+        int lo = 0, hi = 255;
+        uint64_t sum = 0;
+        while (lo < 255 && (sum += hist.counts[c][lo]) <= limit) lo++;
+        sum = 0;
+        while (hi > 0 && (sum += hist.counts[c][hi]) <= limit) hi--;
+        out.ch[c] = hi > lo ? levelsLut(lo, hi) : IDENTITY_LUT;
+    }
+    return out;
+}
+
+// Equalização por canal: a CDF, sem o primeiro valor ocupado, vira 0..255
+inline RgbLut equalizeLut(const Histogram &hist) {
+    RgbLut out;
+    for (int c = 0; c < 3; c++) {
+        uint64_t cdf[256], sum = 0, first = 0;
+        for (int v = 0; v < 256; v++) {
+            sum += hist.counts[c][v];
+            cdf[v] = sum;
+            if (first == 0) first = sum;
+        }
+        if (hist.pixels == first) {
+            out.ch[c] = IDENTITY_LUT;
+            continue;
+        }
+        double scale = 255.0 / (double)(hist.pixels - first);
+        for (int v = 0; v < 256; v++) {
+            double x = cdf[v] > first ? (double)(cdf[v] - first) * scale : 0.0;
+            out.ch[c].v[v] = (unsigned char)(x + 0.5);
+        }
+    }
+    return out;
+}
+
+/*------------------------------- 16 BITS -----------------------------------*/
+
+// 65536 contadores por canal: uma tabela privada de 1,5 MB por tarefa, por
+// isso uma tarefa por thread em vez de quatro
+struct WideHistogram {
+    std::vector<uint64_t> counts; // canal c em c * 65536
+    uint64_t pixels;
+
+    WideHistogram() : counts(3 * 65536, 0), pixels(0) {}
+    uint64_t *ch(int c) { return &counts[(size_t)c * 65536]; }
+    const uint64_t *ch(int c) const { return &counts[(size_t)c * 65536]; }
+
+    void add(const WideHistogram &other) {
+        for (size_t i = 0; i < counts.size(); i++) counts[i] += other.counts[i];
+        pixels += other.pixels;
+    }
+};
+
+inline WideHistogram computeWideHistogram(RowExecutor &executor, const ImageView &image) {
+    int h = image.height, w = image.width;
+    size_t chunks = executor.threads();
+    if (chunks > (size_t)h) chunks = (size_t)h;
+    std::vector<WideHistogram> partial(chunks);
+    executor.threadPool().run(chunks, [&](size_t k) {
+        int y0 = (int)((size_t)h * k / chunks), y1 = (int)((size_t)h * (k + 1) / chunks);
+        uint64_t *r = partial[k].ch(0), *g = partial[k].ch(1), *b = partial[k].ch(2);
+        for (int y = y0; y < y1; y++) {
+            if (image.planar()) {
+                const uint16_t *pr = (const uint16_t *)image.row(y, 0), *pg = (const uint16_t *)image.row(y, 1),
+                               *pb = (const uint16_t *)image.row(y, 2);
+                for (int x = 0; x < w; x++) { r[pr[x]]++; g[pg[x]]++; b[pb[x]]++; }
+            } else {
+                const uint16_t *p = (const uint16_t *)image.row(y);
+                for (int x = 0; x < w; x++) { r[p[3*x]]++; g[p[3*x+1]]++; b[p[3*x+2]]++; }
+            }
+        }
+        partial[k].pixels += (uint64_t)(y1 - y0) * w;
+    });
+    WideHistogram total;
+    for (size_t k = 0; k < chunks; k++) total.add(partial[k]);
+    return total;
+}
+
+// Mesmos critérios de autoLevelsLut e equalizeLut, em 0..65535
+inline RgbLut16 autoLevelsLut16(const WideHistogram &hist, double clip) {
+    RgbLut16 out;
+    uint64_t limit = (uint64_t)(clip * (double)hist.pixels);
+    for (int c = 0; c < 3; c++) {
+        const uint64_t *counts = hist.ch(c);
+        int lo = 0, hi = 65535;
+        uint64_t sum = 0;
+        while (lo < 65535 && (sum += counts[lo]) <= limit) lo++;
+        sum = 0;
+        while (hi > 0 && (sum += counts[hi]) <= limit) hi--;
+        uint16_t *o = out.ch(c);
+        if (hi > lo) {
+            RgbLut16 levels = levelsLut16(lo, hi);
+            memcpy(o, levels.ch(0), 65536 * sizeof(uint16_t));
+        } else {
+            for (int v = 0; v < 65536; v++) o[v] = (uint16_t)v;
+        }
+    }
+    return out;
+}
+
+inline RgbLut16 equalizeLut16(const WideHistogram &hist) {
+    RgbLut16 out;
+    for (int c = 0; c < 3; c++) {
+        const uint64_t *counts = hist.ch(c);
+        uint16_t *o = out.ch(c);
+        uint64_t first = 0;
+        for (int v = 0; v < 65536 && first == 0; v++) first = counts[v];
+        if (hist.pixels == first) {
+            for (int v = 0; v < 65536; v++) o[v] = (uint16_t)v;
+            continue;
+        }
+        double scale = 65535.0 / (double)(hist.pixels - first);
+        uint64_t sum = 0;
+        for (int v = 0; v < 65536; v++) {
+            sum += counts[v];
+            double x = sum > first ? (double)(sum - first) * scale : 0.0;
+            o[v] = (uint16_t)(x + 0.5);
+        }
+    }
+    return out;
+}
+
+#endif /* Histogram_h */
@@ -0,0 +1,215 @@
+//
+//  Image.h
+//
+//  Contêiner de imagem de 8 ou 16 bits por amostra em dois layouts:
+//
+//  - intercalado: RGBRGB... numa linha só (o layout dos arquivos PPM);
+//  - planar: um plano por canal, RRR... GGG... BBB...
+//
+//  As linhas começam alinhadas em 64 bytes (stride = bytes entre linhas) e
+//  ImageView é uma vista sem dono: region() recorta um retângulo apontando
+//  para os mesmos pixels, então recortes e blocos não copiam nada. Um filtro
+//  que prefere outro layout recebe a imagem convertida uma vez só, na
+//  fronteira do pipeline (Pipeline.h).
+//
+
+#ifndef Image_h
+#define Image_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <functional>
+#include <vector>
+
+#include "Filters.h"
+#include "RowExecutor.h"
+
+enum ImageLayout {
+    LAYOUT_INTERLEAVED,
+    LAYOUT_PLANAR,
+    LAYOUT_ANY          // só como preferência de filtro: qualquer um serve
+};
+
+const size_t IMAGE_ROW_ALIGN = 64;
+
+inline size_t alignedRowBytes(size_t bytes) {
+    return (bytes + IMAGE_ROW_ALIGN - 1) & ~(IMAGE_ROW_ALIGN - 1);
+}
+
+struct ImageView {
+    unsigned char *data;
+    int width, height, channels;
+    int depth;          // bytes por amostra: 1, ou 2 (uint16_t em 0..65535)
+    ImageLayout layout;
+    size_t stride;      // bytes entre o início de duas linhas (de um plano)
+    size_t planeStride; // bytes entre planos (0 no intercalado)
+
+    ImageView() : data(NULL), width(0), height(0), channels(0), depth(1), layout(LAYOUT_INTERLEAVED), stride(0),
+                  planeStride(0) {}
+
+    // Vista sobre um buffer intercalado; stride 0 = linhas coladas
+    static ImageView interleaved(unsigned char *data, int w, int h, int channels = 3, size_t stride = 0, int depth = 1) {
+        ImageView v;
+        v.data = data;
+        v.width = w;
+        v.height = h;
+        v.channels = channels;
+        v.depth = depth;
+        v.stride = stride ? stride : (size_t)w * channels * depth;
+        return v;
+    }
+
+    bool empty() const { return data == NULL || width <= 0 || height <= 0; }
+    bool planar() const { return layout == LAYOUT_PLANAR; }
+    bool wide() const { return depth == 2; }
+    int planes() const { return planar() ? channels : 1; }
+
+    // Bytes úteis de uma linha de um plano
+    size_t rowBytes() const { return (size_t)width * (planar() ? 1 : channels) * depth; }
+    // Linhas coladas umas nas outras: dá para percorrer como um vetor só
+    bool contiguous() const { return stride == rowBytes(); }
+
+    unsigned char *row(int y, int plane = 0) const {
+        return data + (size_t)plane * planeStride + (size_t)y * stride;
+    }
+
+    // Plano c como imagem intercalada de um canal (a própria imagem, se já
+    // for intercalada). Os filtros por canal trabalham sobre essas vistas.
+    ImageView plane(int c) const {
+        if (!planar()) return *this;
+        return interleaved(data + (size_t)c * planeStride, width, height, 1, stride, depth);
+    }
+
+    // Retângulo [x, x + w) x [y, y + h), sem cópia
+    ImageView region(int x, int y, int w, int h) const {
+        ImageView v = *this;
+        v.data = data + (size_t)y * stride + (size_t)x * (planar() ? 1 : channels) * depth;
+        v.width = w;
+        v.height = h;
+        return v;
+    }
+};
+
+class Image {
+public:
+    Image() {}
+    Image(int w, int h, int channels, ImageLayout layout, int depth = 1) { allocate(w, h, channels, layout, depth); }
+
+    // Reaproveita o buffer quando o tamanho não aumenta
+    void allocate(int w, int h, int channels, ImageLayout layout, int depth = 1) {
+        v.width = w;
+        v.height = h;
+        v.channels = channels;
+        v.depth = depth;
+        v.layout = layout;
+        v.stride = alignedRowBytes(v.rowBytes());
+        v.planeStride = layout == LAYOUT_PLANAR ? v.stride * h : 0;
+        size_t bytes = layout == LAYOUT_PLANAR ? v.planeStride * channels : v.stride * h;
+        if (buffer.size() < bytes + IMAGE_ROW_ALIGN) buffer.resize(bytes + IMAGE_ROW_ALIGN);
+        size_t misalign = (size_t)buffer.data() % IMAGE_ROW_ALIGN;
+        v.data = buffer.data() + (misalign ? IMAGE_ROW_ALIGN - misalign : 0);
+    }
+
+    const ImageView &view() const { return v; }
+    unsigned char *data() const { return v.data; }
+
+private:
+    std::vector<unsigned char> buffer;
+    ImageView v;
+};
+
+/*------------------------------ conversão ----------------------------------*/
+
+// Uma linha RGB intercalada em três planos
+inline void deinterleaveRowRGB(const unsigned char *p, unsigned char *r, unsigned char *g, unsigned char *b, int n) {
+    int x = 0;
+#if CPU_HAS_SSE2
+    if (activeSimdLevel() >= SIMD_SSE2) {
+        for (; x + 16 <= n; x += 16) {
+            __m128i vr, vg, vb;
+            loadDeinterleaveRGB_SSE2(p + 3 * x, vr, vg, vb);
+            _mm_storeu_si128((__m128i *)(r + x), vr);
+            _mm_storeu_si128((__m128i *)(g + x), vg);
+            _mm_storeu_si128((__m128i *)(b + x), vb);
+        }
+    }
+#endif
+    for (; x < n; x++) {
+        r[x] = p[3*x]; g[x] = p[3*x+1]; b[x] = p[3*x+2];
+    }
+}
+
+inline void interleaveRowRGB(const unsigned char *r, const unsigned char *g, const unsigned char *b, unsigned char *p, int n) {
+    int x = 0;
+#if CPU_HAS_SSE2
+    if (activeSimdLevel() >= SIMD_SSE2) {
+        for (; x + 16 <= n; x += 16) {
+            storeInterleaveRGB_SSE2(p + 3 * x, _mm_loadu_si128((const __m128i *)(r + x)),
+                                    _mm_loadu_si128((const __m128i *)(g + x)), _mm_loadu_si128((const __m128i *)(b + x)));
+        }
+    }
+#endif
+    for (; x < n; x++) {
+        p[3*x] = r[x]; p[3*x+1] = g[x]; p[3*x+2] = b[x];
+    }
+}
+
+// Canal c de uma linha, amostra a amostra (passo em amostras)
+template <typename T>
+inline void copyChannel(const unsigned char *src, size_t srcStep, unsigned char *dst, size_t dstStep, int n) {
+    const T *s = (const T *)src;
+    T *d = (T *)dst;
+    for (int x = 0; x < n; x++) d[x * dstStep] = s[x * srcStep];
+}
+
+// Linhas [y0, y1) de src em dst (mesmo tamanho, canais e profundidade,
+// layouts quaisquer)
+inline void copyImageRows(const ImageView &src, const ImageView &dst, int y0, int y1) {
+    int w = src.width, ch = src.channels, d = src.depth;
+    for (int y = y0; y < y1; y++) {
+        if (src.layout == dst.layout) {
+            for (int c = 0; c < src.planes(); c++) memcpy(dst.row(y, c), src.row(y, c), src.rowBytes());
+        } else if (ch == 3 && d == 1 && !src.planar()) {
+            deinterleaveRowRGB(src.row(y), dst.row(y, 0), dst.row(y, 1), dst.row(y, 2), w);
+        } else if (ch == 3 && d == 1) {
+            interleaveRowRGB(src.row(y, 0), src.row(y, 1), src.row(y, 2), dst.row(y), w);
+        } else {
+            for (int c = 0; c < ch; c++) {
+                const unsigned char *s = src.planar() ? src.row(y, c) : src.row(y) + c * d;
+                unsigned char *o = dst.planar() ? dst.row(y, c) : dst.row(y) + c * d;
+                size_t si = src.planar() ? 1 : ch, di = dst.planar() ? 1 : ch;
+                if (d == 2) {
+                    copyChannel<uint16_t>(s, si, o, di, w);
+                } else {
+                    copyChannel<unsigned char>(s, si, o, di, w);
+                }
+            }
+        }
+    }
+}
+
+// Copia ou converte a imagem inteira, em faixas paralelas
+inline void copyImage(RowExecutor &executor, const ImageView &src, const ImageView &dst) {
+    executor.forEachBand(src.height, (size_t)src.width * src.channels * src.depth * 2, [&](int y0, int y1) {
+        copyImageRows(src, dst, y0, y1);
+    });
+}
+
+// fn(plano, início, bytes) sobre cada trecho contínuo de cada plano, em
+// faixas paralelas: a faixa inteira de uma vez se as linhas são coladas,
+// senão linha a linha. O plano é sempre 0 no intercalado.
+inline void forEachSpan(RowExecutor &executor, const ImageView &image,
+                        const std::function<void(int, unsigned char *, size_t)> &fn) {
+    executor.forEachBand(image.height, (size_t)image.width * image.channels * image.depth, [&](int y0, int y1) {
+        for (int c = 0; c < image.planes(); c++) {
+            if (image.contiguous()) {
+                fn(c, image.row(y0, c), (size_t)(y1 - y0) * image.rowBytes());
+            } else {
+                for (int y = y0; y < y1; y++) fn(c, image.row(y, c), image.rowBytes());
+            }
+        }
+    });
+}
+
+#endif /* Image_h */
@@ -0,0 +1,356 @@
+//
+//  Lut.h
+//
+//  Operações ponto a ponto por canal como tabelas de 256 entradas. Tabelas
+//  fixas são geradas em tempo de compilação (constexpr); as que dependem de
+//  parâmetros (gama, níveis, cor do colorize) são geradas em tempo de
+//  execução. Várias tabelas em sequência se compõem numa só, então uma
+//  cadeia de operações custa uma consulta por byte.
+//
+//  Aplicação: escalar, AVX2 com gather (tabela de 768 inteiros, um bloco
+//  por canal, sem separar os canais; o padrão) ou AVX2 com pshufb (tabela
+//  partida em 16 blocos de 16 bytes), escolhido em applyRgbLut.
+//
+//  Amostras de 16 bits usam tabelas de 65536 entradas por canal (RgbLut16),
+//  montadas pelas mesmas fórmulas na escala 0..65535.
+//
+
+#ifndef Lut_h
+#define Lut_h
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "Filters.h"
+
+struct Lut256 {
+    unsigned char v[256];
+};
+
+// f: int 0..255 -> valor (saturado em 0..255)
+template <typename F>
+constexpr Lut256 makeLut(F f) {
+    Lut256 t{};
+    for (int i = 0; i < 256; i++) {
+        int x = f(i);
+        t.v[i] = (unsigned char)(x < 0 ? 0 : x > 255 ? 255 : x);
+    }
+    return t;
+}
+
+constexpr Lut256 IDENTITY_LUT = makeLut([](int v) { return v; });
+constexpr Lut256 NEGATIVE_LUT = makeLut([](int v) { return v ^ 255; });
+
+constexpr Lut256 orLut(int mask) {
+    return makeLut([mask](int v) { return v | (mask & 255); });
+}
+
+// Gama sobre valores normalizados: out = 255 * (in/255)^(1/gamma)
+inline Lut256 gammaLut(double gamma) {
+    double inv = gamma > 0.0 ? 1.0 / gamma : 1.0;
+    return makeLut([inv](int v) { return (int)floor(255.0 * pow(v / 255.0, inv) + 0.5); });
+}
+
+// Níveis: [lo, hi] esticado para [0, 255], com gama opcional no meio
+inline Lut256 levelsLut(int lo, int hi, double gamma = 1.0) {
+    if (hi <= lo) hi = lo + 1;
+    double inv = gamma > 0.0 ? 1.0 / gamma : 1.0;
+    return makeLut([=](int v) {
+        double x = (v - lo) / (double)(hi - lo);
+        x = x < 0.0 ? 0.0 : x > 1.0 ? 1.0 : x;
+        return (int)floor(255.0 * pow(x, inv) + 0.5);
+    });
+}
+
+// Uma tabela por canal de RGB intercalado
+struct RgbLut {
+    Lut256 ch[3];
+
+    bool uniform() const {
+        for (int i = 0; i < 256; i++) {
+            if (ch[0].v[i] != ch[1].v[i] || ch[0].v[i] != ch[2].v[i]) return false;
+        }
+        return true;
+    }
+};
+
+constexpr RgbLut rgbLut(const Lut256 &all) { return RgbLut{ { all, all, all } }; }
+constexpr RgbLut rgbLut(const Lut256 &r, const Lut256 &g, const Lut256 &b) { return RgbLut{ { r, g, b } }; }
+
+// Primeiro first, depois then: uma tabela só
+inline RgbLut composeLut(const RgbLut &first, const RgbLut &then) {
+    RgbLut out;
+    for (int c = 0; c < 3; c++) {
+        for (int i = 0; i < 256; i++) out.ch[c].v[i] = then.ch[c].v[first.ch[c].v[i]];
+    }
+    return out;
+}
+
+/*-------------------------------- ESCALAR ----------------------------------*/
+
+inline void lutScalar(unsigned char *data, size_t bytes, const Lut256 &t) {
+    size_t i = 0;
+    for (; i + 4 <= bytes; i += 4) {
+        unsigned char a = t.v[data[i]], b = t.v[data[i+1]], c = t.v[data[i+2]], d = t.v[data[i+3]];
+        data[i] = a; data[i+1] = b; data[i+2] = c; data[i+3] = d;
+    }
+    for (; i < bytes; i++) data[i] = t.v[data[i]];
+}
+
+inline void rgbLutScalar(unsigned char *data, size_t pixels, const RgbLut &t) {
+    for (size_t i = 0; i < pixels * 3; i += 3) {
+        data[i]   = t.ch[0].v[data[i]];
+        data[i+1] = t.ch[1].v[data[i+1]];
+        data[i+2] = t.ch[2].v[data[i+2]];
+    }
+}
+
+/*--------------------------------- AVX2 ------------------------------------*/
+#if CPU_HAS_AVX2_TARGET
+
+// Os 16 blocos de 16 entradas da tabela, repetidos nas duas faixas
+struct LutBlocks_AVX2 {
+    __m256i block[16];
+};
+
+static inline TARGET_AVX2 void loadLutBlocks_AVX2(const Lut256 &t, LutBlocks_AVX2 &b) {
+    for (int k = 0; k < 16; k++) {
+        b.block[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(t.v + 16 * k)));
+    }
+}
+
+// 32 consultas: pshufb em cada bloco pelo nibble baixo e seleção do bloco
+// certo pelo nibble alto.
+static inline TARGET_AVX2 __m256i lutShuffle32_AVX2(__m256i v, const LutBlocks_AVX2 &b) {
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_and_si256(v, low);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low);
+    __m256i r = _mm256_setzero_si256();
+    for (int k = 0; k < 16; k++) {
+        __m256i hit = _mm256_cmpeq_epi8(hi, _mm256_set1_epi8((char)k));
+        r = _mm256_or_si256(r, _mm256_and_si256(_mm256_shuffle_epi8(b.block[k], lo), hit));
+    }
+    return r;
+}
+
+inline TARGET_AVX2 void lutShuffleAVX2(unsigned char *data, size_t bytes, const Lut256 &t) {
+    LutBlocks_AVX2 b;
+    loadLutBlocks_AVX2(t, b);
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + i));
+        _mm256_storeu_si256((__m256i *)(data + i), lutShuffle32_AVX2(v, b));
+    }
+    lutScalar(data + i, bytes - i, t);
+}
+
+inline TARGET_AVX2 void rgbLutShuffleAVX2(unsigned char *data, size_t pixels, const RgbLut &t) {
+    LutBlocks_AVX2 br, bg, bb;
+    loadLutBlocks_AVX2(t.ch[0], br);
+    loadLutBlocks_AVX2(t.ch[1], bg);
+    loadLutBlocks_AVX2(t.ch[2], bb);
+    size_t i = 0;
+    for (; i + 32 <= pixels; i += 32) {
+        unsigned char *p = data + i * 3;
+        __m256i r, g, b;
+        loadDeinterleaveRGB_AVX2(p, r, g, b);
+        storeInterleaveRGB_AVX2(p, lutShuffle32_AVX2(r, br), lutShuffle32_AVX2(g, bg), lutShuffle32_AVX2(b, bb));
+    }
+    rgbLutScalar(data + i * 3, pixels - i, t);
+}
+
+// Tabela RGB em inteiros de 32 bits: índice = canal*256 + valor
+struct RgbLut32 {
+    int v[3 * 256];
+    explicit RgbLut32(const RgbLut &t) {
+        for (int c = 0; c < 3; c++) {
+            for (int i = 0; i < 256; i++) v[c * 256 + i] = t.ch[c].v[i];
+        }
+    }
+};
+
+// 8 bytes por gather; em blocos de 24 bytes (8 pixels) o canal de cada
+// posição se repete, então o deslocamento canal*256 é constante por vetor.
+inline TARGET_AVX2 void rgbLutGatherAVX2(unsigned char *data, size_t pixels, const RgbLut &t) {
+    RgbLut32 wide(t);
+    const __m256i offset0 = _mm256_setr_epi32(0, 256, 512, 0, 256, 512, 0, 256);
+    const __m256i offset1 = _mm256_setr_epi32(512, 0, 256, 512, 0, 256, 512, 0);
+    const __m256i offset2 = _mm256_setr_epi32(256, 512, 0, 256, 512, 0, 256, 512);
+    const __m256i narrow = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                            0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i lanes = _mm256_setr_epi32(0, 4, 1, 1, 1, 1, 1, 1);
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        unsigned char *p = data + i * 3;
+        const __m256i offsets[3] = { offset0, offset1, offset2 };
+        for (int k = 0; k < 3; k++) {
+            __m256i idx = _mm256_add_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(p + 8 * k))), offsets[k]);
+            __m256i got = _mm256_i32gather_epi32(wide.v, idx, 4);
+            // 8 inteiros -> 8 bytes
+            __m256i packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(got, narrow), lanes);
+            _mm_storel_epi64((__m128i *)(p + 8 * k), _mm256_castsi256_si128(packed));
+        }
+    }
+    rgbLutScalar(data + i * 3, pixels - i, t);
+}
+
+#endif /* CPU_HAS_AVX2_TARGET */
+
+/*------------------------------- DESPACHO ----------------------------------*/
+
+// Kernel da consulta em AVX2. LUT_PSHUFB usa os 16 blocos de 16 bytes
+// direto nos bytes quando a tabela é igual nos três canais, e separando os
+// canais quando não é.
+enum LutKernel {
+    LUT_GATHER,
+    LUT_PSHUFB
+};
+
+// SSE2 não tem pshufb nem gather: abaixo de AVX2 a consulta é escalar. No
+// AVX2 o padrão é o gather: o pshufb precisa de 16 shuffles, 16 comparações
+// e 32 and/or por 32 bytes e, no image_bench (itens lut:gather e
+// lut:pshufb), ficou abaixo do gather e até do escalar.
+inline void applyRgbLut(unsigned char *data, size_t pixels, const RgbLut &t, LutKernel kernel = LUT_GATHER) {
+#if CPU_HAS_AVX2_TARGET
+    if (activeSimdLevel() >= SIMD_AVX2) {
+        if (kernel == LUT_GATHER) {
+            rgbLutGatherAVX2(data, pixels, t);
+        } else if (t.uniform()) {
+            lutShuffleAVX2(data, pixels * 3, t.ch[0]);
+        } else {
+            rgbLutShuffleAVX2(data, pixels, t);
+        }
+        return;
+    }
+#else
+    (void)kernel;
+#endif
+    if (t.uniform()) {
+        lutScalar(data, pixels * 3, t.ch[0]);
+    } else {
+        rgbLutScalar(data, pixels, t);
+    }
+}
+
+/*------------------------------- 16 BITS -----------------------------------*/
+
+// Entradas por canal: 65536 e uma de folga, porque o gather lê 4 bytes
+const size_t LUT16_STRIDE = 65537;
+
+// Três tabelas de 16 bits lado a lado: canal c começa em c * LUT16_STRIDE
+struct RgbLut16 {
+    std::vector<uint16_t> v;
+
+    RgbLut16() : v(3 * LUT16_STRIDE, 0) {}
+    uint16_t *ch(int c) { return &v[c * LUT16_STRIDE]; }
+    const uint16_t *ch(int c) const { return &v[c * LUT16_STRIDE]; }
+};
+
+// f(canal, valor 0..65535) -> valor (saturado em 0..65535)
+template <typename F>
+inline RgbLut16 makeLut16(F f) {
+    RgbLut16 t;
+    for (int c = 0; c < 3; c++) {
+        uint16_t *out = t.ch(c);
+        for (int i = 0; i < 65536; i++) {
+            long x = (long)f(c, i);
+            out[i] = (uint16_t)(x < 0 ? 0 : x > 65535 ? 65535 : x);
+        }
+    }
+    return t;
+}
+
+inline RgbLut16 negativeLut16() {
+    return makeLut16([](int, int v) { return 65535 - v; });
+}
+
+// Cores em 0..255, esticadas como em applyColorize16
+inline RgbLut16 orLut16(int r, int g, int b) {
+    int mask[3] = { widenColor(r), widenColor(g), widenColor(b) };
+    return makeLut16([&](int c, int v) { return v | mask[c]; });
+}
+
+inline RgbLut16 gammaLut16(double gamma) {
+    double inv = gamma > 0.0 ? 1.0 / gamma : 1.0;
+    std::vector<uint16_t> one(65536);
+    for (int v = 0; v < 65536; v++) one[v] = (uint16_t)floor(65535.0 * pow(v / 65535.0, inv) + 0.5);
+    return makeLut16([&](int, int v) { return one[v]; });
+}
+
+// lo e hi em 0..65535 (os níveis da linha de comando, em 0..255, x 257)
+inline RgbLut16 levelsLut16(int lo, int hi, double gamma = 1.0) {
+    if (hi <= lo) hi = lo + 1;
+    double inv = gamma > 0.0 ? 1.0 / gamma : 1.0;
+    std::vector<uint16_t> one(65536);
+    for (int v = 0; v < 65536; v++) {
+        double x = (v - lo) / (double)(hi - lo);
+        x = x < 0.0 ? 0.0 : x > 1.0 ? 1.0 : x;
+        one[v] = (uint16_t)floor(65535.0 * pow(x, inv) + 0.5);
+    }
+    return makeLut16([&](int, int v) { return one[v]; });
+}
+
+inline RgbLut16 composeLut16(const RgbLut16 &first, const RgbLut16 &then) {
+    RgbLut16 out;
+    for (int c = 0; c < 3; c++) {
+        const uint16_t *a = first.ch(c), *b = then.ch(c);
+        uint16_t *o = out.ch(c);
+        for (int i = 0; i < 65536; i++) o[i] = b[a[i]];
+    }
+    return out;
+}
+
+inline void rgbLut16Scalar(uint16_t *data, size_t pixels, const RgbLut16 &t) {
+    const uint16_t *r = t.ch(0), *g = t.ch(1), *b = t.ch(2);
+    for (size_t i = 0; i < pixels * 3; i += 3) {
+        data[i]   = r[data[i]];
+        data[i+1] = g[data[i+1]];
+        data[i+2] = b[data[i+2]];
+    }
+}
+
+// Um plano só, com a tabela de um canal
+inline void lut16Scalar(uint16_t *data, size_t samples, const uint16_t *t) {
+    for (size_t i = 0; i < samples; i++) data[i] = t[data[i]];
+}
+
+#if CPU_HAS_AVX2_TARGET
+// Como rgbLutGatherAVX2: 8 amostras por gather, deslocamento do canal
+// constante em cada um dos 3 vetores de um bloco de 8 pixels. Cada gather
+// lê 4 bytes a partir da entrada e fica com os 2 de baixo.
+inline TARGET_AVX2 void rgbLut16GatherAVX2(uint16_t *data, size_t pixels, const RgbLut16 &t) {
+    const int s = (int)LUT16_STRIDE;
+    const __m256i offsets[3] = { _mm256_setr_epi32(0, s, 2 * s, 0, s, 2 * s, 0, s),
+                                 _mm256_setr_epi32(2 * s, 0, s, 2 * s, 0, s, 2 * s, 0),
+                                 _mm256_setr_epi32(s, 2 * s, 0, s, 2 * s, 0, s, 2 * s) };
+    const __m256i narrow = _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1,
+                                            0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 4, 5, 4, 5, 4, 5);
+    const int *base = (const int *)t.v.data();
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        uint16_t *p = data + i * 3;
+        for (int k = 0; k < 3; k++) {
+            __m256i idx = _mm256_add_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(p + 8 * k))), offsets[k]);
+            __m256i got = _mm256_i32gather_epi32(base, idx, 2);
+            __m256i packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(got, narrow), lanes);
+            _mm_storeu_si128((__m128i *)(p + 8 * k), _mm256_castsi256_si128(packed));
+        }
+    }
+    rgbLut16Scalar(data + i * 3, pixels - i, t);
+}
+#endif /* CPU_HAS_AVX2_TARGET */
+
+inline void applyRgbLut16(uint16_t *data, size_t pixels, const RgbLut16 &t) {
+#if CPU_HAS_AVX2_TARGET
+    if (activeSimdLevel() >= SIMD_AVX2) {
+        rgbLut16GatherAVX2(data, pixels, t);
+        return;
+    }
+#endif
+    rgbLut16Scalar(data, pixels, t);
+}
+
+#endif /* Lut_h */
@@ -0,0 +1,197 @@
+//
+//  Matte.h
+//
+//  Chroma-key suave: em vez de pintar de preto quem está perto da cor-chave
+//  (chromaKey, Filters.h), calcula um alfa. A distância é medida só no
+//  plano de crominância (Cb, Cr do YCbCr BT.601), então sombras e reflexos
+//  do fundo, que mudam a luminância, continuam sendo fundo. Até a distância
+//  inner o pixel é fundo (alfa 0), a partir de outer é figura (alfa 255) e
+//  entre as duas o alfa sobe em rampa, o que preserva bordas suaves.
+//
+//  Com despill a cor da borda é "descontaminada": supondo que o pixel é a
+//  mistura alfa * figura + (1 - alfa) * chave, devolve a figura.
+//
+//  Trabalha sobre RGBA de 8 bits no lugar (o alfa que já existir é
+//  multiplicado pelo da chave). Pixels com alfa 0 ficam (0,0,0,0), como no
+//  bakeColorKey (ColorKey.h), para não vazarem cor na filtragem. Escalar,
+//  SSE2 (4 pixels) e AVX2 (8 pixels) fazem as mesmas contas em float na
+//  mesma ordem e dão o mesmo resultado.
+//
+
+#ifndef Matte_h
+#define Matte_h
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "CpuFeatures.h"
+#include "RowExecutor.h"
+
+struct MatteOptions {
+    int r, g, b;          // cor-chave
+    double inner, outer;  // limites da rampa, fração de 255 no plano CbCr
+    bool despill;
+
+    MatteOptions() : r(0), g(255), b(0), inner(0.15), outer(0.3), despill(true) {}
+};
+
+// Parâmetros já em unidades de croma
+struct MatteParams {
+    float cb[3], cr[3];   // pesos de Cb e Cr (sem o deslocamento de 128)
+    float keyCb, keyCr;
+    float inner, scale;   // alfa = (d - inner) * scale
+    float key[3];
+    bool despill;
+};
+
+inline MatteParams matteParams(const MatteOptions &o) {
+    MatteParams p;
+    const float cb[3] = { -0.168736f, -0.331264f, 0.5f }, cr[3] = { 0.5f, -0.418688f, -0.081312f };
+    for (int c = 0; c < 3; c++) { p.cb[c] = cb[c]; p.cr[c] = cr[c]; }
+    p.key[0] = (float)o.r; p.key[1] = (float)o.g; p.key[2] = (float)o.b;
+    p.keyCb = p.key[0] * cb[0] + p.key[1] * cb[1] + p.key[2] * cb[2];
+    p.keyCr = p.key[0] * cr[0] + p.key[1] * cr[1] + p.key[2] * cr[2];
+    double inner = o.inner * 255.0, outer = o.outer * 255.0;
+    p.inner = (float)inner;
+    p.scale = (float)(255.0 / (outer - inner > 0.5 ? outer - inner : 0.5));
+    p.despill = o.despill;
+    return p;
+}
+
+inline float clamp255f(float v) { return v < 0.0f ? 0.0f : v > 255.0f ? 255.0f : v; }
+
+inline void softMatteScalar(unsigned char *rgba, size_t pixels, const MatteParams &m) {
+    for (size_t i = 0; i < pixels; i++) {
+        unsigned char *q = rgba + 4 * i;
+        float c[3] = { (float)q[0], (float)q[1], (float)q[2] };
+        float dcb = (c[0] * m.cb[0] + c[1] * m.cb[1]) + c[2] * m.cb[2] - m.keyCb;
+        float dcr = (c[0] * m.cr[0] + c[1] * m.cr[1]) + c[2] * m.cr[2] - m.keyCr;
+        float d = sqrtf(dcb * dcb + dcr * dcr);
+        float key = (float)(int)(clamp255f((d - m.inner) * m.scale) + 0.5f);
+        int a = (int)(((float)q[3] * key) / 255.0f + 0.5f);
+        if (a == 0) {
+            q[0] = q[1] = q[2] = q[3] = 0;
+            continue;
+        }
+        if (m.despill) {
+            for (int k = 0; k < 3; k++) {
+                q[k] = (unsigned char)(int)(clamp255f((c[k] * 255.0f - (255.0f - key) * m.key[k]) / key) + 0.5f);
+            }
+        }
+        q[3] = (unsigned char)a;
+    }
+}
+
+#if CPU_HAS_SSE2
+inline void softMatteSSE2(unsigned char *rgba, size_t pixels, const MatteParams &m) {
+    const __m128i byteMask = _mm_set1_epi32(0xff);
+    const __m128 zero = _mm_setzero_ps(), half = _mm_set1_ps(0.5f), v255 = _mm_set1_ps(255.0f);
+    size_t i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(rgba + 4 * i));
+        __m128 c[3], a = _mm_cvtepi32_ps(_mm_srli_epi32(v, 24));
+        for (int k = 0; k < 3; k++) c[k] = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(v, 8 * k), byteMask));
+        __m128 dcb = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(c[0], _mm_set1_ps(m.cb[0])), _mm_mul_ps(c[1], _mm_set1_ps(m.cb[1]))),
+                                           _mm_mul_ps(c[2], _mm_set1_ps(m.cb[2]))), _mm_set1_ps(m.keyCb));
+        __m128 dcr = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(c[0], _mm_set1_ps(m.cr[0])), _mm_mul_ps(c[1], _mm_set1_ps(m.cr[1]))),
+                                           _mm_mul_ps(c[2], _mm_set1_ps(m.cr[2]))), _mm_set1_ps(m.keyCr));
+        __m128 d = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dcb, dcb), _mm_mul_ps(dcr, dcr)));
+        __m128 ramp = _mm_mul_ps(_mm_sub_ps(d, _mm_set1_ps(m.inner)), _mm_set1_ps(m.scale));
+        __m128 key = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_add_ps(_mm_max_ps(_mm_min_ps(ramp, v255), zero), half)));
+        __m128i alpha = _mm_cvttps_epi32(_mm_add_ps(_mm_div_ps(_mm_mul_ps(a, key), v255), half));
+        __m128i out = _mm_slli_epi32(alpha, 24);
+        for (int k = 0; k < 3; k++) {
+            __m128i ck = _mm_and_si128(_mm_srli_epi32(v, 8 * k), byteMask);
+            if (m.despill) {
+                __m128 s = _mm_div_ps(_mm_sub_ps(_mm_mul_ps(c[k], v255), _mm_mul_ps(_mm_sub_ps(v255, key), _mm_set1_ps(m.key[k]))), key);
+                // min antes de max: NaN (chave 0) vira 255 e é zerado abaixo
+                ck = _mm_cvttps_epi32(_mm_add_ps(_mm_max_ps(_mm_min_ps(s, v255), zero), half));
+            }
+            out = _mm_or_si128(out, _mm_slli_epi32(ck, 8 * k));
+        }
+        out = _mm_andnot_si128(_mm_cmpeq_epi32(alpha, _mm_setzero_si128()), out);
+        _mm_storeu_si128((__m128i *)(rgba + 4 * i), out);
+    }
+    if (i < pixels) {
+        unsigned char tail[16] = { 0 };
+        memcpy(tail, rgba + 4 * i, (pixels - i) * 4);
+        softMatteSSE2(tail, 4, m);
+        memcpy(rgba + 4 * i, tail, (pixels - i) * 4);
+    }
+}
+#endif /* CPU_HAS_SSE2 */
+
+#if CPU_HAS_AVX2_TARGET
+inline TARGET_AVX2 void softMatteAVX2(unsigned char *rgba, size_t pixels, const MatteParams &m) {
+    const __m256i byteMask = _mm256_set1_epi32(0xff);
+    const __m256 zero = _mm256_setzero_ps(), half = _mm256_set1_ps(0.5f), v255 = _mm256_set1_ps(255.0f);
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(rgba + 4 * i));
+        __m256 c[3], a = _mm256_cvtepi32_ps(_mm256_srli_epi32(v, 24));
+        for (int k = 0; k < 3; k++) c[k] = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(v, 8 * k), byteMask));
+        // mul e add separados (sem FMA) para arredondar como o escalar
+        __m256 dcb = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(c[0], _mm256_set1_ps(m.cb[0])),
+                                                               _mm256_mul_ps(c[1], _mm256_set1_ps(m.cb[1]))),
+                                                 _mm256_mul_ps(c[2], _mm256_set1_ps(m.cb[2]))), _mm256_set1_ps(m.keyCb));
+        __m256 dcr = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(c[0], _mm256_set1_ps(m.cr[0])),
+                                                               _mm256_mul_ps(c[1], _mm256_set1_ps(m.cr[1]))),
+                                                 _mm256_mul_ps(c[2], _mm256_set1_ps(m.cr[2]))), _mm256_set1_ps(m.keyCr));
+        __m256 d = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dcb, dcb), _mm256_mul_ps(dcr, dcr)));
+        __m256 ramp = _mm256_mul_ps(_mm256_sub_ps(d, _mm256_set1_ps(m.inner)), _mm256_set1_ps(m.scale));
+        __m256 key = _mm256_cvtepi32_ps(_mm256_cvttps_epi32(_mm256_add_ps(_mm256_max_ps(_mm256_min_ps(ramp, v255), zero), half)));
+        __m256i alpha = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_div_ps(_mm256_mul_ps(a, key), v255), half));
+        __m256i out = _mm256_slli_epi32(alpha, 24);
+        for (int k = 0; k < 3; k++) {
+            __m256i ck = _mm256_and_si256(_mm256_srli_epi32(v, 8 * k), byteMask);
+            if (m.despill) {
+                __m256 s = _mm256_div_ps(_mm256_sub_ps(_mm256_mul_ps(c[k], v255),
+                                                       _mm256_mul_ps(_mm256_sub_ps(v255, key), _mm256_set1_ps(m.key[k]))), key);
+                ck = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_max_ps(_mm256_min_ps(s, v255), zero), half));
+            }
+            out = _mm256_or_si256(out, _mm256_slli_epi32(ck, 8 * k));
+        }
+        out = _mm256_andnot_si256(_mm256_cmpeq_epi32(alpha, _mm256_setzero_si256()), out);
+        _mm256_storeu_si256((__m256i *)(rgba + 4 * i), out);
+    }
+    // o resto passa pelo mesmo caminho num bloco temporário: o escalar
+    // embutido aqui poderia virar FMA e arredondar diferente
+    if (i < pixels) {
+        unsigned char tail[32] = { 0 };
+        memcpy(tail, rgba + 4 * i, (pixels - i) * 4);
+        softMatteAVX2(tail, 8, m);
+        memcpy(rgba + 4 * i, tail, (pixels - i) * 4);
+    }
+}
+#endif /* CPU_HAS_AVX2_TARGET */
+
+inline void applySoftMatte(unsigned char *rgba, size_t pixels, const MatteParams &m) {
+    switch (activeSimdLevel()) {
+#if CPU_HAS_AVX2_TARGET
+        case SIMD_AVX2: softMatteAVX2(rgba, pixels, m); return;
+#endif
+#if CPU_HAS_SSE2
+        case SIMD_SSE2: softMatteSSE2(rgba, pixels, m); return;
+#endif
+        default: softMatteScalar(rgba, pixels, m);
+    }
+}
+
+// RGBA contíguo, em faixas paralelas
+inline void softMatte(RowExecutor &executor, unsigned char *rgba, int w, int h, const MatteOptions &options) {
+    MatteParams m = matteParams(options);
+    executor.forEachBand(h, (size_t)w * 4, [&](int y0, int y1) {
+        applySoftMatte(rgba + (size_t)y0 * w * 4, (size_t)(y1 - y0) * w, m);
+    });
+}
+
+// RGB -> RGBA opaco
+inline void rgbToRgba(const unsigned char *rgb, size_t pixels, unsigned char *rgba) {
+    for (size_t i = 0; i < pixels; i++) {
+        rgba[4*i] = rgb[3*i]; rgba[4*i+1] = rgb[3*i+1]; rgba[4*i+2] = rgb[3*i+2]; rgba[4*i+3] = 255;
+    }
+}
+
+#endif /* Matte_h */
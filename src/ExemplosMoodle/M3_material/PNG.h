@@ -0,0 +1,108 @@
+//
+//  PNG.h
+//
+//  Gravação de PNG de 8 bits (cinza, cinza + alfa, RGB ou RGBA) sem
+//  compressão: o zlib leva blocos "stored" do deflate. O arquivo fica do
+//  tamanho dos pixels, mas é lido por qualquer decodificador (stbi_load nos
+//  jogos) e não precisa de biblioteca nenhuma. Serve para sprites e
+//  texturas pequenas geradas pelas ferramentas; imagens grandes vão melhor
+//  em PPM/PAM.
+//
+
+#ifndef PNG_h
+#define PNG_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+inline const uint32_t *pngCrcTable() {
+    static const std::vector<uint32_t> table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    return table.data();
+}
+
+inline uint32_t pngCrc(const unsigned char *p, size_t n, uint32_t crc = 0) {
+    const uint32_t *table = pngCrcTable();
+    crc = ~crc;
+    for (size_t i = 0; i < n; i++) crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+inline void pngPut32(std::vector<unsigned char> &out, uint32_t v) {
+    unsigned char b[4] = { (unsigned char)(v >> 24), (unsigned char)(v >> 16), (unsigned char)(v >> 8), (unsigned char)v };
+    out.insert(out.end(), b, b + 4);
+}
+
+// Comprimento, tipo, dados e CRC de tipo + dados
+inline void pngChunk(std::vector<unsigned char> &out, const char *type, const unsigned char *data, size_t n) {
+    pngPut32(out, (uint32_t)n);
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    if (n) out.insert(out.end(), data, data + n);
+    pngPut32(out, pngCrc(&out[start], n + 4));
+}
+
+inline bool savePNG(const std::string &path, const unsigned char *data, int w, int h, int channels) {
+    static const unsigned char colorType[5] = { 0, 0, 4, 2, 6 };
+    if (channels < 1 || channels > 4 || w <= 0 || h <= 0) return false;
+
+    // linhas com o byte de filtro 0 na frente
+    size_t rowBytes = (size_t)w * channels;
+    std::vector<unsigned char> raw((rowBytes + 1) * h);
+    for (int y = 0; y < h; y++) {
+        raw[(rowBytes + 1) * y] = 0;
+        memcpy(&raw[(rowBytes + 1) * y + 1], data + rowBytes * y, rowBytes);
+    }
+
+    // zlib: cabeçalho, blocos stored de até 65535 bytes e Adler-32
+    std::vector<unsigned char> z;
+    z.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    z.push_back(0x78);
+    z.push_back(0x01);
+    size_t pos = 0;
+    do {
+        size_t n = raw.size() - pos < 65535 ? raw.size() - pos : 65535;
+        z.push_back(pos + n == raw.size() ? 1 : 0);
+        z.push_back((unsigned char)n);
+        z.push_back((unsigned char)(n >> 8));
+        z.push_back((unsigned char)~n);
+        z.push_back((unsigned char)(~n >> 8));
+        z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + n);
+        pos += n;
+    } while (pos < raw.size());
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < raw.size(); i++) {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    pngPut32(z, (b << 16) | a);
+
+    std::vector<unsigned char> out;
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    out.insert(out.end(), signature, signature + 8);
+    std::vector<unsigned char> ihdr;
+    pngPut32(ihdr, (uint32_t)w);
+    pngPut32(ihdr, (uint32_t)h);
+    unsigned char rest[5] = { 8, colorType[channels], 0, 0, 0 };
+    ihdr.insert(ihdr.end(), rest, rest + 5);
+    pngChunk(out, "IHDR", ihdr.data(), ihdr.size());
+    pngChunk(out, "IDAT", z.data(), z.size());
+    pngChunk(out, "IEND", NULL, 0);
+
+    FILE *f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(out.data(), 1, out.size(), f) == out.size();
+    return fclose(f) == 0 && ok;
+}
+
+#endif /* PNG_h */
@@ -0,0 +1,602 @@
+//
+//  PPM.h
+//
+//  Leitura e escrita de imagens PNM (P2/P3 texto, P5/P6 binário) e escrita
+//  de PAM (P7) com alfa.
+//  Os formatos binários são mapeados em memória (mmap) e o payload de
+//  pixels é usado no lugar, sem cópia; a escrita binária sai em um único
+//  write grande.
+//
+//  Com maxval acima de 255 cada amostra tem 2 bytes (big-endian no
+//  arquivo). Na memória ficam na ordem de bytes da máquina e esticadas para
+//  0..65535, qualquer que seja o maxval; ao gravar voltam para a escala do
+//  maxval original (a ida e a volta não perdem nada).
+//
+
+#ifndef PPM_h
+#define PPM_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "CpuFeatures.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Arquivo inteiro visível como um bloco de memória. No POSIX é um mmap
+// privado (copy-on-write): os filtros podem alterar os pixels no lugar sem
+// tocar o arquivo em disco. No Windows lê tudo com um único fread.
+class MappedFile {
+public:
+    MappedFile() : ptr(NULL), length(0), mapped(false) {}
+    ~MappedFile() { close(); }
+
+    bool open(const std::string &path) {
+        close();
+#ifdef _WIN32
+        FILE *f = fopen(path.c_str(), "rb");
+        if (!f) return false;
+        fseek(f, 0, SEEK_END);
+        long n = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        if (n < 0) { fclose(f); return false; }
+        buffer.resize((size_t)n);
+        size_t got = n > 0 ? fread(buffer.data(), 1, (size_t)n, f) : 0;
+        fclose(f);
+        if (got != (size_t)n) { buffer.clear(); return false; }
+        ptr = buffer.data();
+        length = (size_t)n;
+        return true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return false; }
+        void *p = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+        ptr = (unsigned char *)p;
+        length = (size_t)st.st_size;
+        mapped = true;
+        return true;
+#endif
+    }
+
+    void close() {
+#ifndef _WIN32
+        if (mapped && ptr) munmap(ptr, length);
+#endif
+        buffer.clear();
+        ptr = NULL;
+        length = 0;
+        mapped = false;
+    }
+
+    unsigned char *data() { return ptr; }
+    const unsigned char *data() const { return ptr; }
+    size_t size() const { return length; }
+
+private:
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+    unsigned char *ptr;
+    size_t length;
+    bool mapped;
+    std::vector<unsigned char> buffer;
+};
+
+struct PPMHeader {
+    char type;         // '2', '3', '5' ou '6'
+    int width, height;
+    int maxValue;
+    int channels;      // 1 (PGM) ou 3 (PPM)
+    size_t dataOffset; // início do payload de pixels no arquivo
+};
+
+// Lê o próximo inteiro do cabeçalho, pulando espaços e comentários (#...).
+inline bool ppmHeaderInt(const unsigned char *p, size_t n, size_t &pos, int &value) {
+    while (pos < n) {
+        if (p[pos] == '#') {
+            while (pos < n && p[pos] != '\n') pos++;
+        } else if (p[pos] == ' ' || p[pos] == '\t' || p[pos] == '\r' || p[pos] == '\n') {
+            pos++;
+        } else {
+            break;
+        }
+    }
+    if (pos >= n || p[pos] < '0' || p[pos] > '9') return false;
+    long v = 0;
+    while (pos < n && p[pos] >= '0' && p[pos] <= '9') {
+        v = v * 10 + (p[pos++] - '0');
+        if (v > 0x7fffffff) return false;
+    }
+    value = (int)v;
+    return true;
+}
+
+inline bool parsePPMHeader(const unsigned char *p, size_t n, PPMHeader &h) {
+    if (n < 2 || p[0] != 'P') return false;
+    h.type = (char)p[1];
+    if (h.type != '2' && h.type != '3' && h.type != '5' && h.type != '6') return false;
+    h.channels = (h.type == '2' || h.type == '5') ? 1 : 3;
+    size_t pos = 2;
+    if (!ppmHeaderInt(p, n, pos, h.width) || !ppmHeaderInt(p, n, pos, h.height) ||
+        !ppmHeaderInt(p, n, pos, h.maxValue)) {
+        return false;
+    }
+    if (h.width <= 0 || h.height <= 0 || h.maxValue <= 0 || h.maxValue > 65535) return false;
+    // exatamente um caractere de espaço separa o cabeçalho dos dados
+    if (pos >= n) return false;
+    h.dataOffset = pos + 1;
+    return true;
+}
+
+/*------------------------------ 16 bits ------------------------------------*/
+
+inline int pnmBytesPerSample(int maxValue) { return maxValue > 255 ? 2 : 1; }
+
+inline bool hostIsLittleEndian() {
+    const uint16_t one = 1;
+    unsigned char first;
+    memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+// Troca os dois bytes de cada amostra (big-endian <-> ordem da máquina)
+inline void swapBytes16(uint16_t *p, size_t n) {
+    size_t i = 0;
+#if CPU_HAS_SSE2
+    if (activeSimdLevel() >= SIMD_SSE2) {
+        for (; i + 8 <= n; i += 8) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+            _mm_storeu_si128((__m128i *)(p + i), _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+        }
+    }
+#endif
+    for (; i < n; i++) p[i] = (uint16_t)((p[i] << 8) | (p[i] >> 8));
+}
+
+// 0..maxValue -> 0..65535 (arredondado)
+inline void stretchSamples(uint16_t *p, size_t n, int maxValue) {
+    if (maxValue == 65535) return;
+    uint32_t m = (uint32_t)maxValue;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t v = p[i] < m ? p[i] : m;
+        p[i] = (uint16_t)((v * 65535u + m / 2) / m);
+    }
+}
+
+// Amostras lidas do arquivo binário -> memória
+inline void widenSamples(uint16_t *p, size_t n, int maxValue) {
+    if (hostIsLittleEndian()) swapBytes16(p, n);
+    stretchSamples(p, n, maxValue);
+}
+
+// 0..65535 -> 0..maxValue, inverso exato de stretchSamples
+inline uint16_t narrowSample(uint16_t v, int maxValue) {
+    if (maxValue == 65535) return v;
+    return (uint16_t)(((uint32_t)v * (uint32_t)maxValue + 32767u) / 65535u);
+}
+
+// Caminho rápido das amostras em texto (P2/P3): um laço só sobre o buffer
+// mapeado, sem iostream nem locale. Espaços são todos os bytes <= ' '.
+// Avança p até depois da última amostra lida e devolve quantas foram lidas
+// (menos que count = fim do buffer ou caractere inválido). T é unsigned
+// char ou uint16_t; valores acima do máximo de T são saturados.
+template <typename T>
+inline size_t parseP3SamplesAdvance(const unsigned char *&p, const unsigned char *end, T *out, size_t count) {
+    const unsigned maxSample = (T)~0u;
+    size_t i = 0;
+    while (i < count) {
+        while (p < end && *p <= ' ') p++;
+        if (p >= end) break;
+        unsigned d = (unsigned)*p - '0';
+        if (d > 9) {
+            if (*p != '#') break;
+            while (p < end && *p != '\n') p++;
+            continue;
+        }
+        unsigned v = d;
+        p++;
+        while (p < end && (d = (unsigned)*p - '0') <= 9) {
+            if (v < 100000) v = v * 10 + d;
+            p++;
+        }
+        out[i++] = (T)(v > maxSample ? maxSample : v);
+    }
+    return i;
+}
+
+inline size_t parseP3Samples(const unsigned char *p, size_t n, unsigned char *out, size_t count) {
+    return parseP3SamplesAdvance(p, p + n, out, count);
+}
+
+// Texto de cada amostra 0..255 seguido de '\n', empacotado em 4 bytes para
+// ser copiado de uma vez pelo escritor P3.
+struct P3SampleTable {
+    unsigned char text[256][4];
+    unsigned char len[256];
+
+    P3SampleTable() {
+        for (int v = 0; v < 256; v++) {
+            char buf[8];
+            int k = snprintf(buf, sizeof(buf), "%d\n", v);
+            memset(text[v], 0, 4);
+            memcpy(text[v], buf, (size_t)k);
+            len[v] = (unsigned char)k;
+        }
+    }
+};
+
+inline const P3SampleTable &p3SampleTable() {
+    static const P3SampleTable table;
+    return table;
+}
+
+// Imagem carregada de um PNM. Nos formatos binários data aponta direto
+// para dentro do arquivo mapeado; nos formatos texto, para um buffer próprio.
+// Com maxval > 255 data guarda uint16_t (0..65535, ver topo do arquivo).
+class PPMImage {
+public:
+    int width, height, maxValue, channels;
+    char type;
+    unsigned char *data;
+
+    PPMImage() : width(0), height(0), maxValue(255), channels(3), type('6'), data(NULL) {}
+
+    size_t length() const { return (size_t)width * height * channels; } // amostras
+    int bytesPerSample() const { return pnmBytesPerSample(maxValue); }
+    size_t byteLength() const { return length() * bytesPerSample(); }
+    bool isBinary() const { return type == '5' || type == '6'; }
+
+    bool load(const std::string &path) {
+        data = NULL;
+        owned.clear();
+        if (!file.open(path)) {
+            fprintf(stderr, "Erro ao abrir %s\n", path.c_str());
+            return false;
+        }
+        PPMHeader h;
+        if (!parsePPMHeader(file.data(), file.size(), h)) {
+            fprintf(stderr, "Cabeçalho PNM inválido em %s\n", path.c_str());
+            return false;
+        }
+        width = h.width;
+        height = h.height;
+        maxValue = h.maxValue;
+        channels = h.channels;
+        type = h.type;
+        bool wide = bytesPerSample() == 2;
+
+        if (isBinary()) {
+            if (file.size() < h.dataOffset + byteLength()) {
+                fprintf(stderr, "Arquivo truncado: %s\n", path.c_str());
+                return false;
+            }
+            data = file.data() + h.dataOffset; // zero-cópia
+            if (wide) {
+                // uint16_t precisa de endereço par
+                if ((size_t)data % 2 != 0) {
+                    owned.assign(data, data + byteLength());
+                    file.close();
+                    data = owned.data();
+                }
+                widenSamples((uint16_t *)data, length(), maxValue);
+            }
+            return true;
+        }
+
+        owned.resize(byteLength());
+        const unsigned char *p = file.data() + h.dataOffset, *end = file.data() + file.size();
+        size_t got = wide ? parseP3SamplesAdvance(p, end, (uint16_t *)owned.data(), length())
+                          : parseP3SamplesAdvance(p, end, owned.data(), length());
+        if (got != length()) {
+            fprintf(stderr, "Faltam amostras em %s (%zu de %zu)\n", path.c_str(), got, length());
+            return false;
+        }
+        file.close();
+        data = owned.data();
+        if (wide) stretchSamples((uint16_t *)data, length(), maxValue);
+        return true;
+    }
+
+    uint16_t *samples16() const { return (uint16_t *)data; }
+
+    // Converte PGM (1 canal) em RGB para os filtros coloridos
+    void toRGB() {
+        if (channels == 3) return;
+        size_t n = (size_t)width * height, bps = (size_t)bytesPerSample();
+        std::vector<unsigned char> rgb(n * 3 * bps);
+        for (size_t i = 0; i < n; i++) {
+            for (int c = 0; c < 3; c++) memcpy(&rgb[(3 * i + c) * bps], data + i * bps, bps);
+        }
+        owned.swap(rgb);
+        file.close();
+        data = owned.data();
+        channels = 3;
+        type = type == '2' ? '3' : '6';
+    }
+
+private:
+    MappedFile file;
+    std::vector<unsigned char> owned;
+};
+
+// Leitura sequencial de um PNM em blocos de linhas, sem carregar o arquivo
+// inteiro: para imagens maiores que a memória. Tons de cinza saem como RGB.
+class PPMStreamReader {
+public:
+    PPMHeader header;
+
+    PPMStreamReader() : f(NULL), pos(0), len(0), eof(false) {}
+    ~PPMStreamReader() { close(); }
+
+    bool open(const std::string &path) {
+        close();
+        f = fopen(path.c_str(), "rb");
+        if (!f) {
+            fprintf(stderr, "Erro ao abrir %s\n", path.c_str());
+            return false;
+        }
+        buf.resize(BUFFER_SIZE);
+        pos = len = 0;
+        eof = false;
+        refill();
+        if (!parsePPMHeader(buf.data(), len, header)) {
+            fprintf(stderr, "Cabeçalho PNM inválido em %s\n", path.c_str());
+            return false;
+        }
+        pos = header.dataOffset;
+        return true;
+    }
+
+    void close() {
+        if (f) fclose(f);
+        f = NULL;
+    }
+
+    bool isBinary() const { return header.type == '5' || header.type == '6'; }
+    int bytesPerSample() const { return pnmBytesPerSample(header.maxValue); }
+
+    // Próximas rows linhas, em RGB intercalado (uint16_t se maxval > 255;
+    // rgb precisa então de endereço par)
+    bool readRows(unsigned char *rgb, int rows) {
+        size_t samples = (size_t)rows * header.width * header.channels, bps = (size_t)bytesPerSample();
+        unsigned char *out = rgb;
+        if (header.channels == 1) {
+            gray.resize(samples * bps);
+            out = gray.data();
+        }
+        bool ok;
+        if (isBinary()) {
+            ok = readBinary(out, samples * bps);
+            if (ok && bps == 2) widenSamples((uint16_t *)out, samples, header.maxValue);
+        } else if (bps == 2) {
+            ok = readText((uint16_t *)out, samples);
+            if (ok) stretchSamples((uint16_t *)out, samples, header.maxValue);
+        } else {
+            ok = readText(out, samples);
+        }
+        if (ok && header.channels == 1) {
+            for (size_t i = 0; i < samples; i++) {
+                for (int c = 0; c < 3; c++) memcpy(rgb + (3 * i + c) * bps, gray.data() + i * bps, bps);
+            }
+        }
+        return ok;
+    }
+
+private:
+    static const size_t BUFFER_SIZE = 1 << 20;
+
+    PPMStreamReader(const PPMStreamReader &);
+    PPMStreamReader &operator=(const PPMStreamReader &);
+
+    // Move o que sobrou para o início do buffer e completa com o arquivo
+    void refill() {
+        if (pos > 0) {
+            memmove(buf.data(), buf.data() + pos, len - pos);
+            len -= pos;
+            pos = 0;
+        }
+        if (!eof && len < buf.size()) {
+            size_t got = fread(buf.data() + len, 1, buf.size() - len, f);
+            len += got;
+            if (got == 0) eof = true;
+        }
+    }
+
+    bool readBinary(unsigned char *out, size_t n) {
+        size_t have = len - pos < n ? len - pos : n;
+        memcpy(out, buf.data() + pos, have);
+        pos += have;
+        if (have < n) {
+            if (fread(out + have, 1, n - have, f) != n - have) {
+                fprintf(stderr, "Arquivo truncado\n");
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Só interpreta até a última quebra de linha do buffer (ou até o último
+    // espaço), para não cortar um número ou um comentário no meio.
+    template <typename T>
+    bool readText(T *out, size_t n) {
+        size_t done = 0;
+        while (done < n) {
+            size_t safe = len;
+            if (!eof) {
+                while (safe > pos && buf[safe - 1] != '\n') safe--;
+                if (safe == pos) {
+                    safe = len;
+                    while (safe > pos && buf[safe - 1] > ' ') safe--;
+                }
+            }
+            const unsigned char *p = buf.data() + pos;
+            done += parseP3SamplesAdvance(p, buf.data() + safe, out + done, n - done);
+            pos = p - buf.data();
+            if (done == n) break;
+            if (pos < safe || (eof && pos >= len) || (pos == 0 && len == buf.size())) {
+                fprintf(stderr, "Faltam amostras ou caractere inválido no PNM\n");
+                return false;
+            }
+            refill();
+        }
+        return true;
+    }
+
+    FILE *f;
+    std::vector<unsigned char> buf, gray;
+    size_t pos, len;
+    bool eof;
+};
+
+// Escrita sequencial em blocos de linhas. O binário de 8 bits vai direto do
+// buffer do chamador para o arquivo, sem buffer do stdio; o texto é montado
+// por tabela e despejado em blocos de 4 MB. Com maxval > 255 as linhas são
+// uint16_t em 0..65535 e passam por um bloco de conversão.
+class PPMStreamWriter {
+public:
+    PPMStreamWriter() : f(NULL), ok(false), binary(true), width(0), channels(3), maxValue(255) {}
+    ~PPMStreamWriter() { close(); }
+
+    bool open(const std::string &path, int w, int h, int channels, bool binary, const char *comment = NULL,
+              int maxValue = 255) {
+        close();
+        f = fopen(path.c_str(), "wb");
+        if (!f) return false;
+        setvbuf(f, NULL, _IONBF, 0);
+        this->binary = binary;
+        this->channels = channels;
+        this->maxValue = maxValue;
+        char type = binary ? (channels == 1 ? '5' : '6') : (channels == 1 ? '2' : '3');
+        char header[256];
+        int hl;
+        if (channels == 2 || channels == 4) {
+            // com alfa só existe o PAM, sempre binário
+            this->binary = true;
+            hl = snprintf(header, sizeof(header), "P7\n%s%s%sWIDTH %d\nHEIGHT %d\nDEPTH %d\nMAXVAL %d\nTUPLTYPE %s\nENDHDR\n",
+                          comment ? "#" : "", comment ? comment : "", comment ? "\n" : "", w, h, channels, maxValue,
+                          channels == 4 ? "RGB_ALPHA" : "GRAYSCALE_ALPHA");
+        } else {
+            hl = snprintf(header, sizeof(header), "P%c\n%s%s%s%d %d\n%d\n", type,
+                          comment ? "#" : "", comment ? comment : "", comment ? "\n" : "", w, h, maxValue);
+        }
+        width = w;
+        ok = fwrite(header, 1, (size_t)hl, f) == (size_t)hl;
+        return ok;
+    }
+
+    bool writeRows(const unsigned char *data, int rows) {
+        size_t length = (size_t)rows * width * channels;
+        if (!f || !ok) return false;
+        if (pnmBytesPerSample(maxValue) == 2) return writeWide((const uint16_t *)data, length);
+        if (binary) {
+            ok = fwrite(data, 1, length, f) == length;
+            return ok;
+        }
+        const size_t CHUNK = 4 << 20;
+        text.resize(CHUNK + 8);
+        const P3SampleTable &table = p3SampleTable();
+        unsigned char *out = text.data();
+        size_t pos = 0;
+        for (size_t i = 0; i < length && ok; i++) {
+            unsigned char v = data[i];
+            memcpy(out + pos, table.text[v], 4);
+            pos += table.len[v];
+            if (pos >= CHUNK) {
+                ok = fwrite(out, 1, pos, f) == pos;
+                pos = 0;
+            }
+        }
+        if (ok && pos > 0) ok = fwrite(out, 1, pos, f) == pos;
+        return ok;
+    }
+
+    // Devolve false se alguma escrita falhou
+    bool close() {
+        if (!f) return ok;
+        ok = fclose(f) == 0 && ok;
+        f = NULL;
+        return ok;
+    }
+
+private:
+    PPMStreamWriter(const PPMStreamWriter &);
+    PPMStreamWriter &operator=(const PPMStreamWriter &);
+
+    // 16 bits: volta à escala do maxval e, no binário, para big-endian
+    bool writeWide(const uint16_t *data, size_t length) {
+        const size_t CHUNK = 1 << 20; // amostras por bloco
+        text.resize(binary ? CHUNK * 2 : CHUNK * 6);
+        bool swap = hostIsLittleEndian();
+        for (size_t start = 0; start < length && ok; start += CHUNK) {
+            size_t n = length - start < CHUNK ? length - start : CHUNK, pos = 0;
+            if (binary) {
+                uint16_t *out = (uint16_t *)text.data();
+                for (size_t i = 0; i < n; i++) out[i] = narrowSample(data[start + i], maxValue);
+                if (swap) swapBytes16(out, n);
+                pos = n * 2;
+            } else {
+                for (size_t i = 0; i < n; i++) {
+                    char digits[8];
+                    unsigned v = narrowSample(data[start + i], maxValue), k = 0;
+                    do { digits[k++] = (char)('0' + v % 10); v /= 10; } while (v);
+                    while (k) text[pos++] = (unsigned char)digits[--k];
+                    text[pos++] = '\n';
+                }
+            }
+            ok = fwrite(text.data(), 1, pos, f) == pos;
+        }
+        return ok;
+    }
+
+    FILE *f;
+    bool ok, binary;
+    int width, channels, maxValue;
+    std::vector<unsigned char> text;
+};
+
+// Grava P5/P6: cabeçalho e payload binário em um único write sem buffer
+// intermediário do stdio.
+inline bool savePPMBinary(const std::string &path, const unsigned char *data, int w, int h, int channels,
+                          const char *comment = NULL, int maxValue = 255) {
+    PPMStreamWriter writer;
+    if (!writer.open(path, w, h, channels, true, comment, maxValue)) return false;
+    writer.writeRows(data, h);
+    return writer.close();
+}
+
+// Grava P2/P3, uma amostra por linha. O texto é montado por tabela num
+// buffer grande e despejado em blocos de 4 MB, sem formatação por amostra.
+inline bool savePPMText(const std::string &path, const unsigned char *data, int w, int h, int channels,
+                        const char *comment = NULL, int maxValue = 255) {
+    PPMStreamWriter writer;
+    if (!writer.open(path, w, h, channels, false, comment, maxValue)) return false;
+    writer.writeRows(data, h);
+    return writer.close();
+}
+
+// Grava PAM (P7) RGBA ou cinza + alfa, binário, em um único write
+inline bool savePAM(const std::string &path, const unsigned char *data, int w, int h, int channels,
+                    const char *comment = NULL, int maxValue = 255) {
+    PPMStreamWriter writer;
+    if (!writer.open(path, w, h, channels, true, comment, maxValue)) return false;
+    writer.writeRows(data, h);
+    return writer.close();
+}
+
+#endif /* PPM_h */
@@ -0,0 +1,551 @@
+//
+//  Pipeline.h
+//
+//  Encadeamento de filtros. Uma descrição como
+//
+//      chroma:0,255,0,0.2 | gray:weighted | negative
+//
+//  vira uma lista de operações. Operações ponto a ponto consecutivas são
+//  fundidas: cada faixa de linhas do RowExecutor (do tamanho do cache)
+//  recebe todas elas em sequência enquanto ainda está no cache, e a imagem
+//  é percorrida na memória uma vez só, em vez de uma vez por filtro.
+//  Operações que são tabelas por canal (negative, colorize, gamma, levels)
+//  seguidas umas das outras viram uma única tabela composta. Filtros de
+//  vizinhança (blur, unsharp, sobel) precisam da imagem inteira de entrada
+//  e interrompem a fusão: cada um é uma passada própria. Níveis automáticos
+//  e equalização leem o histograma da imagem e viram tabelas. A quantização
+//  (Quantize.h) tira a paleta da imagem inteira e não roda em faixas.
+//
+//  Cada operação declara o layout que prefere (Image.h). A imagem só é
+//  convertida quando a próxima operação pede outro layout, e volta ao
+//  layout de quem chamou uma vez, no fim.
+//
+//  Imagens de 16 bits por amostra (ImageView::depth == 2) usam os kernels
+//  e tabelas de 16 bits de cada operação; as tabelas de 16 bits só são
+//  montadas na primeira vez em que uma imagem dessas passa por elas.
+//
+
+#ifndef Pipeline_h
+#define Pipeline_h
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Convolve.h"
+#include "Filters.h"
+#include "Histogram.h"
+#include "Image.h"
+#include "Lut.h"
+#include "Quantize.h"
+#include "RowExecutor.h"
+
+// Operação ponto a ponto sobre um trecho de pixels RGB intercalados
+typedef std::function<void(unsigned char *, size_t)> PointOp;
+
+// Filtro de vizinhança: lê src e grava a imagem inteira em dst (mesmo
+// tamanho e layout, buffers diferentes)
+typedef std::function<void(RowExecutor &, const ImageView &, const ImageView &)> AreaOp;
+
+// O mesmo com amostras de 16 bits (n em pixels)
+typedef std::function<void(uint16_t *, size_t)> PointOp16;
+
+// Tabela por canal calculada do histograma da imagem inteira
+typedef std::function<RgbLut(const Histogram &)> AnalyzeOp;
+typedef std::function<RgbLut16(const WideHistogram &)> AnalyzeOp16;
+
+// Tabela de 16 bits (384 KB) montada no primeiro uso, uma vez só mesmo
+// com várias threads pedindo
+class LazyLut16 {
+public:
+    explicit LazyLut16(const std::function<RgbLut16()> &make) : make(make) {}
+
+    const RgbLut16 &get() {
+        std::call_once(once, [this]() { table = std::make_shared<RgbLut16>(make()); });
+        return *table;
+    }
+
+private:
+    std::function<RgbLut16()> make;
+    std::once_flag once;
+    std::shared_ptr<RgbLut16> table;
+};
+
+struct FilterOp {
+    std::string name;
+    PointOp point;                    // ponto a ponto (ou nulo)
+    PointOp16 point16;                // idem, 16 bits
+    AreaOp area;                      // vizinhança, 8 ou 16 bits (ou nulo)
+    AnalyzeOp analyze;                // tabela calculada do histograma (ou nulo)
+    AnalyzeOp16 analyze16;            // idem, 16 bits
+    std::shared_ptr<RgbLut> lut;      // não nulo se a operação é uma tabela por canal
+    std::shared_ptr<LazyLut16> lut16; // a mesma tabela em 16 bits
+    std::string glsl;                 // a mesma conta em GLSL sobre uvec3 c (GLFilters.h), ou vazio
+    int halo;                         // linhas de vizinhança lidas acima e abaixo
+    bool wholeImage;                  // precisa da imagem inteira (não roda em faixas)
+    ImageLayout layout;               // layout preferido (point só roda intercalado)
+
+    FilterOp() : halo(0), wholeImage(false), layout(LAYOUT_INTERLEAVED) {}
+};
+
+inline std::string trimSpaces(const std::string &s) {
+    size_t a = s.find_first_not_of(" \t\r\n");
+    if (a == std::string::npos) return "";
+    size_t b = s.find_last_not_of(" \t\r\n");
+    return s.substr(a, b - a + 1);
+}
+
+inline std::vector<std::string> splitString(const std::string &s, char sep) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, sep)) parts.push_back(trimSpaces(item));
+    return parts;
+}
+
+// Lê exatamente count números separados por vírgula
+inline bool parseNumbers(const std::string &args, size_t count, std::vector<double> &values) {
+    std::vector<std::string> parts = splitString(args, ',');
+    if (parts.size() != count) return false;
+    values.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        char *end = NULL;
+        values[i] = strtod(parts[i].c_str(), &end);
+        if (parts[i].empty() || *end != '\0') return false;
+    }
+    return true;
+}
+
+// Componente de cor: inteiro em 0..255
+inline bool isByteValue(double v) {
+    return v >= 0.0 && v <= 255.0 && v == floor(v);
+}
+
+/*--------------------------- Construtores de ops ---------------------------*/
+
+inline FilterOp chromaKeyOp(int r, int g, int b, double tolerance) {
+    int threshold = chromaKeyThreshold(tolerance);
+    int64_t threshold16 = chromaKeyThreshold16(tolerance);
+    FilterOp op;
+    op.name = "chroma";
+    op.point = [=](unsigned char *p, size_t n) { applyChromaKey(p, n, r, g, b, threshold); };
+    op.point16 = [=](uint16_t *p, size_t n) { applyChromaKey16(p, n, r, g, b, threshold16); };
+    op.glsl = "ivec3 d = ivec3(c) - ivec3(" + std::to_string(r) + ", " + std::to_string(g) + ", " + std::to_string(b) +
+              "); if (d.r * d.r + d.g * d.g + d.b * d.b < " + std::to_string(threshold) + ") c = uvec3(0u);";
+    return op;
+}
+
+inline FilterOp grayScaleOp(GrayWeights weights) {
+    FilterOp op;
+    op.name = "gray";
+    op.point = [=](unsigned char *p, size_t n) { applyGrayScale(p, n, weights); };
+    op.point16 = [=](uint16_t *p, size_t n) { applyGrayScale16(p, n, weights); };
+    op.glsl = "c = uvec3(min((c.r * " + std::to_string(weights.r) + "u + c.g * " + std::to_string(weights.g) + "u + c.b * " +
+              std::to_string(weights.b) + "u) >> 15, 255u));";
+    return op;
+}
+
+// Só a tabela de 16 bits: análises de imagens de 16 bits e tabelas fundidas
+inline FilterOp lutOp16(const std::string &name, const std::shared_ptr<LazyLut16> &table) {
+    FilterOp op;
+    op.name = name;
+    op.lut16 = table;
+    op.layout = LAYOUT_ANY; // no planar a tabela de cada canal vai no seu plano
+    op.point16 = [table](uint16_t *p, size_t n) { applyRgbLut16(p, n, table->get()); };
+    return op;
+}
+
+inline FilterOp lutOp16(const std::string &name, const RgbLut16 &table) {
+    std::shared_ptr<RgbLut16> t = std::make_shared<RgbLut16>(table);
+    return lutOp16(name, std::make_shared<LazyLut16>([t]() { return *t; }));
+}
+
+// make16 monta a mesma tabela em 16 bits (nulo: a operação não roda em 16)
+inline FilterOp lutOp(const std::string &name, const RgbLut &table,
+                      const std::function<RgbLut16()> &make16 = nullptr) {
+    FilterOp op;
+    if (make16) op = lutOp16(name, std::make_shared<LazyLut16>(make16));
+    op.name = name;
+    op.lut = std::make_shared<RgbLut>(table);
+    op.layout = LAYOUT_ANY;
+    std::shared_ptr<RgbLut> lut = op.lut;
+    op.point = [lut](unsigned char *p, size_t n) { applyRgbLut(p, n, *lut); };
+    return op;
+}
+
+// colorize e negative sozinhos usam os kernels próprios (OR/XOR direto),
+// mais baratos que a consulta; encadeados entram na tabela composta.
+inline FilterOp colorizeOp(int r, int g, int b) {
+    FilterOp op = lutOp("colorize", rgbLut(orLut(r), orLut(g), orLut(b)), [=]() { return orLut16(r, g, b); });
+    op.point = [=](unsigned char *p, size_t n) { applyColorize(p, n, r, g, b); };
+    op.point16 = [=](uint16_t *p, size_t n) { applyColorize16(p, n, r, g, b); };
+    op.glsl = "c |= uvec3(" + std::to_string(r) + "u, " + std::to_string(g) + "u, " + std::to_string(b) + "u);";
+    return op;
+}
+
+inline FilterOp negativeOp() {
+    static constexpr RgbLut NEGATIVE_RGB = rgbLut(NEGATIVE_LUT);
+    FilterOp op = lutOp("negative", NEGATIVE_RGB, negativeLut16);
+    op.point = [](unsigned char *p, size_t n) { applyNegative(p, n); };
+    op.point16 = [](uint16_t *p, size_t n) { applyNegative16(p, n); };
+    op.glsl = "c ^= uvec3(255u);";
+    return op;
+}
+
+inline FilterOp gammaOp(double gamma) {
+    return lutOp("gamma", rgbLut(gammaLut(gamma)), [=]() { return gammaLut16(gamma); });
+}
+
+// Níveis em 0..255; em 16 bits os mesmos pontos, esticados
+inline FilterOp levelsOp(int lo, int hi, double gamma) {
+    return lutOp("levels", rgbLut(levelsLut(lo, hi, gamma)), [=]() { return levelsLut16(lo * 257, hi * 257, gamma); });
+}
+
+// Os borramentos tratam cada canal sozinho e rodam em qualquer layout; o
+// kernel planar não é mais rápido que o intercalado, então converter só
+// para eles custaria duas passadas a mais.
+inline FilterOp boxBlurOp(int radius) {
+    FilterOp op;
+    op.name = "box";
+    op.halo = clampInt(radius, 0, MAX_BLUR_RADIUS);
+    op.layout = LAYOUT_ANY;
+    op.area = [=](RowExecutor &ex, const ImageView &src, const ImageView &dst) { boxBlur(ex, src, dst, radius); };
+    return op;
+}
+
+inline FilterOp gaussianBlurOp(double sigma) {
+    FilterOp op;
+    op.name = "blur";
+    op.halo = gaussianHalo(sigma);
+    op.layout = LAYOUT_ANY;
+    op.area = [=](RowExecutor &ex, const ImageView &src, const ImageView &dst) { gaussianBlur(ex, src, dst, sigma); };
+    return op;
+}
+
+// Limiar em 0..255, esticado para 16 bits
+inline FilterOp unsharpOp(double amount, double sigma, int threshold) {
+    FilterOp op;
+    op.name = "unsharp";
+    op.halo = gaussianHalo(sigma);
+    op.layout = LAYOUT_ANY;
+    op.area = [=](RowExecutor &ex, const ImageView &src, const ImageView &dst) {
+        unsharpMask(ex, src, dst, amount, sigma, src.wide() ? threshold * 257 : threshold);
+    };
+    return op;
+}
+
+inline FilterOp sobelOp() {
+    FilterOp op;
+    op.name = "sobel";
+    op.halo = 1;
+    op.area = [](RowExecutor &ex, const ImageView &src, const ImageView &dst) { sobelEdges(ex, src, dst); };
+    return op;
+}
+
+// A paleta sai da imagem inteira e a difusão de erro corre a imagem toda
+inline FilterOp quantizeOp(const QuantizeOptions &options) {
+    FilterOp op;
+    op.name = "quantize";
+    op.wholeImage = true;
+    op.area = [=](RowExecutor &ex, const ImageView &src, const ImageView &dst) { quantizeImage(ex, src, dst, options); };
+    return op;
+}
+
+inline FilterOp autoLevelsOp(double clip) {
+    FilterOp op;
+    op.name = "autolevels";
+    op.layout = LAYOUT_ANY;
+    op.analyze = [=](const Histogram &hist) { return autoLevelsLut(hist, clip); };
+    op.analyze16 = [=](const WideHistogram &hist) { return autoLevelsLut16(hist, clip); };
+    return op;
+}
+
+inline FilterOp equalizeOp() {
+    FilterOp op;
+    op.name = "equalize";
+    op.layout = LAYOUT_ANY;
+    op.analyze = [](const Histogram &hist) { return equalizeLut(hist); };
+    op.analyze16 = [](const WideHistogram &hist) { return equalizeLut16(hist); };
+    return op;
+}
+
+class FilterPipeline {
+public:
+    void add(const FilterOp &op) { ops.push_back(op); }
+    void clear() { ops.clear(); }
+    bool empty() const { return ops.empty(); }
+    size_t size() const { return ops.size(); }
+    const std::vector<FilterOp> &steps() const { return ops; }
+    void replace(size_t i, const FilterOp &op) { ops[i] = op; }
+
+    // Linhas extras acima e abaixo que uma faixa precisa para que as suas
+    // próprias linhas saiam iguais às da imagem inteira
+    int halo() const {
+        int total = 0;
+        for (size_t i = 0; i < ops.size(); i++) total += ops[i].halo;
+        return total;
+    }
+
+    bool needsWholeImage() const {
+        for (size_t i = 0; i < ops.size(); i++) {
+            if (ops[i].wholeImage) return true;
+        }
+        return false;
+    }
+
+    bool hasAnalysis() const {
+        for (size_t i = 0; i < ops.size(); i++) {
+            if (ops[i].analyze) return true;
+        }
+        return false;
+    }
+
+    // Só as n primeiras operações
+    FilterPipeline prefix(size_t n) const {
+        FilterPipeline p;
+        p.ops.assign(ops.begin(), ops.begin() + (n < ops.size() ? n : ops.size()));
+        return p;
+    }
+
+    // Interpreta "nome[:args] | nome[:args] | ...". Em caso de erro devolve
+    // false e explica em error.
+    bool parse(const std::string &spec, std::string &error) {
+        std::vector<std::string> steps = splitString(spec, '|');
+        for (size_t i = 0; i < steps.size(); i++) {
+            if (steps[i].empty()) continue;
+            FilterOp op;
+            if (!parseStep(steps[i], op, error)) return false;
+            add(op);
+        }
+        if (ops.empty()) {
+            error = "nenhum filtro em \"" + spec + "\"";
+            return false;
+        }
+        return true;
+    }
+
+    std::string describe() const {
+        std::string s;
+        std::vector<FilterOp> fused = fuseLuts(ops);
+        for (size_t i = 0; i < fused.size(); i++) s += (i ? " | " : "") + fused[i].name;
+        return s;
+    }
+
+    // Operações ponto a ponto seguidas formam uma passada paralela em que
+    // cada faixa recebe todas elas em ordem. Cada filtro de vizinhança lê a
+    // imagem atual e grava num buffer de rascunho, que passa a ser a imagem
+    // atual; cada análise (histograma) lê a imagem como está e vira uma
+    // tabela que entra na passada seguinte. No fim o resultado volta para
+    // image, no layout dela.
+    void run(RowExecutor &executor, const ImageView &image) const {
+        Image scratch[2];
+        ImageView current = image;
+        std::vector<FilterOp> pending;
+        bool wide = image.wide();
+
+        // rascunho que não é a imagem atual
+        auto spare = [&](ImageLayout layout) {
+            Image &s = scratch[0].data() == current.data ? scratch[1] : scratch[0];
+            s.allocate(image.width, image.height, image.channels, layout, image.depth);
+            return s.view();
+        };
+        auto convertTo = [&](ImageLayout layout) {
+            if (layout == LAYOUT_ANY || layout == current.layout) return;
+            ImageView next = spare(layout);
+            copyImage(executor, current, next);
+            current = next;
+        };
+        auto flush = [&]() {
+            std::vector<FilterOp> fused = fuseLuts(pending, wide);
+            pending.clear();
+            for (size_t k = 0; k < fused.size(); k++) convertTo(fused[k].layout);
+            runPoints(executor, fused, current);
+        };
+
+        for (size_t i = 0; i < ops.size(); i++) {
+            if (ops[i].area) {
+                flush();
+                convertTo(ops[i].layout);
+                ImageView dst = spare(current.layout);
+                ops[i].area(executor, current, dst);
+                current = dst;
+            } else if (wide && ops[i].analyze16) {
+                flush();
+                pending.push_back(lutOp16(ops[i].name, ops[i].analyze16(computeWideHistogram(executor, current))));
+            } else if (ops[i].analyze) {
+                flush();
+                pending.push_back(lutOp(ops[i].name, ops[i].analyze(computeHistogram(executor, current))));
+            } else {
+                pending.push_back(ops[i]);
+            }
+        }
+        flush();
+        if (current.data != image.data) copyImage(executor, current, image);
+    }
+
+    // RGB intercalado com linhas coladas (o buffer do PPMImage)
+    void run(RowExecutor &executor, unsigned char *data, int w, int h) const {
+        run(executor, ImageView::interleaved(data, w, h));
+    }
+
+    // Junta tabelas consecutivas numa só ("gamma+negative"); wide junta
+    // as de 16 bits
+    static std::vector<FilterOp> fuseLuts(const std::vector<FilterOp> &ops, bool wide = false) {
+        auto isLut = [&](const FilterOp &op) { return wide ? (bool)op.lut16 : (bool)op.lut; };
+        std::vector<FilterOp> out;
+        for (size_t i = 0; i < ops.size(); i++) {
+            size_t j = i;
+            while (isLut(ops[i]) && j + 1 < ops.size() && isLut(ops[j + 1])) j++;
+            if (j == i) {
+                out.push_back(ops[i]);
+                continue;
+            }
+            std::string name = ops[i].name;
+            for (size_t k = i + 1; k <= j; k++) name += "+" + ops[k].name;
+            if (wide) {
+                std::vector<std::shared_ptr<LazyLut16>> parts;
+                for (size_t k = i; k <= j; k++) parts.push_back(ops[k].lut16);
+                out.push_back(lutOp16(name, std::make_shared<LazyLut16>([parts]() {
+                    RgbLut16 table = parts[0]->get();
+                    for (size_t k = 1; k < parts.size(); k++) table = composeLut16(table, parts[k]->get());
+                    return table;
+                })));
+            } else {
+                RgbLut table = *ops[i].lut;
+                for (size_t k = i + 1; k <= j; k++) table = composeLut(table, *ops[k].lut);
+                out.push_back(lutOp(name, table));
+            }
+            i = j;
+        }
+        return out;
+    }
+
+private:
+    // Intercalado: cada operação no trecho de pixels. Planar: só tabelas,
+    // a de cada canal aplicada no seu plano.
+    static void runPoints(RowExecutor &executor, const std::vector<FilterOp> &fused, const ImageView &image) {
+        if (fused.empty()) return;
+        forEachSpan(executor, image, [&](int c, unsigned char *p, size_t n) {
+            for (size_t k = 0; k < fused.size(); k++) {
+                if (image.wide() && image.planar()) {
+                    lut16Scalar((uint16_t *)p, n / 2, fused[k].lut16->get().ch(c));
+                } else if (image.wide()) {
+                    fused[k].point16((uint16_t *)p, n / (image.channels * 2));
+                } else if (image.planar()) {
+                    lutScalar(p, n, fused[k].lut->ch[c]);
+                } else {
+                    fused[k].point(p, n / image.channels);
+                }
+            }
+        });
+    }
+
+    static bool parseStep(const std::string &step, FilterOp &op, std::string &error) {
+        size_t colon = step.find(':');
+        std::string name = trimSpaces(step.substr(0, colon));
+        std::string args = colon == std::string::npos ? "" : trimSpaces(step.substr(colon + 1));
+        std::vector<double> v;
+
+        if (name == "chroma" || name == "chromakey") {
+            if (!parseNumbers(args, 4, v) || !isByteValue(v[0]) || !isByteValue(v[1]) || !isByteValue(v[2]) ||
+                v[3] < 0.0) {
+                error = "uso: chroma:R,G,B,tolerância (ex.: chroma:0,255,0,0.2)";
+                return false;
+            }
+            op = chromaKeyOp((int)v[0], (int)v[1], (int)v[2], v[3]);
+        } else if (name == "gray" || name == "grayscale") {
+            if (args.empty() || args == "weighted" || args == "ponderada") {
+                op = grayScaleOp(grayWeightsLuma());
+            } else if (args == "average" || args == "simples" || args == "s") {
+                op = grayScaleOp(grayWeightsAverage());
+            } else {
+                error = "uso: gray[:weighted|average]";
+                return false;
+            }
+        } else if (name == "colorize") {
+            if (!parseNumbers(args, 3, v) || !isByteValue(v[0]) || !isByteValue(v[1]) || !isByteValue(v[2])) {
+                error = "uso: colorize:R,G,B (0..255)";
+                return false;
+            }
+            op = colorizeOp((int)v[0], (int)v[1], (int)v[2]);
+        } else if (name == "negative") {
+            op = negativeOp();
+        } else if (name == "box") {
+            if (!parseNumbers(args, 1, v) || v[0] < 0 || v[0] > MAX_BLUR_RADIUS) {
+                error = "uso: box:raio (0..1000, ex.: box:5)";
+                return false;
+            }
+            op = boxBlurOp((int)v[0]);
+        } else if (name == "blur" || name == "gauss") {
+            if (!parseNumbers(args, 1, v) || v[0] < 0 || !gaussianFits(v[0])) {
+                error = "uso: blur:sigma (até ~1000, ex.: blur:2.5)";
+                return false;
+            }
+            op = gaussianBlurOp(v[0]);
+        } else if (name == "unsharp") {
+            bool ok = parseNumbers(args, 2, v) || parseNumbers(args, 3, v);
+            if (!ok || v[0] < 0.0 || v[1] <= 0.0 || !gaussianFits(v[1]) || (v.size() > 2 && !isByteValue(v[2]))) {
+                error = "uso: unsharp:intensidade,sigma[,limiar] (ex.: unsharp:1.5,2)";
+                return false;
+            }
+            op = unsharpOp(v[0], v[1], v.size() > 2 ? (int)v[2] : 0);
+        } else if (name == "sobel") {
+            op = sobelOp();
+        } else if (name == "quantize") {
+            // quantize:N[,median|kmeans[,none|ordered|fs]]
+            std::vector<std::string> parts = splitString(args, ',');
+            QuantizeOptions q = { 0, QUANTIZE_KMEANS, DITHER_NONE, 10 };
+            bool ok = !parts.empty() && parts.size() <= 3 && parseNumbers(parts[0], 1, v) && v[0] >= 2 && v[0] <= MAX_PALETTE;
+            if (ok) q.colors = (int)v[0];
+            if (ok && parts.size() > 1) {
+                if (parts[1] == "median") q.method = QUANTIZE_MEDIAN_CUT;
+                else ok = parts[1] == "kmeans";
+            }
+            if (ok && parts.size() > 2) {
+                if (parts[2] == "ordered" || parts[2] == "bayer") q.dither = DITHER_ORDERED;
+                else if (parts[2] == "fs") q.dither = DITHER_FLOYD_STEINBERG;
+                else ok = parts[2] == "none";
+            }
+            if (!ok) {
+                error = "uso: quantize:cores[,median|kmeans[,none|ordered|fs]] (ex.: quantize:16,kmeans,fs)";
+                return false;
+            }
+            op = quantizeOp(q);
+        } else if (name == "autolevels") {
+            if (!args.empty() && (!parseNumbers(args, 1, v) || v[0] < 0 || v[0] >= 50)) {
+                error = "uso: autolevels[:corte%] (ex.: autolevels:0.5)";
+                return false;
+            }
+            op = autoLevelsOp(args.empty() ? 0.005 : v[0] / 100.0);
+        } else if (name == "equalize") {
+            op = equalizeOp();
+        } else if (name == "gamma") {
+            if (!parseNumbers(args, 1, v) || v[0] <= 0.0) {
+                error = "uso: gamma:G (ex.: gamma:2.2)";
+                return false;
+            }
+            op = gammaOp(v[0]);
+        } else if (name == "levels") {
+            bool ok = parseNumbers(args, 2, v) || parseNumbers(args, 3, v);
+            if (!ok || !isByteValue(v[0]) || !isByteValue(v[1]) || v[0] >= v[1] || (v.size() > 2 && v[2] <= 0.0)) {
+                error = "uso: levels:preto,branco[,gama] com preto < branco em 0..255 (ex.: levels:16,235)";
+                return false;
+            }
+            op = levelsOp((int)v[0], (int)v[1], v.size() > 2 ? v[2] : 1.0);
+        } else {
+            error = "filtro desconhecido: " + name;
+            return false;
+        }
+        return true;
+    }
+
+    std::vector<FilterOp> ops;
+};
+
+#endif /* Pipeline_h */
@@ -0,0 +1,578 @@
+//
+//  Quantize.h
+//
+//  Redução da imagem a uma paleta de até 256 cores:
+//
+//  - corte pela mediana: histograma 32x32x32 das cores; a caixa com mais
+//    pixels (vezes o maior lado) é dividida na mediana do seu maior lado até
+//    haver N caixas, e cada cor é a média dos pixels da sua caixa;
+//  - k-means: parte da paleta do corte pela mediana e refina com iterações
+//    de Lloyd sobre uma amostra de linhas (no máximo ~1M pixels).
+//
+//  A parte cara é achar a cor mais próxima de cada pixel: blocos de linhas
+//  em paralelo, 16 (SSE2) ou 32 (AVX2) pixels contra uma cor da paleta por
+//  vez, com a mesma soma de quadrados do chroma-key (Filters.h). O empate
+//  fica com a primeira cor, como no escalar: a saída não depende do nível
+//  SIMD nem do número de threads.
+//
+//  Imagens com até N cores distintas (sprites, pixel art) ficam com as
+//  próprias cores, sem perda e sem pontilhado.
+//
+//  Pontilhado: ordenado (Bayer 8x8, paralelo por faixas) ou Floyd-Steinberg
+//  (erro difundido em serpentina; sequencial dentro da imagem, no lote o
+//  paralelismo fica entre imagens).
+//
+
+#ifndef Quantize_h
+#define Quantize_h
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <vector>
+
+#include "Filters.h"
+#include "Image.h"
+#include "PPM.h"
+#include "RowExecutor.h"
+
+const int MAX_PALETTE = 256;
+
+struct PaletteColor {
+    unsigned char r, g, b;
+};
+
+typedef std::vector<PaletteColor> Palette;
+
+enum QuantizeMethod { QUANTIZE_MEDIAN_CUT, QUANTIZE_KMEANS };
+enum DitherMode { DITHER_NONE, DITHER_ORDERED, DITHER_FLOYD_STEINBERG };
+
+struct QuantizeOptions {
+    int colors;
+    QuantizeMethod method;
+    DitherMode dither;
+    int iterations; // máximo de iterações do k-means
+};
+
+/*---------------------------- cor mais próxima -----------------------------*/
+
+inline int nearestColorScalar(int r, int g, int b, const PaletteColor *pal, int n) {
+    int best = 0, bestD = 0x7fffffff;
+    for (int k = 0; k < n; k++) {
+        int dr = r - pal[k].r, dg = g - pal[k].g, db = b - pal[k].b;
+        int d = dr * dr + dg * dg + db * db;
+        if (d < bestD) { bestD = d; best = k; }
+    }
+    return best;
+}
+
+inline void assignNearestScalar(const unsigned char *p, size_t pixels, const PaletteColor *pal, int n,
+                                unsigned char *index) {
+    for (size_t i = 0; i < pixels; i++) {
+        index[i] = (unsigned char)nearestColorScalar(p[3*i], p[3*i+1], p[3*i+2], pal, n);
+    }
+}
+
+#if CPU_HAS_SSE2
+// Menor distância e índice de 4 pixels: troca onde d < best (SSE2 não
+// tem min de 32 bits nem blend)
+static inline void keepNearer_SSE2(__m128i d, __m128i k, __m128i &best, __m128i &idx) {
+    __m128i less = _mm_cmplt_epi32(d, best);
+    best = _mm_or_si128(_mm_and_si128(less, d), _mm_andnot_si128(less, best));
+    idx = _mm_or_si128(_mm_and_si128(less, k), _mm_andnot_si128(less, idx));
+}
+
+inline void assignNearestSSE2(const unsigned char *p, size_t pixels, const PaletteColor *pal, int n,
+                              unsigned char *index) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        __m128i r, g, b;
+        loadDeinterleaveRGB_SSE2(p + 3 * i, r, g, b);
+        __m128i r16[2] = { _mm_unpacklo_epi8(r, zero), _mm_unpackhi_epi8(r, zero) };
+        __m128i g16[2] = { _mm_unpacklo_epi8(g, zero), _mm_unpackhi_epi8(g, zero) };
+        __m128i b16[2] = { _mm_unpacklo_epi8(b, zero), _mm_unpackhi_epi8(b, zero) };
+        __m128i best[4], idx[4];
+        for (int q = 0; q < 4; q++) { best[q] = _mm_set1_epi32(0x7fffffff); idx[q] = zero; }
+        for (int k = 0; k < n; k++) {
+            __m128i kr = _mm_set1_epi16(pal[k].r), kg = _mm_set1_epi16(pal[k].g), kb = _mm_set1_epi16(pal[k].b);
+            __m128i vk = _mm_set1_epi32(k);
+            for (int h = 0; h < 2; h++) {
+                __m128i lo, hi;
+                squaredDistance8_SSE2(_mm_sub_epi16(r16[h], kr), _mm_sub_epi16(g16[h], kg), _mm_sub_epi16(b16[h], kb), lo, hi);
+                keepNearer_SSE2(lo, vk, best[2*h], idx[2*h]);
+                keepNearer_SSE2(hi, vk, best[2*h+1], idx[2*h+1]);
+            }
+        }
+        __m128i out = _mm_packus_epi16(_mm_packs_epi32(idx[0], idx[1]), _mm_packs_epi32(idx[2], idx[3]));
+        _mm_storeu_si128((__m128i *)(index + i), out);
+    }
+    assignNearestScalar(p + 3 * i, pixels - i, pal, n, index + i);
+}
+#endif /* CPU_HAS_SSE2 */
+
+#if CPU_HAS_AVX2_TARGET
+static inline TARGET_AVX2 void keepNearer_AVX2(__m256i d, __m256i k, __m256i &best, __m256i &idx) {
+    __m256i less = _mm256_cmpgt_epi32(best, d);
+    best = _mm256_min_epi32(best, d);
+    idx = _mm256_blendv_epi8(idx, k, less);
+}
+
+// Mesma ordem de faixas do chromaKeyAVX2: os packs desfazem os unpacks
+inline TARGET_AVX2 void assignNearestAVX2(const unsigned char *p, size_t pixels, const PaletteColor *pal, int n,
+                                          unsigned char *index) {
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= pixels; i += 32) {
+        __m256i r, g, b;
+        loadDeinterleaveRGB_AVX2(p + 3 * i, r, g, b);
+        __m256i r16[2] = { _mm256_unpacklo_epi8(r, zero), _mm256_unpackhi_epi8(r, zero) };
+        __m256i g16[2] = { _mm256_unpacklo_epi8(g, zero), _mm256_unpackhi_epi8(g, zero) };
+        __m256i b16[2] = { _mm256_unpacklo_epi8(b, zero), _mm256_unpackhi_epi8(b, zero) };
+        __m256i best[4], idx[4];
+        for (int q = 0; q < 4; q++) { best[q] = _mm256_set1_epi32(0x7fffffff); idx[q] = zero; }
+        for (int k = 0; k < n; k++) {
+            __m256i kr = _mm256_set1_epi16(pal[k].r), kg = _mm256_set1_epi16(pal[k].g), kb = _mm256_set1_epi16(pal[k].b);
+            __m256i vk = _mm256_set1_epi32(k);
+            for (int h = 0; h < 2; h++) {
+                __m256i lo, hi;
+                squaredDistance16_AVX2(_mm256_sub_epi16(r16[h], kr), _mm256_sub_epi16(g16[h], kg),
+                                       _mm256_sub_epi16(b16[h], kb), lo, hi);
+                keepNearer_AVX2(lo, vk, best[2*h], idx[2*h]);
+                keepNearer_AVX2(hi, vk, best[2*h+1], idx[2*h+1]);
+            }
+        }
+        __m256i out = _mm256_packus_epi16(_mm256_packs_epi32(idx[0], idx[1]), _mm256_packs_epi32(idx[2], idx[3]));
+        _mm256_storeu_si256((__m256i *)(index + i), out);
+    }
+    assignNearestScalar(p + 3 * i, pixels - i, pal, n, index + i);
+}
+#endif /* CPU_HAS_AVX2_TARGET */
+
+// index[i] = cor da paleta mais próxima do pixel i
+inline void assignNearest(const unsigned char *p, size_t pixels, const Palette &palette, unsigned char *index) {
+    const PaletteColor *pal = palette.data();
+    int n = (int)palette.size();
+    switch (activeSimdLevel()) {
+#if CPU_HAS_AVX2_TARGET
+        case SIMD_AVX2: assignNearestAVX2(p, pixels, pal, n, index); return;
+#endif
+#if CPU_HAS_SSE2
+        case SIMD_SSE2: assignNearestSSE2(p, pixels, pal, n, index); return;
+#endif
+        default: assignNearestScalar(p, pixels, pal, n, index);
+    }
+}
+
+/*----------------------------- cores distintas -----------------------------*/
+
+// Conjunto de cores RGB com no máximo limit elementos (endereçamento aberto)
+class ColorSet {
+public:
+    explicit ColorSet(int limit) : limit(limit), count(0), last(0) {
+        size_t size = 64;
+        while (size < (size_t)limit * 4) size *= 2;
+        keys.assign(size, 0);
+    }
+
+    // false quando a cor nova passaria do limite
+    bool insert(uint32_t rgb) {
+        uint32_t key = rgb + 1; // 0 = vazio
+        if (key == last) return true; // sprites: cores repetidas em sequência
+        size_t mask = keys.size() - 1;
+        for (size_t i = (key * 2654435761u) & mask;; i = (i + 1) & mask) {
+            if (keys[i] == key) break;
+            if (keys[i] == 0) {
+                if (count == limit) return false;
+                keys[i] = key;
+                count++;
+                break;
+            }
+        }
+        last = key;
+        return true;
+    }
+
+    bool insertAll(const ColorSet &other) {
+        for (size_t i = 0; i < other.keys.size(); i++) {
+            if (other.keys[i] && !insert(other.keys[i] - 1)) return false;
+        }
+        return true;
+    }
+
+    Palette colors() const {
+        Palette out;
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (keys[i]) {
+                uint32_t c = keys[i] - 1;
+                out.push_back(PaletteColor{ (unsigned char)(c >> 16), (unsigned char)(c >> 8), (unsigned char)c });
+            }
+        }
+        return out;
+    }
+
+private:
+    int limit, count;
+    uint32_t last;
+    std::vector<uint32_t> keys;
+};
+
+// As cores da imagem, se forem no máximo limit; senão, false
+inline bool exactPalette(RowExecutor &executor, const ImageView &image, int limit, Palette &out) {
+    int h = image.height, w = image.width;
+    size_t chunks = (size_t)executor.threads() * 4;
+    if (chunks > (size_t)h) chunks = (size_t)h;
+    std::vector<ColorSet> partial(chunks, ColorSet(limit));
+    std::atomic<bool> tooMany(false);
+    executor.threadPool().run(chunks, [&](size_t k) {
+        int y0 = (int)((size_t)h * k / chunks), y1 = (int)((size_t)h * (k + 1) / chunks);
+        for (int y = y0; y < y1 && !tooMany; y++) {
+            const unsigned char *p = image.row(y);
+            for (int x = 0; x < w; x++) {
+                if (!partial[k].insert((uint32_t)p[3*x] << 16 | (uint32_t)p[3*x+1] << 8 | p[3*x+2])) {
+                    tooMany = true;
+                    return;
+                }
+            }
+        }
+    });
+    if (tooMany) return false;
+    ColorSet all(limit);
+    for (size_t k = 0; k < chunks; k++) {
+        if (!all.insertAll(partial[k])) return false;
+    }
+    out = all.colors();
+    return true;
+}
+
+/*---------------------------- corte pela mediana ---------------------------*/
+
+const int CUBE_BITS = 5;
+const int CUBE_SIDE = 1 << CUBE_BITS;
+
+inline int cubeIndex(int r, int g, int b) {
+    return (r << (2 * CUBE_BITS)) | (g << CUBE_BITS) | b;
+}
+
+// Histograma 32x32x32 com a soma de cada canal por célula, para as médias
+struct ColorCube {
+    std::vector<uint64_t> count, sum; // sum: 3 por célula
+
+    ColorCube() : count(CUBE_SIDE * CUBE_SIDE * CUBE_SIDE, 0), sum(3 * count.size(), 0) {}
+
+    void add(const ColorCube &other) {
+        for (size_t i = 0; i < count.size(); i++) count[i] += other.count[i];
+        for (size_t i = 0; i < sum.size(); i++) sum[i] += other.sum[i];
+    }
+};
+
+// Uma tarefa por thread: cada cubo privado ocupa 1 MB
+inline ColorCube computeColorCube(RowExecutor &executor, const ImageView &image) {
+    int h = image.height, w = image.width;
+    const int shift = 8 - CUBE_BITS;
+    size_t chunks = executor.threads();
+    if (chunks > (size_t)h) chunks = (size_t)h;
+    std::vector<ColorCube> partial(chunks);
+    executor.threadPool().run(chunks, [&](size_t k) {
+        int y0 = (int)((size_t)h * k / chunks), y1 = (int)((size_t)h * (k + 1) / chunks);
+        uint64_t *count = partial[k].count.data(), *sum = partial[k].sum.data();
+        for (int y = y0; y < y1; y++) {
+            const unsigned char *p = image.row(y);
+            for (int x = 0; x < w; x++) {
+                int r = p[3*x], g = p[3*x+1], b = p[3*x+2];
+                int i = cubeIndex(r >> shift, g >> shift, b >> shift);
+                count[i]++;
+                sum[3*i] += r; sum[3*i+1] += g; sum[3*i+2] += b;
+            }
+        }
+    });
+    ColorCube total;
+    for (size_t k = 0; k < chunks; k++) total.add(partial[k]);
+    return total;
+}
+
+// Caixa de células [lo, hi] (inclusive) em cada canal
+struct CutBox {
+    int lo[3], hi[3];
+    uint64_t count;
+};
+
+// Encolhe a caixa até as células ocupadas e recalcula count
+inline void shrinkBox(const ColorCube &cube, CutBox &box) {
+    int lo[3] = { CUBE_SIDE, CUBE_SIDE, CUBE_SIDE }, hi[3] = { -1, -1, -1 };
+    box.count = 0;
+    for (int r = box.lo[0]; r <= box.hi[0]; r++) {
+        for (int g = box.lo[1]; g <= box.hi[1]; g++) {
+            for (int b = box.lo[2]; b <= box.hi[2]; b++) {
+                uint64_t c = cube.count[cubeIndex(r, g, b)];
+                if (!c) continue;
+                box.count += c;
+                int v[3] = { r, g, b };
+                for (int a = 0; a < 3; a++) {
+                    if (v[a] < lo[a]) lo[a] = v[a];
+                    if (v[a] > hi[a]) hi[a] = v[a];
+                }
+            }
+        }
+    }
+    if (box.count == 0) return;
+    for (int a = 0; a < 3; a++) { box.lo[a] = lo[a]; box.hi[a] = hi[a]; }
+}
+
+// Pixels da caixa por fatia do eixo axis
+inline std::vector<uint64_t> boxSlices(const ColorCube &cube, const CutBox &box, int axis) {
+    std::vector<uint64_t> slices(CUBE_SIDE, 0);
+    for (int r = box.lo[0]; r <= box.hi[0]; r++) {
+        for (int g = box.lo[1]; g <= box.hi[1]; g++) {
+            for (int b = box.lo[2]; b <= box.hi[2]; b++) {
+                int v[3] = { r, g, b };
+                slices[v[axis]] += cube.count[cubeIndex(r, g, b)];
+            }
+        }
+    }
+    return slices;
+}
+
+inline Palette medianCutPalette(const ColorCube &cube, int colors) {
+    std::vector<CutBox> boxes(1);
+    for (int a = 0; a < 3; a++) { boxes[0].lo[a] = 0; boxes[0].hi[a] = CUBE_SIDE - 1; }
+    shrinkBox(cube, boxes[0]);
+    if (boxes[0].count == 0) return Palette(1, PaletteColor{ 0, 0, 0 });
+
+    while ((int)boxes.size() < colors) {
+        // a caixa divisível com mais pixels x maior lado
+        int pick = -1, axis = 0;
+        double bestScore = 0.0;
+        for (size_t i = 0; i < boxes.size(); i++) {
+            int a = 0;
+            for (int k = 1; k < 3; k++) {
+                if (boxes[i].hi[k] - boxes[i].lo[k] > boxes[i].hi[a] - boxes[i].lo[a]) a = k;
+            }
+            int side = boxes[i].hi[a] - boxes[i].lo[a];
+            double score = (double)boxes[i].count * side;
+            if (side > 0 && score > bestScore) { bestScore = score; pick = (int)i; axis = a; }
+        }
+        if (pick < 0) break; // todas as caixas são uma célula só
+
+        CutBox &box = boxes[pick];
+        std::vector<uint64_t> slices = boxSlices(cube, box, axis);
+        uint64_t half = box.count / 2, sum = 0;
+        int cut = box.lo[axis];
+        while (cut < box.hi[axis] - 1 && (sum += slices[cut]) < half) cut++;
+        CutBox upper = box;
+        box.hi[axis] = cut;
+        upper.lo[axis] = cut + 1;
+        shrinkBox(cube, box);
+        shrinkBox(cube, upper);
+        boxes.push_back(upper);
+    }
+
+    Palette out;
+    for (size_t i = 0; i < boxes.size(); i++) {
+        uint64_t n = 0, s[3] = { 0, 0, 0 };
+        const CutBox &box = boxes[i];
+        for (int r = box.lo[0]; r <= box.hi[0]; r++) {
+            for (int g = box.lo[1]; g <= box.hi[1]; g++) {
+                for (int b = box.lo[2]; b <= box.hi[2]; b++) {
+                    int c = cubeIndex(r, g, b);
+                    n += cube.count[c];
+                    for (int a = 0; a < 3; a++) s[a] += cube.sum[3*c+a];
+                }
+            }
+        }
+        if (n == 0) continue;
+        out.push_back(PaletteColor{ (unsigned char)((s[0] + n / 2) / n), (unsigned char)((s[1] + n / 2) / n),
+                                    (unsigned char)((s[2] + n / 2) / n) });
+    }
+    return out;
+}
+
+/*--------------------------------- k-means ---------------------------------*/
+
+// Iterações de Lloyd até nenhuma cor mudar (arredondada) ou iterations.
+// Cada tarefa atribui as suas linhas e soma os pixels de cada cor; as
+// médias saem da soma dos parciais.
+inline Palette kmeansPalette(RowExecutor &executor, const ImageView &image, Palette palette, int iterations) {
+    int w = image.width, h = image.height;
+    int step = (int)(((size_t)w * h >> 20) + 1); // uma linha a cada step
+    int rows = (h + step - 1) / step;
+    size_t chunks = (size_t)executor.threads() * 4;
+    if (chunks > (size_t)rows) chunks = (size_t)rows;
+    int n = (int)palette.size();
+
+    for (int it = 0; it < iterations; it++) {
+        std::vector<std::vector<uint64_t>> partial(chunks, std::vector<uint64_t>((size_t)n * 4, 0));
+        executor.threadPool().run(chunks, [&](size_t k) {
+            int r0 = (int)((size_t)rows * k / chunks), r1 = (int)((size_t)rows * (k + 1) / chunks);
+            std::vector<unsigned char> index(w);
+            uint64_t *acc = partial[k].data();
+            for (int r = r0; r < r1; r++) {
+                const unsigned char *p = image.row(r * step);
+                assignNearest(p, w, palette, index.data());
+                for (int x = 0; x < w; x++) {
+                    uint64_t *a = acc + 4 * index[x];
+                    a[0]++; a[1] += p[3*x]; a[2] += p[3*x+1]; a[3] += p[3*x+2];
+                }
+            }
+        });
+        bool moved = false;
+        for (int c = 0; c < n; c++) {
+            uint64_t s[4] = { 0, 0, 0, 0 };
+            for (size_t k = 0; k < chunks; k++) {
+                for (int a = 0; a < 4; a++) s[a] += partial[k][4 * c + a];
+            }
+            if (s[0] == 0) continue; // cor sem pixels: fica onde está
+            PaletteColor next = { (unsigned char)((s[1] + s[0] / 2) / s[0]), (unsigned char)((s[2] + s[0] / 2) / s[0]),
+                                  (unsigned char)((s[3] + s[0] / 2) / s[0]) };
+            if (memcmp(&next, &palette[c], sizeof(next)) != 0) moved = true;
+            palette[c] = next;
+        }
+        if (!moved) break;
+    }
+    return palette;
+}
+
+/*------------------------------- pontilhado --------------------------------*/
+
+// Matriz de Bayer 8x8 (0..63)
+inline int bayer8(int x, int y) {
+    int v = 0;
+    for (int bit = 0; bit < 3; bit++) {
+        int xb = (x >> bit) & 1, yb = (y >> bit) & 1;
+        v |= ((xb ^ yb) << (5 - 2 * bit)) | (yb << (4 - 2 * bit));
+    }
+    return v;
+}
+
+inline unsigned char clampByte(int v) { return (unsigned char)(v < 0 ? 0 : v > 255 ? 255 : v); }
+
+// Pixels da faixa [y0, y1) trocados pela cor mais próxima; ordered soma
+// antes o deslocamento de Bayer (amplitude ~ distância entre cores vizinhas
+// de uma paleta uniforme de mesmo tamanho)
+inline void mapRows(const ImageView &src, const ImageView &dst, const Palette &palette, bool ordered, int y0, int y1) {
+    int w = src.width;
+    std::vector<unsigned char> biased(ordered ? (size_t)w * 3 : 0), index(w);
+    double spread = 255.0 / cbrt((double)palette.size());
+    int bias[64];
+    for (int k = 0; k < 64; k++) bias[k] = (int)floor(((k + 0.5) / 64.0 - 0.5) * spread + 0.5);
+    for (int y = y0; y < y1; y++) {
+        const unsigned char *p = src.row(y);
+        if (ordered) {
+            for (int x = 0; x < w; x++) {
+                int d = bias[bayer8(x, y)];
+                for (int c = 0; c < 3; c++) biased[3*x+c] = clampByte(p[3*x+c] + d);
+            }
+            p = biased.data();
+        }
+        assignNearest(p, w, palette, index.data());
+        unsigned char *out = dst.row(y);
+        for (int x = 0; x < w; x++) {
+            const PaletteColor &c = palette[index[x]];
+            out[3*x] = c.r; out[3*x+1] = c.g; out[3*x+2] = c.b;
+        }
+    }
+}
+
+// Cache de mapeamento direto cor -> índice para a difusão de erro, que
+// consulta um pixel por vez
+class NearestCache {
+public:
+    explicit NearestCache(const Palette &palette) : palette(palette), keys(1 << 16, 0), values(1 << 16) {}
+
+    int find(int r, int g, int b) {
+        uint32_t key = ((uint32_t)r << 16 | (uint32_t)g << 8 | (uint32_t)b) + 1;
+        size_t slot = (key * 2654435761u) >> 16;
+        if (keys[slot] != key) {
+            keys[slot] = key;
+            values[slot] = (unsigned char)nearestColorScalar(r, g, b, palette.data(), (int)palette.size());
+        }
+        return values[slot];
+    }
+
+private:
+    const Palette &palette;
+    std::vector<uint32_t> keys;
+    std::vector<unsigned char> values;
+};
+
+// Floyd-Steinberg em serpentina. Os erros acumulados ficam em 1/16 de
+// nível, em duas linhas com uma coluna de folga em cada ponta.
+inline void floydSteinberg(const ImageView &src, const ImageView &dst, const Palette &palette) {
+    int w = src.width, h = src.height;
+    std::vector<int> errA((size_t)(w + 2) * 3, 0), errB((size_t)(w + 2) * 3, 0);
+    int *cur = errA.data() + 3, *next = errB.data() + 3;
+    NearestCache cache(palette);
+    for (int y = 0; y < h; y++) {
+        const unsigned char *p = src.row(y);
+        unsigned char *out = dst.row(y);
+        int dir = (y & 1) ? -1 : 1;
+        for (int i = 0; i < w; i++) {
+            int x = dir > 0 ? i : w - 1 - i;
+            int v[3];
+            for (int c = 0; c < 3; c++) v[c] = clampByte(p[3*x+c] + ((cur[3*x+c] + 8) >> 4));
+            const PaletteColor &q = palette[cache.find(v[0], v[1], v[2])];
+            int e[3] = { v[0] - q.r, v[1] - q.g, v[2] - q.b };
+            out[3*x] = q.r; out[3*x+1] = q.g; out[3*x+2] = q.b;
+            for (int c = 0; c < 3; c++) {
+                cur[3*(x+dir)+c] += e[c] * 7;
+                next[3*(x-dir)+c] += e[c] * 3;
+                next[3*x+c] += e[c] * 5;
+                next[3*(x+dir)+c] += e[c];
+            }
+        }
+        std::swap(cur, next);
+        memset(next - 3, 0, (size_t)(w + 2) * 3 * sizeof(int));
+    }
+}
+
+/*---------------------------------- tudo -----------------------------------*/
+
+inline Palette buildPalette(RowExecutor &executor, const ImageView &image, const QuantizeOptions &options) {
+    Palette palette = medianCutPalette(computeColorCube(executor, image), options.colors);
+    if (options.method == QUANTIZE_KMEANS) palette = kmeansPalette(executor, image, palette, options.iterations);
+    return palette;
+}
+
+// src e dst RGB intercalado de 8 bits (podem ser o mesmo buffer)
+inline void quantize8(RowExecutor &executor, const ImageView &src, const ImageView &dst, const QuantizeOptions &options) {
+    Palette palette;
+    bool exact = exactPalette(executor, src, options.colors, palette);
+    if (!exact) palette = buildPalette(executor, src, options);
+    if (!exact && options.dither == DITHER_FLOYD_STEINBERG) {
+        floydSteinberg(src, dst, palette);
+        return;
+    }
+    bool ordered = !exact && options.dither == DITHER_ORDERED;
+    executor.forEachBand(src.height, (size_t)src.width * 3, [&](int y0, int y1) {
+        mapRows(src, dst, palette, ordered, y0, y1);
+    });
+}
+
+// 16 bits: a paleta é de 8 bits (até 256 cores), então a imagem é reduzida
+// a 8 bits, quantizada e esticada de volta
+inline void quantizeImage(RowExecutor &executor, const ImageView &src, const ImageView &dst,
+                          const QuantizeOptions &options) {
+    if (!src.wide()) {
+        quantize8(executor, src, dst, options);
+        return;
+    }
+    int w = src.width;
+    Image narrow(w, src.height, 3, LAYOUT_INTERLEAVED);
+    ImageView n = narrow.view();
+    executor.forEachBand(src.height, (size_t)w * 6, [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++) {
+            const uint16_t *s = (const uint16_t *)src.row(y);
+            for (int i = 0; i < w * 3; i++) n.row(y)[i] = (unsigned char)narrowSample(s[i], 255);
+        }
+    });
+    quantize8(executor, n, n, options);
+    executor.forEachBand(src.height, (size_t)w * 6, [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++) {
+            uint16_t *o = (uint16_t *)dst.row(y);
+            for (int i = 0; i < w * 3; i++) o[i] = (uint16_t)(n.row(y)[i] * 257);
+        }
+    });
+}
+
+#endif /* Quantize_h */
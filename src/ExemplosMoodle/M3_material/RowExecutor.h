@@ -0,0 +1,89 @@
+//
+//  RowExecutor.h
+//
+//  Execução paralela de filtros por faixas de linhas. A imagem é cortada em
+//  faixas de linhas consecutivas que cabem na metade do cache L2 e as faixas
+//  são distribuídas no ThreadPool. O corte depende só do tamanho da imagem,
+//  não do número de threads, e as faixas não se sobrepõem: a saída é a
+//  mesma com 1 ou N threads.
+//
+
+#ifndef RowExecutor_h
+#define RowExecutor_h
+
+#include <stddef.h>
+#include <functional>
+#include <memory>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+#include "ThreadPool.h"
+
+// Tamanho do L2 por núcleo; 256 KB quando o sistema não informa.
+inline size_t detectL2CacheBytes() {
+    long l2 = 0;
+#if defined(__linux__) && defined(_SC_LEVEL2_CACHE_SIZE)
+    l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    return l2 > 0 ? (size_t)l2 : (256 << 10);
+}
+
+inline size_t l2CacheBytes() {
+    static const size_t bytes = detectL2CacheBytes();
+    return bytes;
+}
+
+// Linhas por faixa: metade do L2, para sobrar espaço para a pilha e tabelas.
+inline int bandRows(size_t rowBytes) {
+    size_t rows = rowBytes > 0 ? (l2CacheBytes() / 2) / rowBytes : 1;
+    return rows < 1 ? 1 : (int)rows;
+}
+
+class RowExecutor {
+public:
+    // threads = 0 usa todos os núcleos
+    explicit RowExecutor(unsigned threads = 0) : pool(new ThreadPool(threads)) {}
+
+    void setThreads(unsigned threads) { pool.reset(new ThreadPool(threads)); }
+    unsigned threads() const { return pool->size(); }
+    ThreadPool &threadPool() { return *pool; }
+
+    // fn(y0, y1) para cada faixa [y0, y1) das height linhas.
+    void forEachBand(int height, size_t rowBytes, const std::function<void(int, int)> &fn) {
+        int rows = bandRows(rowBytes);
+        size_t bands = (size_t)(height + rows - 1) / rows;
+        pool->run(bands, [&](size_t band) {
+            int y0 = (int)band * rows;
+            int y1 = y0 + rows < height ? y0 + rows : height;
+            fn(y0, y1);
+        });
+    }
+
+    // fn(x0, x1, y0, y1) para cada bloco tileW x tileH da imagem, para
+    // filtros de vizinhança que precisam limitar também a largura.
+    void forEachTile(int width, int height, int tileW, int tileH, const std::function<void(int, int, int, int)> &fn) {
+        if (tileW < 1) tileW = 1;
+        if (tileH < 1) tileH = 1;
+        size_t cols = (size_t)(width + tileW - 1) / tileW;
+        size_t rows = (size_t)(height + tileH - 1) / tileH;
+        pool->run(cols * rows, [&](size_t tile) {
+            int x0 = (int)(tile % cols) * tileW, y0 = (int)(tile / cols) * tileH;
+            fn(x0, x0 + tileW < width ? x0 + tileW : width, y0, y0 + tileH < height ? y0 + tileH : height);
+        });
+    }
+
+    // Para filtros ponto a ponto sobre RGB intercalado: fn(início, pixels).
+    void forEachPixels(unsigned char *data, int w, int h, const std::function<void(unsigned char *, size_t)> &fn) {
+        size_t rowBytes = (size_t)w * 3;
+        forEachBand(h, rowBytes, [&](int y0, int y1) {
+            fn(data + (size_t)y0 * rowBytes, (size_t)(y1 - y0) * w);
+        });
+    }
+
+private:
+    std::unique_ptr<ThreadPool> pool;
+};
+
+#endif /* RowExecutor_h */
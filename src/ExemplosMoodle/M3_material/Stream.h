@@ -0,0 +1,172 @@
+//
+//  Stream.h
+//
+//  Processamento em faixas de altura fixa para imagens maiores que a
+//  memória. Lê o cabeçalho, depois vai lendo, filtrando e gravando faixas;
+//  só uma janela de linhas fica na memória. Filtros de vizinhança recebem
+//  linhas extras (halo) acima e abaixo da faixa, e as linhas de cada faixa
+//  saem iguais às do processamento da imagem inteira.
+//
+//  Níveis automáticos e equalização precisam do histograma da imagem toda:
+//  cada um custa uma passada extra de leitura antes da passada final.
+//
+
+#ifndef Stream_h
+#define Stream_h
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Batch.h"
+#include "Histogram.h"
+#include "PPM.h"
+#include "Pipeline.h"
+
+// Altura de faixa padrão: uns 64 MB de pixels por faixa
+inline int defaultStripRows(int w, int bytesPerSample = 1) {
+    size_t rows = ((size_t)64 << 20) / ((size_t)w * 3 * bytesPerSample);
+    return rows < 16 ? 16 : (int)rows;
+}
+
+// Recebe as linhas prontas [y0, y0 + rows) de uma faixa
+typedef std::function<bool(const unsigned char *, int, int)> StripSink;
+
+// Uma passada do pipeline pela imagem em faixas de stripRows linhas
+inline bool streamPass(const std::string &input, const FilterPipeline &pipeline, RowExecutor &executor,
+                       int stripRows, const StripSink &sink) {
+    PPMStreamReader reader;
+    if (!reader.open(input)) return false;
+    int w = reader.header.width, h = reader.header.height;
+    int halo = pipeline.halo();
+    int depth = reader.bytesPerSample();
+    int strip = stripRows > 0 ? stripRows : defaultStripRows(w, depth);
+    size_t rowBytes = (size_t)w * 3 * depth;
+
+    // janela com as linhas de entrada [wy0, wy1)
+    std::vector<unsigned char> window((size_t)(strip + 2 * halo) * rowBytes), work;
+    int wy0 = 0, wy1 = 0;
+
+    for (int y0 = 0; y0 < h; y0 += strip) {
+        int y1 = y0 + strip < h ? y0 + strip : h;
+        int need0 = y0 - halo > 0 ? y0 - halo : 0;
+        int need1 = y1 + halo < h ? y1 + halo : h;
+
+        // descarta o que ficou para trás e lê só as linhas novas
+        if (need0 > wy0) {
+            memmove(window.data(), window.data() + (size_t)(need0 - wy0) * rowBytes, (size_t)(wy1 - need0) * rowBytes);
+            wy0 = need0;
+        }
+        if (wy1 < need1) {
+            if (!reader.readRows(window.data() + (size_t)(wy1 - wy0) * rowBytes, need1 - wy1)) return false;
+            wy1 = need1;
+        }
+
+        int rows = need1 - need0;
+        unsigned char *data = window.data();
+        if (halo > 0) {
+            // a janela ainda serve de entrada para a próxima faixa
+            work.assign(window.begin(), window.begin() + (size_t)rows * rowBytes);
+            data = work.data();
+        }
+        pipeline.run(executor, ImageView::interleaved(data, w, rows, 3, 0, depth));
+        if (!sink(data + (size_t)(y0 - need0) * rowBytes, y0, y1 - y0)) return false;
+    }
+    return true;
+}
+
+// Troca cada análise (histograma) por sua tabela, com uma passada de
+// leitura das operações anteriores a ela.
+inline bool resolveAnalyses(const std::string &input, FilterPipeline &pipeline, RowExecutor &executor, int stripRows) {
+    for (size_t i = 0; i < pipeline.size(); i++) {
+        const FilterOp &op = pipeline.steps()[i];
+        if (!op.analyze) continue;
+        int w = 0, depth = 1;
+        {
+            PPMStreamReader header;
+            if (!header.open(input)) return false;
+            w = header.header.width;
+            depth = header.bytesPerSample();
+        }
+        Histogram hist;
+        WideHistogram wideHist;
+        bool ok = streamPass(input, pipeline.prefix(i), executor, stripRows,
+                             [&](const unsigned char *rows, int, int count) {
+                                 ImageView view = ImageView::interleaved((unsigned char *)rows, w, count, 3, 0, depth);
+                                 if (depth == 2) {
+                                     wideHist.add(computeWideHistogram(executor, view));
+                                 } else {
+                                     hist.add(computeHistogram(executor, view));
+                                 }
+                                 return true;
+                             });
+        if (!ok) return false;
+        FilterOp table = depth == 2 ? lutOp16(op.name, op.analyze16(wideHist)) : lutOp(op.name, op.analyze(hist));
+        pipeline.replace(i, table);
+    }
+    return true;
+}
+
+inline bool streamImage(const std::string &input, const std::string &output, const FilterPipeline &pipeline,
+                        RowExecutor &executor, int stripRows, BatchFormat format) {
+    FilterPipeline resolved = pipeline;
+    if (!resolveAnalyses(input, resolved, executor, stripRows)) return false;
+
+    PPMStreamReader header;
+    if (!header.open(input)) return false;
+    bool binary = format == BATCH_BINARY || (format == BATCH_KEEP && header.isBinary());
+    int w = header.header.width, h = header.header.height, maxValue = header.header.maxValue;
+    header.close();
+
+    PPMStreamWriter writer;
+    if (!writer.open(output, w, h, 3, binary, NULL, maxValue)) {
+        fprintf(stderr, "Erro ao gravar %s\n", output.c_str());
+        return false;
+    }
+    bool ok = streamPass(input, resolved, executor, stripRows, [&](const unsigned char *rows, int, int count) {
+        return writer.writeRows(rows, count);
+    });
+    return writer.close() && ok;
+}
+
+// Lote em modo faixa: uma imagem por vez, cada faixa filtrada em paralelo
+inline BatchStats runStreamBatch(const BatchOptions &options, const FilterPipeline &pipeline, RowExecutor &executor,
+                                 int stripRows) {
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point t0 = Clock::now();
+    BatchStats stats = { 0, 0, 0.0, 0.0 };
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.outDir, ec);
+    for (size_t i = 0; i < options.inputs.size(); i++) {
+        const std::string &input = options.inputs[i];
+        std::string output = (std::filesystem::path(options.outDir) / std::filesystem::path(input).filename()).string();
+        std::error_code same;
+        if (std::filesystem::equivalent(input, output, same)) {
+            fprintf(stderr, "Saída igual à entrada, ignorado: %s\n", input.c_str());
+            stats.failed++;
+            continue;
+        }
+        PPMStreamReader header;
+        if (!header.open(input)) {
+            stats.failed++;
+            continue;
+        }
+        double mp = (double)header.header.width * header.header.height / 1e6;
+        header.close();
+        if (streamImage(input, output, pipeline, executor, stripRows, options.format)) {
+            stats.done++;
+            stats.megapixels += mp;
+        } else {
+            stats.failed++;
+        }
+    }
+    stats.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    return stats;
+}
+
+#endif /* Stream_h */
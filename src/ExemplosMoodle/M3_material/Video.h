@@ -0,0 +1,420 @@
+//
+//  Video.h
+//
+//  Filtragem de vídeo por pipe: lê quadros de um fluxo (stdin) em Y4M ou
+//  em P6 concatenados, aplica o FilterPipeline e grava os quadros no mesmo
+//  formato (stdout). Serve para ffmpeg ... -f yuv4mpegpipe - | exemplo_03
+//  --video "..." | ffmpeg -i - ...
+//
+//      leitura (1)  ->  filtros (N threads, um quadro cada)  ->  escrita (1)
+//
+//  Os quadros vêm de um conjunto fixo de buffers, alocados uma vez e
+//  reciclados: a leitura espera um buffer livre, então a memória fica
+//  constante e a latência limitada a poucos quadros. Cada thread de filtro
+//  pega o próximo quadro e roda o pipeline inteiro nele; a escrita
+//  reordena os quadros prontos e os grava na ordem de chegada.
+//
+//  Y4M: 8 bits, 4:2:0 (420jpeg/420paldv/420mpeg2), 4:2:2, 4:4:4 ou mono,
+//  BT.601 em faixa limitada (16..235) a não ser com XCOLORRANGE=FULL. A
+//  croma é replicada para os pixels do bloco na ida e tirada da média do
+//  bloco na volta. P6: 8 ou 16 bits, e cada quadro traz seu cabeçalho.
+//
+
+#ifndef Video_h
+#define Video_h
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BlockingQueue.h"
+#include "Image.h"
+#include "PPM.h"
+#include "Pipeline.h"
+
+enum VideoFormat {
+    VIDEO_Y4M,
+    VIDEO_P6
+};
+
+struct VideoOptions {
+    unsigned workers;  // threads de filtro (quadros filtrados ao mesmo tempo)
+    size_t queueDepth; // quadros em espera entre estágios
+
+    VideoOptions() : workers(1), queueDepth(2) {}
+};
+
+struct VideoStats {
+    size_t frames;
+    double seconds;
+    bool ok;
+};
+
+/*---------------------------------- Y4M ------------------------------------*/
+
+struct Y4MHeader {
+    int width, height;
+    int chromaShiftX, chromaShiftY; // 4:2:0 = 1, 1; 4:2:2 = 1, 0; 4:4:4 = 0, 0
+    bool mono, fullRange;
+    std::string line;               // linha original, repetida na saída
+
+    int chromaWidth() const { return (width + (1 << chromaShiftX) - 1) >> chromaShiftX; }
+    int chromaHeight() const { return (height + (1 << chromaShiftY) - 1) >> chromaShiftY; }
+    size_t frameBytes() const {
+        return (size_t)width * height + (mono ? 0 : 2 * (size_t)chromaWidth() * chromaHeight());
+    }
+};
+
+// "YUV4MPEG2 W1920 H1080 F30:1 Ip A1:1 C420jpeg XYSCSS=420JPEG"
+inline bool parseY4MHeader(const std::string &line, Y4MHeader &h, std::string &error) {
+    std::istringstream in(line);
+    std::string tag, chroma = "420jpeg";
+    in >> tag;
+    if (tag != "YUV4MPEG2") {
+        error = "não é Y4M";
+        return false;
+    }
+    h.width = h.height = 0;
+    h.fullRange = false;
+    while (in >> tag) {
+        if (tag[0] == 'W') h.width = atoi(tag.c_str() + 1);
+        else if (tag[0] == 'H') h.height = atoi(tag.c_str() + 1);
+        else if (tag[0] == 'C') chroma = tag.substr(1);
+        else if (tag == "XCOLORRANGE=FULL") h.fullRange = true;
+    }
+    if (h.width <= 0 || h.height <= 0) {
+        error = "Y4M sem largura ou altura";
+        return false;
+    }
+    h.mono = chroma == "mono";
+    h.chromaShiftX = h.chromaShiftY = 0;
+    if (chroma == "420jpeg" || chroma == "420paldv" || chroma == "420mpeg2" || chroma == "420") {
+        h.chromaShiftX = h.chromaShiftY = 1;
+    } else if (chroma == "422") {
+        h.chromaShiftX = 1;
+    } else if (chroma != "444" && !h.mono) {
+        error = "croma Y4M sem suporte: C" + chroma + " (só 8 bits 420, 422, 444 e mono)";
+        return false;
+    }
+    h.line = line;
+    return true;
+}
+
+// Coeficientes BT.601 em ponto fixo (16 bits de fração)
+struct YCbCrMatrix {
+    int yOffset, yScale;           // Y -> RGB
+    int crR, cbG, crG, cbB;
+    int toY[3], toCb[3], toCr[3];  // RGB -> YCbCr
+};
+
+inline const YCbCrMatrix &ycbcrMatrix(bool fullRange) {
+    static const YCbCrMatrix limited = { 16, 76309, 104597, 25675, 53279, 132201,
+                                         { 16829, 33039, 6416 }, { -9714, -19070, 28784 }, { 28784, -24103, -4681 } };
+    static const YCbCrMatrix full = { 0, 65536, 91881, 22554, 46802, 116130,
+                                      { 19595, 38470, 7471 }, { -11059, -21709, 32768 }, { 32768, -27439, -5329 } };
+    return fullRange ? full : limited;
+}
+
+// Planos Y, Cb, Cr -> RGB intercalado
+inline void y4mToRGB(const Y4MHeader &h, const unsigned char *planes, const ImageView &rgb) {
+    const YCbCrMatrix &m = ycbcrMatrix(h.fullRange);
+    const unsigned char *Y = planes;
+    const unsigned char *Cb = planes + (size_t)h.width * h.height;
+    const unsigned char *Cr = Cb + (size_t)h.chromaWidth() * h.chromaHeight();
+    for (int y = 0; y < h.height; y++) {
+        const unsigned char *ly = Y + (size_t)y * h.width;
+        unsigned char *out = rgb.row(y);
+        if (h.mono) {
+            for (int x = 0; x < h.width; x++) {
+                unsigned char v = clampByte(((ly[x] - m.yOffset) * m.yScale + 32768) >> 16);
+                out[3 * x] = out[3 * x + 1] = out[3 * x + 2] = v;
+            }
+            continue;
+        }
+        size_t c0 = (size_t)(y >> h.chromaShiftY) * h.chromaWidth();
+        for (int x = 0; x < h.width; x++) {
+            int l = (ly[x] - m.yOffset) * m.yScale + 32768;
+            int cb = Cb[c0 + (x >> h.chromaShiftX)] - 128, cr = Cr[c0 + (x >> h.chromaShiftX)] - 128;
+            out[3 * x] = clampByte((l + m.crR * cr) >> 16);
+            out[3 * x + 1] = clampByte((l - m.cbG * cb - m.crG * cr) >> 16);
+            out[3 * x + 2] = clampByte((l + m.cbB * cb) >> 16);
+        }
+    }
+}
+
+// Média arredondada de n valores com 16 bits de fração (soma com sinal)
+inline int blockMean16(long long sum, int n) {
+    long long d = (long long)n << 16, v = sum + d / 2;
+    return (int)(v >= 0 ? v / d : -((-v + d - 1) / d));
+}
+
+// RGB intercalado -> planos; a croma é a média do bloco
+inline void rgbToY4M(const Y4MHeader &h, const ImageView &rgb, unsigned char *planes) {
+    const YCbCrMatrix &m = ycbcrMatrix(h.fullRange);
+    unsigned char *Y = planes;
+    for (int y = 0; y < h.height; y++) {
+        const unsigned char *in = rgb.row(y);
+        unsigned char *ly = Y + (size_t)y * h.width;
+        for (int x = 0; x < h.width; x++) {
+            int v = m.toY[0] * in[3 * x] + m.toY[1] * in[3 * x + 1] + m.toY[2] * in[3 * x + 2];
+            ly[x] = clampByte(((v + 32768) >> 16) + m.yOffset);
+        }
+    }
+    if (h.mono) return;
+    int cw = h.chromaWidth(), ch = h.chromaHeight();
+    unsigned char *Cb = planes + (size_t)h.width * h.height, *Cr = Cb + (size_t)cw * ch;
+    for (int cy = 0; cy < ch; cy++) {
+        int y0 = cy << h.chromaShiftY, y1 = (y0 + (1 << h.chromaShiftY)) < h.height ? y0 + (1 << h.chromaShiftY) : h.height;
+        for (int cx = 0; cx < cw; cx++) {
+            int x0 = cx << h.chromaShiftX, x1 = (x0 + (1 << h.chromaShiftX)) < h.width ? x0 + (1 << h.chromaShiftX) : h.width;
+            int sum[3] = { 0, 0, 0 }, n = (y1 - y0) * (x1 - x0);
+            for (int y = y0; y < y1; y++) {
+                const unsigned char *in = rgb.row(y);
+                for (int x = x0; x < x1; x++) {
+                    for (int c = 0; c < 3; c++) sum[c] += in[3 * x + c];
+                }
+            }
+            int cb = 0, cr = 0;
+            for (int c = 0; c < 3; c++) {
+                cb += m.toCb[c] * sum[c];
+                cr += m.toCr[c] * sum[c];
+            }
+            Cb[(size_t)cy * cw + cx] = clampByte(blockMean16(cb, n) + 128);
+            Cr[(size_t)cy * cw + cx] = clampByte(blockMean16(cr, n) + 128);
+        }
+    }
+}
+
+/*------------------------------- Quadros -----------------------------------*/
+
+// Um buffer do conjunto fixo. raw tem os bytes do quadro como estão no
+// fluxo; rgb é a imagem de trabalho do Y4M (o P6 de 8 bits é filtrado
+// direto em raw).
+struct VideoFrame {
+    size_t index;
+    std::string header; // "FRAME..." do Y4M ou cabeçalho do P6
+    PPMHeader ppm;
+    std::vector<unsigned char> raw;
+    Image rgb;
+};
+
+// Cabeçalho do próximo P6, byte a byte (são poucos bytes). Devolve false no
+// fim do fluxo; error fica vazio se o fluxo só acabou.
+inline bool readP6FrameHeader(FILE *in, VideoFrame &frame, std::string &error) {
+    int c = getc(in);
+    while (c == ' ' || c == '\t' || c == '\r' || c == '\n') c = getc(in);
+    if (c == EOF) return false;
+    std::string text(1, (char)c);
+    text += (char)getc(in); // "P6"; os números começam depois
+    int fields = 0;
+    bool inNumber = false, inComment = false;
+    while (fields < 3 || inNumber) {
+        c = getc(in);
+        if (c == EOF || text.size() > 1024) {
+            error = "cabeçalho P6 truncado";
+            return false;
+        }
+        text += (char)c;
+        if (inComment) {
+            inComment = c != '\n';
+        } else if (c == '#') {
+            inComment = true;
+        } else if (c >= '0' && c <= '9') {
+            inNumber = true;
+        } else if (inNumber) {
+            inNumber = false;
+            if (++fields == 3) break;
+        }
+    }
+    // o espaço que fecha o maxval já é o separador dos dados
+    if (!parsePPMHeader((const unsigned char *)text.data(), text.size() + 1, frame.ppm) || frame.ppm.type != '6' ||
+        frame.ppm.dataOffset != text.size()) {
+        error = "cabeçalho P6 inválido";
+        return false;
+    }
+    frame.header = text;
+    return true;
+}
+
+// Quadro P6 no lugar: 16 bits viram amostras 0..65535 na ordem da máquina
+// (e voltam depois), 8 bits são filtrados direto
+inline ImageView p6FrameView(VideoFrame &frame) {
+    int depth = pnmBytesPerSample(frame.ppm.maxValue);
+    return ImageView::interleaved(frame.raw.data(), frame.ppm.width, frame.ppm.height, 3, 0, depth);
+}
+
+// Os quadros prontos chegam fora de ordem; pop devolve sempre o próximo
+class FrameReorder {
+public:
+    FrameReorder() : next(0), closed(false) {}
+
+    void push(VideoFrame *frame) {
+        std::lock_guard<std::mutex> lock(mutex);
+        done[frame->index] = frame;
+        ready.notify_one();
+    }
+
+    // false quando fechado e sem o próximo quadro
+    bool pop(VideoFrame *&frame) {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this] { return closed || (!done.empty() && done.begin()->first == next); });
+        if (done.empty() || done.begin()->first != next) return false;
+        frame = done.begin()->second;
+        done.erase(done.begin());
+        next++;
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        ready.notify_all();
+    }
+
+private:
+    std::map<size_t, VideoFrame *> done;
+    size_t next;
+    bool closed;
+    std::mutex mutex;
+    std::condition_variable ready;
+};
+
+/*------------------------------- Execução ----------------------------------*/
+
+inline bool readBytes(FILE *in, unsigned char *p, size_t n) { return fread(p, 1, n, in) == n; }
+inline bool writeBytes(FILE *out, const void *p, size_t n) { return fwrite(p, 1, n, out) == n; }
+
+// Lê quadros de in até o fim, filtra e grava em out. O formato é detectado
+// pelos primeiros bytes ("YUV4MPEG2" ou "P6"); mensagens vão para stderr,
+// já que out costuma ser o stdout.
+inline VideoStats runVideo(FILE *in, FILE *out, const FilterPipeline &pipeline, const VideoOptions &options) {
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point t0 = Clock::now();
+    VideoStats stats = { 0, 0.0, false };
+
+    int first = getc(in);
+    if (first == EOF) {
+        fprintf(stderr, "Fluxo de vídeo vazio\n");
+        return stats;
+    }
+    ungetc(first, in);
+    VideoFormat format = first == 'Y' ? VIDEO_Y4M : VIDEO_P6;
+    Y4MHeader y4m;
+    std::string error;
+    if (format == VIDEO_Y4M) {
+        char line[1024];
+        if (!fgets(line, sizeof(line), in) || !parseY4MHeader(std::string(line, strcspn(line, "\n")), y4m, error)) {
+            fprintf(stderr, "Cabeçalho Y4M inválido: %s\n", error.c_str());
+            return stats;
+        }
+        if (!writeBytes(out, y4m.line.data(), y4m.line.size()) || !writeBytes(out, "\n", 1)) return stats;
+    } else if (first != 'P') {
+        fprintf(stderr, "Fluxo não é Y4M nem P6\n");
+        return stats;
+    }
+
+    unsigned workers = options.workers ? options.workers : 1;
+    size_t poolSize = workers + 2 * options.queueDepth;
+    std::vector<std::unique_ptr<VideoFrame>> pool;
+    BlockingQueue<VideoFrame *> idle(poolSize), loaded(poolSize);
+    FrameReorder filtered;
+    for (size_t i = 0; i < poolSize; i++) {
+        pool.emplace_back(new VideoFrame);
+        idle.push(pool.back().get());
+    }
+    bool readOk = true, writeOk = true;
+
+    std::thread reader([&] {
+        VideoFrame *frame;
+        for (size_t index = 0; idle.pop(frame); index++) {
+            std::string frameError;
+            bool got;
+            if (format == VIDEO_Y4M) {
+                char line[1024];
+                got = fgets(line, sizeof(line), in) != NULL;
+                if (got && strncmp(line, "FRAME", 5) != 0) frameError = "quadro Y4M sem FRAME";
+                if (got) frame->header = line;
+                frame->raw.resize(y4m.frameBytes());
+            } else {
+                got = readP6FrameHeader(in, *frame, frameError);
+                if (got) {
+                    frame->raw.resize((size_t)frame->ppm.width * frame->ppm.height * 3 *
+                                      pnmBytesPerSample(frame->ppm.maxValue));
+                }
+            }
+            if (got && frameError.empty() && !readBytes(in, frame->raw.data(), frame->raw.size())) {
+                frameError = "quadro truncado";
+            }
+            if (!frameError.empty()) {
+                fprintf(stderr, "Quadro %zu: %s\n", index, frameError.c_str());
+                readOk = false;
+            }
+            if (!got || !frameError.empty()) break;
+            frame->index = index;
+            loaded.push(frame);
+        }
+        loaded.close();
+    });
+
+    std::vector<std::thread> filters;
+    for (unsigned t = 0; t < workers; t++) {
+        filters.emplace_back([&] {
+            // o paralelismo é entre quadros; dentro do quadro, uma thread
+            RowExecutor executor(1);
+            VideoFrame *frame;
+            while (loaded.pop(frame)) {
+                if (format == VIDEO_Y4M) {
+                    frame->rgb.allocate(y4m.width, y4m.height, 3, LAYOUT_INTERLEAVED);
+                    y4mToRGB(y4m, frame->raw.data(), frame->rgb.view());
+                    pipeline.run(executor, frame->rgb.view());
+                    rgbToY4M(y4m, frame->rgb.view(), frame->raw.data());
+                } else {
+                    ImageView view = p6FrameView(*frame);
+                    size_t samples = (size_t)view.width * view.height * 3;
+                    if (view.wide()) widenSamples((uint16_t *)view.data, samples, frame->ppm.maxValue);
+                    pipeline.run(executor, view);
+                    if (view.wide()) {
+                        uint16_t *p = (uint16_t *)view.data;
+                        for (size_t i = 0; i < samples; i++) p[i] = narrowSample(p[i], frame->ppm.maxValue);
+                        if (hostIsLittleEndian()) swapBytes16(p, samples);
+                    }
+                }
+                filtered.push(frame);
+            }
+        });
+    }
+
+    std::thread writer([&] {
+        VideoFrame *frame;
+        while (filtered.pop(frame)) {
+            if (writeOk) {
+                writeOk = writeBytes(out, frame->header.data(), frame->header.size()) &&
+                          writeBytes(out, frame->raw.data(), frame->raw.size()) && fflush(out) == 0;
+                if (!writeOk) {
+                    fprintf(stderr, "Erro ao gravar o quadro %zu\n", frame->index);
+                    idle.close(); // a leitura para no próximo quadro
+                }
+                stats.frames += writeOk;
+            }
+            idle.push(frame);
+        }
+    });
+
+    reader.join();
+    for (std::thread &t : filters) t.join();
+    filtered.close();
+    writer.join();
+    stats.ok = readOk && writeOk;
+    stats.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    return stats;
+}
+
+#endif /* Video_h */
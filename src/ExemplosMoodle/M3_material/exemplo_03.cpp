@@ -4,67 +4,188 @@
 #include <stdlib.h>
 #include <fstream>
 #include <sstream>
-#include <math.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "Batch.h"
+#include "GLFilters.h"
+#include "Matte.h"
+#include "PNG.h"
+#include "PPM.h"
+#include "Pipeline.h"
+#include "Resize.h"
+#include "Stream.h"
+#include "Video.h"
 
 using namespace std;
 
-unsigned char *open(string file, int &width, int &height) {
-    ifstream arq(file);
-    char BUFFER[1024];
-    arq.getline(BUFFER, 1024);
-    char type = BUFFER[1];
-    cout << BUFFER << endl;
-    do {
-        arq.getline(BUFFER, 1024);
-        cout << "." << BUFFER << "." << endl;
-    } while (BUFFER[0] == '#');
-    stringstream sstr(BUFFER);
-    int w;
-    int h;
-    sstr >> w;
-    sstr >> h;
-    width = w;
-    height = h;
-    int maxValue;
-    arq >> maxValue;
-    cout << w << " X " << h << " mv: " << maxValue << endl; 
-    unsigned char *data = new unsigned char [w * h * 3];
-    if (type == '3') {
-        // modo texto
-        int j=0;
-        while (!arq.eof()) {
-            int g;
-            arq >> g;
-            data[j++] = (unsigned char)g;
-        }
-    } else { 
-        // modo binário
-        arq.read(reinterpret_cast<char*> (&data), sizeof(data));
-    }
-    arq.close();
-    return data;
+// Faixas de linhas em paralelo; número de threads via --threads N
+RowExecutor executor;
+
+// Carrega P2/P3/P5/P6. Nos formatos binários os pixels ficam no arquivo
+// mapeado em memória (sem cópia); tons de cinza viram RGB para os filtros.
+bool open(string file, PPMImage &image) {
+    if (!image.load(file)) {
+        return false;
+    }
+    cout << "P" << image.type << " " << image.width << " X " << image.height << " mv: " << image.maxValue << endl;
+    image.toRGB();
+    return true;
+}
+
+// Mantém o formato da entrada: P6 binário em um único write, ou P3 texto,
+// com o mesmo valor máximo (16 bits se a entrada for de 16 bits).
+bool save(string file, unsigned char *data, int &w, int &h, bool binary, int maxValue) {
+    if (binary) {
+        return savePPMBinary(file, data, w, h, 3, "Gerado por chroma-key.", maxValue);
+    }
+    return savePPMText(file, data, w, h, 3, "Gerado por chroma-key.", maxValue);
+}
+
+// Carrega qualquer imagem como RGBA de 8 bits: PNM pelo PPMImage (16 bits
+// reduzidos a 8), o resto (PNG, JPG...) pela stb_image.
+bool loadRGBA(const string &file, vector<unsigned char> &rgba, int &w, int &h) {
+    if (isPNMPath(file)) {
+        PPMImage image;
+        if (!image.load(file)) return false;
+        image.toRGB();
+        w = image.width;
+        h = image.height;
+        size_t n = (size_t)w * h;
+        vector<unsigned char> rgb;
+        const unsigned char *src = image.data;
+        if (image.bytesPerSample() == 2) {
+            rgb.resize(n * 3);
+            for (size_t i = 0; i < n * 3; i++) rgb[i] = (unsigned char)narrowSample(image.samples16()[i], 255);
+            src = rgb.data();
+        }
+        rgba.resize(n * 4);
+        rgbToRgba(src, n, rgba.data());
+        return true;
+    }
+    int n;
+    unsigned char *pixels = stbi_load(file.c_str(), &w, &h, &n, 4);
+    if (!pixels) return false;
+    rgba.assign(pixels, pixels + (size_t)w * h * 4);
+    stbi_image_free(pixels);
+    return true;
+}
+
+// Grava DIR/<nome da entrada><sufixo> como PNG RGBA, PAM RGBA (--format pam)
+// ou P6 sem o alfa (--format p6)
+bool saveRGBA(const string &outDir, const string &file, const string &suffix, const unsigned char *rgba,
+              int w, int h, const string &format) {
+    string out = (filesystem::path(outDir) / filesystem::path(file).stem()).string() + suffix;
+    bool ok;
+    if (format == "pam") {
+        out += ".pam";
+        ok = savePAM(out, rgba, w, h, 4, "Gerado por chroma-key.");
+    } else if (format == "p6") {
+        out += ".ppm";
+        vector<unsigned char> rgb((size_t)w * h * 3);
+        for (size_t i = 0; i < (size_t)w * h; i++) memcpy(&rgb[3 * i], rgba + 4 * i, 3);
+        ok = savePPMBinary(out, rgb.data(), w, h, 3, "Gerado por chroma-key.");
+    } else {
+        out += ".png";
+        ok = savePNG(out, rgba, w, h, 4);
+    }
+    cout << (ok ? "" : "Erro ao gravar ") << out << " (" << w << " X " << h << ")" << endl;
+    return ok;
 }
 
-void save(string file, unsigned char *data, int &w, int &h) {
-    ofstream arq(file);
-    arq << "P3" << endl;
-    arq << "#Gerado por chroma-key." << endl;
-    arq << w << " " << h << endl << "255" << endl;
-    int length = w * h * 3;
-    for (int i = 0; i < length; i++) {
-        arq << (int)data[i] << endl;
-    }    
-    arq.close();
+// --matte R,G,B[,interno,externo[,despill]]: recorte suave em YCbCr com alfa
+int runMatte(const BatchOptions &batch, const string &spec, const string &format) {
+    vector<double> v;
+    if (!parseNumbers(spec, 3, v) && !parseNumbers(spec, 5, v) && !parseNumbers(spec, 6, v)) {
+        cout << "Matte inválido: " << spec << endl;
+        return EXIT_FAILURE;
+    }
+    MatteOptions options;
+    options.r = (int)v[0];
+    options.g = (int)v[1];
+    options.b = (int)v[2];
+    if (v.size() >= 5) {
+        options.inner = v[3];
+        options.outer = v[4];
+    }
+    if (v.size() == 6) options.despill = v[5] != 0;
+    if (options.outer <= options.inner) {
+        cout << "Tolerância externa precisa ser maior que a interna" << endl;
+        return EXIT_FAILURE;
+    }
+
+    error_code ec;
+    filesystem::create_directories(batch.outDir, ec);
+    size_t failed = 0;
+    for (const string &file : batch.inputs) {
+        vector<unsigned char> rgba;
+        int w, h;
+        if (!loadRGBA(file, rgba, w, h)) {
+            cout << "Erro ao ler " << file << endl;
+            failed++;
+            continue;
+        }
+        softMatte(executor, rgba.data(), w, h, options);
+        if (!saveRGBA(batch.outDir, file, "", rgba.data(), w, h, format)) failed++;
+    }
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
-double dist(int &r1, int &g1, int &b1, int &r2, int &g2, int &b2) {
-    double r = r1 - r2;
-    double g = g1 - g2;
-    double b = b1 - b2;
-    return sqrt(r*r + g*g + b*b);
+// --resize L,A[,box|bilinear|lanczos] (0 em L ou A mantém a proporção) e/ou
+// --mips (níveis até 1x1 em <nome>_mipN); gamma = false filtra os valores
+// gravados em vez da luz linear
+int runResize(const BatchOptions &batch, const string &spec, bool mips, bool gamma, const string &format) {
+    int rw = 0, rh = 0;
+    ResizeFilter filter = RESIZE_LANCZOS;
+    if (!spec.empty()) {
+        vector<string> parts = splitString(spec, ',');
+        vector<double> v;
+        if (parts.size() < 2 || parts.size() > 3 || !parseNumbers(parts[0] + "," + parts[1], 2, v) ||
+            v[0] < 0 || v[1] < 0 || (v[0] < 1 && v[1] < 1) ||
+            (parts.size() == 3 && !parseResizeFilter(parts[2], filter))) {
+            cout << "Tamanho inválido: " << spec << " (L,A[,box|bilinear|lanczos])" << endl;
+            return EXIT_FAILURE;
+        }
+        rw = (int)v[0];
+        rh = (int)v[1];
+    }
+
+    error_code ec;
+    filesystem::create_directories(batch.outDir, ec);
+    size_t failed = 0;
+    for (const string &file : batch.inputs) {
+        vector<unsigned char> rgba;
+        int w, h;
+        if (!loadRGBA(file, rgba, w, h)) {
+            cout << "Erro ao ler " << file << endl;
+            failed++;
+            continue;
+        }
+        if (!spec.empty()) {
+            int dw = rw > 0 ? rw : max(1, (int)((double)w * rh / h + 0.5));
+            int dh = rh > 0 ? rh : max(1, (int)((double)h * rw / w + 0.5));
+            vector<unsigned char> resized((size_t)dw * dh * 4);
+            resizeImage(rgba.data(), w, h, resized.data(), dw, dh, 4, filter, gamma, &executor.threadPool());
+            rgba.swap(resized);
+            w = dw;
+            h = dh;
+            if (!saveRGBA(batch.outDir, file, "", rgba.data(), w, h, format)) failed++;
+        }
+        if (mips) {
+            vector<MipLevel> levels = buildMipChain(rgba.data(), w, h, 4, gamma);
+            for (size_t i = 0; i < levels.size(); i++) {
+                MipLevel &l = levels[i];
+                if (!saveRGBA(batch.outDir, file, "_mip" + to_string(i + 1), l.pixels.data(), l.width, l.height, format)) failed++;
+            }
+        }
+    }
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
-void chromaKey(unsigned char *data, int w, int h) {
+// Perguntas do modo interativo: cada uma devolve a operação configurada
+
+FilterOp chromaKey() {
     int r, g, b;
     cout << "Cor-chave: " << endl;
     cout << "\tR: ";
@@ -77,48 +198,19 @@ void chromaKey(unsigned char *data, int w, int h) {
     cout << "% Tolerência (0..1): ";
     double t;
     cin >> t;
-    
 
-    double dmax = 441.6729559301;
-
-    int length = w * h * 3;
-    for (int i = 0; i < length; i += 3) {
-        int ri = data[i] & 0xff;
-        int gi = data[i+1] & 0xff;
-        int bi = data[i+2] & 0xff;
-        double d = dist(r, g, b, ri, gi, bi);
-        if (d/dmax < t) {
-            data[i] = 0;
-            data[i+1] = 0;
-            data[i+2] = 0;
-        }
-    }
+    // d/dmax < t comparado em distância inteira ao quadrado, sem sqrt
+    return chromaKeyOp(clampInt(r, 0, 255), clampInt(g, 0, 255), clampInt(b, 0, 255), t);
 }
 
-void grayScale(unsigned char *data, int w, int h) {
+FilterOp grayScale() {
     cout << "Média aritmética (S) ou ponderada? ";
     char op;
     cin >> op;
-    double rw, gw, bw;
-    if ((op == 'S') || (op == 's')) {
-        rw = gw = bw = 1.0/3.0;
-    } else {
-        rw = 0.2125; 
-        gw = 0.7154;
-        bw = 0.0721;
-    }
-
-    int length = w * h * 3;
-    for (int i = 0; i < length; i += 3) {
-        int ri = data[i] & 0xff;
-        int gi = data[i+1] & 0xff;
-        int bi = data[i+2] & 0xff;
-
-        data[i] = data[i+1] = data[i+2] = (int)(ri * rw + gi * gw + bi * bw);
-    }
+    return grayScaleOp(((op == 'S') || (op == 's')) ? grayWeightsAverage() : grayWeightsLuma());
 }
 
-void colorize(unsigned char *data, int w, int h) {
+FilterOp colorize() {
     int r, g, b;
     cout << "Cor de base: " << endl;
     cout << "\tR: ";
@@ -127,61 +219,205 @@ void colorize(unsigned char *data, int w, int h) {
     cin >> g;
     cout << "\tB: ";
     cin >> b;
-    
-    int length = w * h * 3;
-    for (int i = 0; i < length; i += 3) {
-        int ri = data[i] & 0xff;
-        int gi = data[i+1] & 0xff;
-        int bi = data[i+2] & 0xff;
+    return colorizeOp(clampInt(r, 0, 255), clampInt(g, 0, 255), clampInt(b, 0, 255));
+}
 
-        data[i]   = ri | r;
-        data[i+1] = gi | g;
-        data[i+2] = bi | b;
+// uso: exemplo_03 [--threads N] [--gl] [--region X,Y,L,A] ["chroma:0,255,0,0.2 | gray:weighted | negative"]
+//      exemplo_03 [--threads N] [--gl] --in ARQ|DIR [--in ...] [--list LISTA.txt] --out DIR
+//                 [--format keep|p6|p3] [--stream [--strip LINHAS]] "filtros"
+//      exemplo_03 [--threads N] --video "filtros" < ENTRADA.y4m > SAIDA.y4m
+//      exemplo_03 [--threads N] --in ARQ|DIR --out DIR --matte R,G,B[,INT,EXT[,DESPILL]] [--format pam|p6]
+//      exemplo_03 [--threads N] --in ARQ|DIR --out DIR [--resize L,A[,FILTRO]] [--mips] [--linear] [--format pam|p6]
+// Sem a lista de filtros, pergunta um filtro pelo terminal. Com --in/--list
+// roda em lote, sem perguntas. --stream processa cada imagem em faixas de
+// LINHAS linhas, sem carregá-la inteira (para imagens maiores que a memória).
+// --region aplica os filtros só no retângulo (sem copiar o recorte).
+// --video filtra um fluxo de quadros Y4M ou P6 concatenados do stdin para
+// o stdout, no mesmo formato, com N quadros filtrados ao mesmo tempo.
+// --gl roda os filtros ponto a ponto num fragment shader (GLFilters.h);
+// sem contexto OpenGL, ou com filtros de vizinhança, fica tudo na CPU.
+// --matte troca os filtros por um recorte suave com alfa (PNG ou PAM RGBA);
+// INT e EXT são as distâncias a partir da cor-chave (0..1, no plano CbCr)
+// onde o alfa começa e termina a rampa.
+// --resize reamostra (box, bilinear ou lanczos, o padrão) e --mips grava a
+// cadeia de mipmaps; os dois filtram em luz linear, a não ser com --linear.
+int main(int argc, char **argv) {
+    string file;
+    string spec;
+    BatchOptions batch;
+    bool batchMode = false;
+    bool streamMode = false;
+    int stripRows = 0;
+    string region;
+    string matte;
+    string resize;
+    string format;
+    bool mips = false;
+    bool gamma = true;
+    bool useGL = false;
+    bool videoMode = false;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--threads" && hasValue) {
+            executor.setThreads((unsigned)atoi(argv[++i]));
+        } else if (arg == "--in" && hasValue) {
+            batchMode = true;
+            if (!addBatchInput(argv[++i], batch.inputs)) {
+                cout << "Entrada não encontrada: " << argv[i] << endl;
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--list" && hasValue) {
+            batchMode = true;
+            if (!addBatchList(argv[++i], batch.inputs)) {
+                cout << "Lista não encontrada: " << argv[i] << endl;
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--out" && hasValue) {
+            batch.outDir = argv[++i];
+        } else if (arg == "--format" && hasValue) {
+            format = argv[++i];
+            batch.format = format == "p6" ? BATCH_BINARY : format == "p3" ? BATCH_TEXT : BATCH_KEEP;
+        } else if (arg == "--region" && hasValue) {
+            region = argv[++i];
+        } else if (arg == "--matte" && hasValue) {
+            matte = argv[++i];
+        } else if (arg == "--resize" && hasValue) {
+            resize = argv[++i];
+        } else if (arg == "--mips") {
+            mips = true;
+        } else if (arg == "--linear") {
+            gamma = false;
+        } else if (arg == "--video") {
+            videoMode = true;
+        } else if (arg == "--gl") {
+            useGL = true;
+        } else if (arg == "--stream") {
+            streamMode = true;
+        } else if (arg == "--strip" && hasValue) {
+            stripRows = atoi(argv[++i]);
+        } else {
+            spec += (spec.empty() ? "" : " ") + arg;
+        }
+    }
+
+    if (!matte.empty()) {
+        if (batch.inputs.empty() || batch.outDir.empty()) {
+            cout << "--matte precisa de --in e --out DIR" << endl;
+            return EXIT_FAILURE;
+        }
+        return runMatte(batch, matte, format);
+    }
+    if (!resize.empty() || mips) {
+        if (batch.inputs.empty() || batch.outDir.empty()) {
+            cout << "--resize/--mips precisam de --in e --out DIR" << endl;
+            return EXIT_FAILURE;
+        }
+        return runResize(batch, resize, mips, gamma, format);
     }
-}
 
-void negative(unsigned char *data, int w, int h) {
-    int length = w * h * 3;
-    for (int i = 0; i < length; i += 3) {
-        int ri = data[i] & 0xff;
-        int gi = data[i+1] & 0xff;
-        int bi = data[i+2] & 0xff;
+    FilterPipeline pipeline;
+    string error;
+    if (!spec.empty() && !pipeline.parse(spec, error)) {
+        cout << "Filtros inválidos: " << error << endl;
+        return EXIT_FAILURE;
+    }
 
-        data[i]   = ri ^ 255;
-        data[i+1] = gi ^ 255;
-        data[i+2] = bi ^ 255;
+    // o stdout leva os quadros: mensagens só no stderr
+    if (videoMode) {
+        if (pipeline.empty()) {
+            cerr << "--video precisa da lista de filtros" << endl;
+            return EXIT_FAILURE;
+        }
+        VideoOptions video;
+        video.workers = executor.threads();
+        cerr << "Vídeo, filtros: " << pipeline.describe() << ", SIMD: " << simdLevelName(activeSimdLevel())
+             << ", quadros em paralelo: " << video.workers << endl;
+        VideoStats stats = runVideo(stdin, stdout, pipeline, video);
+        cerr << stats.frames << " quadros, " << stats.seconds << " s ("
+             << (stats.seconds > 0 ? stats.frames / stats.seconds : 0.0) << " quadros/s)" << endl;
+        return stats.ok ? EXIT_SUCCESS : EXIT_FAILURE;
     }
-}
 
-int main() {
-    string file;
+    GLFilterBackend gl;
+    if (useGL) {
+        if (gl.init(error)) {
+            cout << "OpenGL: " << gl.renderer() << endl;
+        } else {
+            cout << "OpenGL indisponível (" << error << "), usando a CPU" << endl;
+        }
+        if (gl.ready() && streamMode) cout << "--stream roda na CPU" << endl;
+    }
+
+    if (batchMode) {
+        if (pipeline.empty() || batch.outDir.empty()) {
+            cout << "Modo lote precisa de --out DIR e da lista de filtros" << endl;
+            return EXIT_FAILURE;
+        }
+        if (streamMode && pipeline.needsWholeImage()) {
+            cout << "quantize precisa da imagem inteira e não roda com --stream" << endl;
+            return EXIT_FAILURE;
+        }
+        cout << batch.inputs.size() << " imagens, filtros: " << pipeline.describe()
+             << ", SIMD: " << simdLevelName(activeSimdLevel()) << ", threads: " << executor.threads() << endl;
+        if (gl.ready()) {
+            // runFilters já cai para a CPU (e avisa o erro) se a GPU falhar
+            batch.offload = [&](const ImageView &view) {
+                runFilters(&gl, pipeline, executor, view);
+                return true;
+            };
+        }
+        BatchStats stats = streamMode ? runStreamBatch(batch, pipeline, executor, stripRows)
+                                      : runBatch(batch, pipeline, executor);
+        cout << stats.done << " gravadas, " << stats.failed << " com erro, " << stats.seconds << " s ("
+             << (stats.seconds > 0 ? stats.megapixels / stats.seconds : 0.0) << " MP/s)" << endl;
+        return stats.failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
     
     // AQUI PRA LER DO USUÁRIO O NOME DO ARQUIVO
     // cout << "Digite caminho para o arquivo da imagem de entrada: ";
     // getline(cin, file);
     file = "../src/ExemplosMoodle/M3_material/M3_exemplo1.ppm";
 
-    int w, h;
-    unsigned char *data = open(file, w, h);
+    PPMImage image;
+    if (!open(file, image)) {
+        return EXIT_FAILURE;
+    }
+    int w = image.width, h = image.height;
+    unsigned char *data = image.data;
     // cout << ((int)data[0]) << "..." << ((int)data[w * h * 3 - 1]) << endl;
+    cout << "SIMD: " << simdLevelName(activeSimdLevel()) << ", threads: " << executor.threads() << endl;
 
+    if (pipeline.empty()) {
+        int opt;
+        cout << "Qual opção de filtro você quer aplicar (1-chroma-key, 2-gray-scale, 3-colorize, 4-negative)? ";
+        cin >> opt;
 
-    int opt;
-    cout << "Qual opção de filtro você quer aplicar (1-chroma-key, 2-gray-scale, 3-colorize, 4-negative)? ";
-    cin >> opt;
-
-    switch(opt) {
-        case 1:  chromaKey(data, w, h); break;
-        case 2:  grayScale(data, w, h); break;
-        case 3:  colorize(data, w, h);  break;
-        case 4:  negative(data, w, h);  break;
-        default: cout << "Opção inválida!!";
+        switch(opt) {
+            case 1:  pipeline.add(chromaKey()); break;
+            case 2:  pipeline.add(grayScale()); break;
+            case 3:  pipeline.add(colorize());  break;
+            case 4:  pipeline.add(negativeOp()); break;
+            default: cout << "Opção inválida!!";
+        }
     }
 
-    if ((opt > 0) && (opt < 5)){
-        save("../src/ExemplosMoodle/M3_material/output.ppm", data, w, h);
+    if (!pipeline.empty()) {
+        cout << "Filtros: " << pipeline.describe() << endl;
+        ImageView view = ImageView::interleaved(data, w, h, 3, 0, image.bytesPerSample());
+        if (!region.empty()) {
+            vector<double> r;
+            if (!parseNumbers(region, 4, r) || r[0] < 0 || r[1] < 0 || r[2] < 1 || r[3] < 1 ||
+                r[0] + r[2] > w || r[1] + r[3] > h) {
+                cout << "Região inválida: " << region << endl;
+                return EXIT_FAILURE;
+            }
+            view = view.region((int)r[0], (int)r[1], (int)r[2], (int)r[3]);
+        }
+        if (runFilters(&gl, pipeline, executor, view)) cout << "Filtros na GPU" << endl;
+        save("../src/ExemplosMoodle/M3_material/output.ppm", data, w, h, image.isBinary(), image.maxValue);
     }
     
-    delete [] data;
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,337 @@
+// BENCHMARK DOS FILTROS DE IMAGEM
+// Gera imagens sintéticas (ruído, gradiente e regiões chapadas sobre fundo
+// verde para o chroma) de 1 a 500 MP e mede cada filtro do exemplo_03,
+// pipelines encadeados, recorte com alfa, redimensionamento, mipmaps e a
+// E/S de PPM. Para cada item mostra o melhor tempo de N repetições em MB/s
+// (bytes de pixels), MP/s e ciclos por pixel (contador de ciclos do
+// processador, TSC).
+//
+// Os modos rodam as mesmas imagens, na mesma ordem, com a mesma semente:
+//   scalar  - caminho escalar, 1 thread
+//   simd    - SSE2/AVX2 (o melhor disponível), 1 thread
+//   threads - SIMD com todas as threads (ou --threads N)
+// e a última coluna é o ganho sobre o primeiro modo da lista. Os itens
+// lut:gather e lut:pshufb aplicam a mesma tabela por canal (Lut.h) com o
+// kernel AVX2 indicado; abaixo de AVX2 os dois são o escalar.
+//
+// Memória: cerca de 4x o tamanho da imagem em RGB (origem, cópia de
+// trabalho, rascunho dos filtros de vizinhança e a cópia RGBA do matte).
+//
+// uso: image_bench [--mp 1,16] [--pattern noise,gradient,flat] [--modes scalar,simd,threads]
+//                  [--threads N] [--reps N] [--filters "negative;gray | gamma:2.2;..."]
+//                  [--io DIR | --no-io] [--csv]
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <math.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Matte.h"
+#include "PPM.h"
+#include "Pipeline.h"
+#include "Resize.h"
+#include "Stream.h"
+
+#if CPU_X86 && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#endif
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+// Filtros medidos quando --filters não é dado
+static const char *DEFAULT_FILTERS[] = {
+    "negative", "gray", "gray:average", "chroma:0,255,0,0.2", "colorize:200,10,0", "gamma:2.2",
+    "levels:10,200,1.3", "autolevels", "equalize", "box:5", "box:50", "blur:2", "blur:20",
+    "unsharp:1.5,2,3", "sobel", "quantize:64", "quantize:16,median,fs",
+    "gray | gamma:2.2 | negative", "levels:10,200 | blur:2 | unsharp:1,1,0",
+    "chroma:0,255,0,0.2 | blur:1 | sobel"
+};
+
+// Itens que não são pipelines do exemplo_03
+static const char *EXTRA_ITEMS[] = { "matte", "resize:1/2,lanczos", "resize:1/2,box", "mips", "lut:gather", "lut:pshufb" };
+
+struct BenchMode {
+    string name;
+    SimdLevel simd;
+    unsigned threads;
+};
+
+struct BenchResult {
+    double seconds;
+    uint64_t cycles;
+};
+
+static uint64_t cycleCounter() {
+#if CPU_X86 && (defined(__GNUC__) || defined(__clang__))
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/*--------------------------- imagens sintéticas ----------------------------*/
+
+static uint64_t xorshift(uint64_t &s) {
+    s ^= s << 13;
+    s ^= s >> 7;
+    s ^= s << 17;
+    return s;
+}
+
+// Cada linha tem a própria semente: a imagem não depende das threads
+static void generateImage(RowExecutor &executor, const string &pattern, unsigned char *data, int w, int h) {
+    executor.forEachBand(h, (size_t)w * 3, [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++) {
+            unsigned char *p = data + (size_t)y * w * 3;
+            uint64_t s = 0x9e3779b97f4a7c15ull * (uint64_t)(y + 1) + 1;
+            if (pattern == "noise") {
+                for (int x = 0; x < w; x++) {
+                    uint64_t r = xorshift(s);
+                    p[3*x] = (unsigned char)r; p[3*x+1] = (unsigned char)(r >> 8); p[3*x+2] = (unsigned char)(r >> 16);
+                }
+            } else if (pattern == "gradient") {
+                for (int x = 0; x < w; x++) {
+                    p[3*x]   = (unsigned char)((int64_t)x * 255 / (w > 1 ? w - 1 : 1));
+                    p[3*x+1] = (unsigned char)((int64_t)y * 255 / (h > 1 ? h - 1 : 1));
+                    p[3*x+2] = (unsigned char)(((int64_t)x + y) * 255 / (w + h));
+                }
+            } else {
+                // fundo verde com um pouco de ruído e blocos de 64x64 de cor chapada
+                static const unsigned char colors[4][3] = { {200, 40, 40}, {240, 220, 200}, {30, 30, 160}, {90, 60, 30} };
+                for (int x = 0; x < w; x++) {
+                    uint32_t cell = (uint32_t)(x / 64) * 73856093u ^ (uint32_t)(y / 64) * 19349663u;
+                    if (cell % 3 == 0) {
+                        memcpy(p + 3 * x, colors[(cell / 3) % 4], 3);
+                    } else {
+                        uint64_t r = xorshift(s);
+                        p[3*x] = (unsigned char)(r & 7); p[3*x+1] = (unsigned char)(247 + ((r >> 8) & 7)); p[3*x+2] = (unsigned char)((r >> 16) & 7);
+                    }
+                }
+            }
+        }
+    });
+}
+
+/*--------------------------------- medição ---------------------------------*/
+
+// Melhor de reps execuções; setup (não medido) roda antes de cada uma
+template <typename Setup, typename Work>
+static BenchResult measure(int reps, Setup setup, Work work) {
+    BenchResult best = { 1e30, 0 };
+    for (int r = 0; r < reps; r++) {
+        setup();
+        Clock::time_point t0 = Clock::now();
+        uint64_t c0 = cycleCounter();
+        work();
+        uint64_t c1 = cycleCounter();
+        double s = chrono::duration<double>(Clock::now() - t0).count();
+        if (s < best.seconds) best = { s, c1 - c0 };
+    }
+    return best;
+}
+
+static bool csvOutput = false;
+
+static void report(const string &image, const string &item, const string &mode, size_t bytes, size_t pixels,
+                   const BenchResult &r, double baseSeconds) {
+    double mbs = bytes / r.seconds / 1e6, mps = pixels / r.seconds / 1e6;
+    double cpp = r.cycles ? (double)r.cycles / pixels : 0.0;
+    if (csvOutput) {
+        cout << image << ",\"" << item << "\"," << mode << "," << r.seconds * 1000 << "," << mbs << "," << mps << ","
+             << cpp << "," << (baseSeconds > 0 ? baseSeconds / r.seconds : 1.0) << endl;
+        return;
+    }
+    cout << left << setw(40) << item.substr(0, 39) << setw(9) << mode << right << fixed
+         << setw(10) << setprecision(2) << r.seconds * 1000 << " ms"
+         << setw(10) << setprecision(1) << mbs << " MB/s"
+         << setw(9) << setprecision(1) << mps << " MP/s"
+         << setw(8) << setprecision(2) << cpp << " c/px"
+         << setw(7) << setprecision(2) << (baseSeconds > 0 ? baseSeconds / r.seconds : 1.0) << "x" << endl;
+}
+
+static vector<string> splitList(const string &s, char sep) {
+    vector<string> out;
+    for (const string &part : splitString(s, sep)) {
+        if (!part.empty()) out.push_back(part);
+    }
+    return out;
+}
+
+static size_t fileSize(const string &path) {
+    ifstream f(path, ios::binary | ios::ate);
+    return f ? (size_t)f.tellg() : 0;
+}
+
+int main(int argc, char **argv) {
+    vector<double> megapixels = { 1, 16 };
+    vector<string> patterns = { "noise", "gradient", "flat" };
+    vector<string> modeNames = { "scalar", "simd", "threads" };
+    vector<string> items;
+    unsigned threads = 0;
+    int reps = 3;
+    string ioDir = ".";
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--mp" && hasValue) {
+            megapixels.clear();
+            for (const string &v : splitList(argv[++i], ',')) megapixels.push_back(atof(v.c_str()));
+        } else if (arg == "--pattern" && hasValue) {
+            patterns = splitList(argv[++i], ',');
+        } else if (arg == "--modes" && hasValue) {
+            modeNames = splitList(argv[++i], ',');
+        } else if (arg == "--threads" && hasValue) {
+            threads = (unsigned)atoi(argv[++i]);
+        } else if (arg == "--reps" && hasValue) {
+            reps = atoi(argv[++i]);
+        } else if (arg == "--filters" && hasValue) {
+            items = splitList(argv[++i], ';');
+        } else if (arg == "--io" && hasValue) {
+            ioDir = argv[++i];
+        } else if (arg == "--no-io") {
+            ioDir.clear();
+        } else if (arg == "--csv") {
+            csvOutput = true;
+        } else {
+            cout << "uso: image_bench [--mp 1,16] [--pattern noise,gradient,flat] [--modes scalar,simd,threads]" << endl
+                 << "                   [--threads N] [--reps N] [--filters \"f1;f2 | f3\"] [--io DIR | --no-io] [--csv]" << endl;
+            return EXIT_FAILURE;
+        }
+    }
+    if (items.empty()) {
+        items.assign(begin(DEFAULT_FILTERS), end(DEFAULT_FILTERS));
+        items.insert(items.end(), begin(EXTRA_ITEMS), end(EXTRA_ITEMS));
+    }
+    if (reps < 1) reps = 1;
+
+    SimdLevel best = detectSimdLevel();
+    vector<BenchMode> modes;
+    for (const string &m : modeNames) {
+        if (m == "scalar") modes.push_back({ m, SIMD_SCALAR, 1 });
+        else if (m == "simd") modes.push_back({ m, best, 1 });
+        else if (m == "threads") modes.push_back({ m, best, threads });
+        else {
+            cout << "Modo desconhecido: " << m << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // pipelines interpretados uma vez; itens extras ficam com pipeline vazio
+    vector<FilterPipeline> pipelines(items.size());
+    for (size_t i = 0; i < items.size(); i++) {
+        bool extra = items[i] == "matte" || items[i] == "mips" || items[i].compare(0, 7, "resize:") == 0 ||
+                     items[i] == "lut:gather" || items[i] == "lut:pshufb";
+        string error;
+        if (!extra && !pipelines[i].parse(items[i], error)) {
+            cout << "Filtros inválidos: " << error << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    RowExecutor executor(threads);
+    if (csvOutput) cout << "imagem,item,modo,ms,MB/s,MP/s,ciclos/px,ganho" << endl;
+    else cout << "SIMD disponível: " << simdLevelName(best) << ", threads: " << executor.threads()
+              << ", repetições: " << reps << endl;
+
+    for (double mp : megapixels) {
+        size_t pixels = (size_t)(mp * 1e6);
+        int w = (int)sqrt(pixels * 4.0 / 3.0), h = (int)(pixels / (size_t)(w > 0 ? w : 1));
+        if (w < 1 || h < 1) continue;
+        pixels = (size_t)w * h;
+        size_t bytes = pixels * 3;
+        vector<unsigned char> source(bytes), work(bytes), rgba;
+
+        for (const string &pattern : patterns) {
+            executor.setThreads(threads);
+            generateImage(executor, pattern, source.data(), w, h);
+            string image = pattern + " " + to_string(w) + "x" + to_string(h);
+            if (!csvOutput) cout << endl << "== " << image << " (" << setprecision(1) << fixed << pixels / 1e6 << " MP) ==" << endl;
+
+            for (size_t i = 0; i < items.size(); i++) {
+                const string &item = items[i];
+                double baseSeconds = 0;
+                for (size_t m = 0; m < modes.size(); m++) {
+                    setSimdLevel(modes[m].simd);
+                    executor.setThreads(modes[m].threads);
+                    BenchResult r;
+                    size_t itemBytes = bytes;
+                    if (item == "matte") {
+                        MatteOptions options;
+                        itemBytes = pixels * 4;
+                        r = measure(reps, [&] {
+                            rgba.resize(pixels * 4);
+                            rgbToRgba(source.data(), pixels, rgba.data());
+                        }, [&] { softMatte(executor, rgba.data(), w, h, options); });
+                    } else if (item.compare(0, 7, "resize:") == 0) {
+                        ResizeFilter filter = RESIZE_LANCZOS;
+                        size_t comma = item.find(',');
+                        if (comma != string::npos && !parseResizeFilter(item.substr(comma + 1), filter)) {
+                            cout << "Filtro de redimensionamento inválido: " << item << endl;
+                            return EXIT_FAILURE;
+                        }
+                        int dw = w / 2 > 0 ? w / 2 : 1, dh = h / 2 > 0 ? h / 2 : 1;
+                        r = measure(reps, [] {}, [&] {
+                            resizeImage(source.data(), w, h, work.data(), dw, dh, 3, filter, true, &executor.threadPool());
+                        });
+                    } else if (item == "mips") {
+                        r = measure(reps, [] {}, [&] { buildMipChain(source.data(), w, h, 3, true); });
+                    } else if (item == "lut:gather" || item == "lut:pshufb") {
+                        LutKernel kernel = item == "lut:pshufb" ? LUT_PSHUFB : LUT_GATHER;
+                        RgbLut table = rgbLut(levelsLut(10, 200, 1.3), gammaLut(2.2), NEGATIVE_LUT);
+                        r = measure(reps, [&] { memcpy(work.data(), source.data(), bytes); }, [&] {
+                            executor.forEachBand(h, (size_t)w * 3, [&](int y0, int y1) {
+                                applyRgbLut(work.data() + (size_t)y0 * w * 3, (size_t)(y1 - y0) * w, table, kernel);
+                            });
+                        });
+                    } else {
+                        r = measure(reps, [&] { memcpy(work.data(), source.data(), bytes); },
+                                    [&] { pipelines[i].run(executor, work.data(), w, h); });
+                    }
+                    if (m == 0) baseSeconds = r.seconds;
+                    report(image, item, modes[m].name, itemBytes, pixels, r, baseSeconds);
+                }
+            }
+
+            // E/S: tamanho do arquivo em MB/s, com SIMD e todas as threads
+            if (ioDir.empty()) continue;
+            setSimdLevel(best);
+            executor.setThreads(threads);
+            string p6 = ioDir + "/image_bench_p6.ppm", p3 = ioDir + "/image_bench_p3.ppm";
+            string streamed = ioDir + "/image_bench_stream.ppm";
+            BenchResult r = measure(reps, [] {}, [&] { savePPMBinary(p6, source.data(), w, h, 3); });
+            report(image, "E/S: P6 escrita", "io", fileSize(p6), pixels, r, 0);
+            r = measure(reps, [] {}, [&] {
+                PPMImage in;
+                unsigned sum = 0;
+                if (in.load(p6)) {
+                    for (size_t k = 0; k < in.length(); k += 4096) sum += in.data[k];
+                }
+                work[0] = (unsigned char)sum;
+            });
+            report(image, "E/S: P6 leitura (mmap)", "io", fileSize(p6), pixels, r, 0);
+            // texto tem ~4 bytes por amostra: acima de 50 MP fica só o binário
+            if (mp <= 50) {
+                r = measure(reps, [] {}, [&] { savePPMText(p3, source.data(), w, h, 3); });
+                report(image, "E/S: P3 escrita", "io", fileSize(p3), pixels, r, 0);
+                r = measure(reps, [] {}, [&] { PPMImage in; in.load(p3); });
+                report(image, "E/S: P3 leitura", "io", fileSize(p3), pixels, r, 0);
+                remove(p3.c_str());
+            }
+            FilterPipeline chain;
+            string error;
+            chain.parse("levels:10,200 | blur:2", error);
+            r = measure(reps, [] {}, [&] { streamImage(p6, streamed, chain, executor, 0, BATCH_BINARY); });
+            report(image, "E/S: faixas P6 -> levels|blur -> P6", "io", fileSize(p6), pixels, r, 0);
+            remove(p6.c_str());
+            remove(streamed.c_str());
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,130 @@
+// BENCHMARK DE E/S PPM
+// Mede a vazão (MB/s do arquivo) da leitura e escrita de P3 texto pelo
+// caminho antigo com iostream (arq >> g / arq << g << endl) e pelo caminho
+// rápido do PPM.h, e também do P6 binário mapeado em memória.
+//
+// uso: ppm_bench [largura altura] [diretório temporário]
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "PPM.h"
+
+using namespace std;
+
+typedef chrono::high_resolution_clock Clock;
+
+static double secondsSince(Clock::time_point t0) {
+    return chrono::duration<double>(Clock::now() - t0).count();
+}
+
+static size_t fileSize(const string &path) {
+    ifstream f(path, ios::binary | ios::ate);
+    return f ? (size_t)f.tellg() : 0;
+}
+
+static void report(const string &name, size_t bytes, double seconds) {
+    cout << left << setw(28) << name << right << setw(10) << fixed << setprecision(1)
+         << bytes / seconds / 1e6 << " MB/s" << setw(10) << setprecision(3) << seconds << " s" << endl;
+}
+
+// Caminhos originais do exemplo_03, para comparação
+static void saveStream(const string &file, const unsigned char *data, int w, int h) {
+    ofstream arq(file);
+    arq << "P3" << endl << w << " " << h << endl << "255" << endl;
+    for (size_t i = 0, n = (size_t)w * h * 3; i < n; i++) {
+        arq << (int)data[i] << endl;
+    }
+}
+
+static void openStream(const string &file, vector<unsigned char> &data) {
+    ifstream arq(file);
+    string magic;
+    int w, h, mv;
+    arq >> magic >> w >> h >> mv;
+    data.resize((size_t)w * h * 3);
+    for (size_t j = 0; j < data.size(); j++) {
+        int g;
+        arq >> g;
+        data[j] = (unsigned char)g;
+    }
+}
+
+int main(int argc, char **argv) {
+    int w = 1024, h = 1024;
+    string dir = ".";
+    if (argc >= 3) {
+        w = atoi(argv[1]);
+        h = atoi(argv[2]);
+    }
+    if (argc >= 4) dir = argv[3];
+    if (w <= 0 || h <= 0) {
+        cout << "uso: ppm_bench [largura altura] [diretório temporário]" << endl;
+        return EXIT_FAILURE;
+    }
+
+    // Ruído + gradiente: mistura de amostras com 1, 2 e 3 dígitos
+    vector<unsigned char> img((size_t)w * h * 3);
+    mt19937 rng(1);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            unsigned char *p = &img[((size_t)y * w + x) * 3];
+            p[0] = (unsigned char)(x * 255 / w);
+            p[1] = (unsigned char)(y * 255 / h);
+            p[2] = (unsigned char)(rng() & 0xff);
+        }
+    }
+    cout << "imagem " << w << " x " << h << " (" << img.size() / 1e6 << " MB de pixels)" << endl;
+
+    string p3 = dir + "/ppm_bench_p3.ppm";
+    string p3Stream = dir + "/ppm_bench_p3_stream.ppm";
+    string p6 = dir + "/ppm_bench_p6.ppm";
+
+    Clock::time_point t0 = Clock::now();
+    saveStream(p3Stream, img.data(), w, h);
+    report("P3 escrita (iostream)", fileSize(p3Stream), secondsSince(t0));
+
+    t0 = Clock::now();
+    savePPMText(p3, img.data(), w, h, 3);
+    report("P3 escrita (rápida)", fileSize(p3), secondsSince(t0));
+
+    vector<unsigned char> back;
+    t0 = Clock::now();
+    openStream(p3, back);
+    report("P3 leitura (iostream)", fileSize(p3), secondsSince(t0));
+
+    PPMImage image;
+    t0 = Clock::now();
+    bool ok = image.load(p3);
+    report("P3 leitura (rápida)", fileSize(p3), secondsSince(t0));
+    if (!ok || memcmp(image.data, img.data(), img.size()) != 0 || back != img) {
+        cout << "ERRO: leitura P3 não confere com a imagem original" << endl;
+        return EXIT_FAILURE;
+    }
+
+    t0 = Clock::now();
+    savePPMBinary(p6, img.data(), w, h, 3);
+    report("P6 escrita", fileSize(p6), secondsSince(t0));
+
+    // Leitura mapeada + um toque em cada página, para não medir só o mmap
+    t0 = Clock::now();
+    PPMImage binary;
+    ok = binary.load(p6);
+    unsigned sum = 0;
+    for (size_t i = 0; ok && i < binary.length(); i += 4096) sum += binary.data[i];
+    report("P6 leitura (mmap)", fileSize(p6), secondsSince(t0));
+    if (!ok || memcmp(binary.data, img.data(), img.size()) != 0) {
+        cout << "ERRO: leitura P6 não confere com a imagem original (" << sum << ")" << endl;
+        return EXIT_FAILURE;
+    }
+
+    remove(p3.c_str());
+    remove(p3Stream.c_str());
+    remove(p6.c_str());
+    return EXIT_SUCCESS;
+}
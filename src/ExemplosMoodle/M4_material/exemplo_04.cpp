@@ -16,61 +16,11 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include "TextureLoader.h"
+
 const GLint WIDTH = 800, HEIGHT = 600;
 glm::mat4 matrix = glm::mat4(1);
 
-bool load_texture (const char* file_name, GLuint* tex) {
-    int x, y, n;
-    int force_channels = 4;
-    glEnable(GL_TEXTURE_2D);
-    unsigned char* image_data = stbi_load (file_name, &x, &y, &n, force_channels);
-    if (!image_data) {
-        fprintf (stderr, "ERROR: could not load %s\n", file_name);
-        return false;
-    }
-    // NPOT check
-    if ((x & (x - 1)) != 0 || (y & (y - 1)) != 0) {
-        fprintf (
-                 stderr, "WARNING: texture %s is not power-of-2 dimensions\n", file_name
-                 );
-    }
-//    int width_in_bytes = x * 4;
-//    unsigned char *top = NULL;
-//    unsigned char *bottom = NULL;
-//    unsigned char temp = 0;
-//    int half_height = y / 2;
-//    for (int row = 0; row < half_height; row++) {
-//        top = image_data + row * width_in_bytes;
-//        bottom = image_data + (y - row - 1) * width_in_bytes;
-//        for (int col = 0; col < width_in_bytes; col++) {
-//            temp = *top;
-//            *top = *bottom;
-//            *bottom = temp;
-//            top++;
-//            bottom++;
-//        }
-//    }
-    
-    glGenTextures (1, tex);
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture (GL_TEXTURE_2D, *tex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, x, y, 0, GL_RGBA, GL_UNSIGNED_BYTE, image_data);
-    glGenerateMipmap (GL_TEXTURE_2D);
-    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    
-    GLfloat max_aniso = 0.0f;
-    glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &max_aniso);
-    // set the maximum!
-    glTexParameterf (GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, max_aniso);
-    return true;
-}
-
-
-
-
 void mouse(double mx, double my) {
     double dx = mx - WIDTH / 2;
     double dy = my - HEIGHT / 2;
@@ -173,12 +123,20 @@ int main() {
 
     glBindVertexArray( 0 );
 
-    GLuint tex;
-    load_texture ("../src/ExemplosMoodle/M4_material/icon-unisinos.png", &tex);
+    // Mipmaps na CPU em luz linear (glGenerateMipmap faz a média dos
+    // valores sRGB e escurece os níveis menores); a imagem é decodificada
+    // em outra thread e entra no lugar do placeholder quando fica pronta
+    TextureLoader textures;
+    TextureOptions options;
+    options.mipmaps = true;
+    options.minFilter = GL_LINEAR_MIPMAP_LINEAR;
+    options.anisotropy = true;
+    GLuint tex = textures.load("../src/ExemplosMoodle/M4_material/icon-unisinos.png", options);
 
     
     while (!glfwWindowShouldClose(window)) {
         glfwPollEvents();
+        textures.update();
         
         const int state = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT);
         if (state == GLFW_PRESS) {
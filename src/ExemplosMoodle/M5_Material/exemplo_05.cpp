@@ -4,6 +4,8 @@
 #include <stb_image.h>
 
 #include "gl_utils.h"
+#include "FrameCapture.h"
+#include "TextureLoader.h"
 
 #include <GLFW/glfw3.h>
 #include <assert.h>
@@ -28,53 +30,26 @@ float PARALLAX_RATE = 0.01f;
 
 GLFWwindow *g_window = NULL;
 
-int loadTexture(unsigned int &texture, char *filename)
+int main(int argc, char **argv)
 {
-	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_2D, texture);
+	// modo de captura dos testes de regressão (golden_check)
+	FrameCapture capture;
+	capture.parse(argc, argv, "exemplo_05");
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-
-	GLfloat max_aniso = 0.0f;
-	glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &max_aniso);
-	// set the maximum!
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, max_aniso);
-
-	int width, height, nrChannels;
-
-	unsigned char *data = stbi_load(filename, &width, &height, &nrChannels, 0);
-	if (data)
-	{
-		if (nrChannels == 4)
-		{
-			cout << "Alpha channel" << endl;
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-		}
-		else
-		{
-			cout << "Without Alpha channel" << endl;
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		}
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture" << std::endl;
-	}
-	stbi_image_free(data);
-}
-
-int main()
-{
 	// executa instruções de log
 	restart_gl_log();
 
 	// inicia OpenGL e libs auxiliares
-	start_gl();
+	start_gl(&capture);
 	
+	// texturas das camadas: decodificadas em paralelo, enviadas a cada quadro
+	TextureLoader textures;
+	TextureOptions layerOptions;
+	layerOptions.wrap = GL_REPEAT;
+	layerOptions.mipmaps = true;
+	layerOptions.minFilter = GL_LINEAR_MIPMAP_LINEAR;
+	layerOptions.anisotropy = true;
+
 	// INIT LAYERS
 	vector<Layer *> layers;
 
@@ -86,7 +61,7 @@ int main()
 	l0->ratex = 0.0;
 	l0->ratey = 0;
 	layers.push_back(l0);
-	loadTexture(l0->tid, l0->filename);
+	l0->tid = textures.load(l0->filename, layerOptions);
 
 	Layer *l1 = new Layer;
 	l1->filename = "../src/ExemplosMoodle/M5_Material/w1.png";
@@ -96,7 +71,7 @@ int main()
 	l1->ratex = 0.2;
 	l1->ratey = 0;
 	layers.push_back(l1);
-	loadTexture(l1->tid, l1->filename);
+	l1->tid = textures.load(l1->filename, layerOptions);
 
 	Layer *l2 = new Layer;
 	l2->filename = "../src/ExemplosMoodle/M5_Material/w2.png";
@@ -107,7 +82,7 @@ int main()
 	l2->ratey = 0;
 
 	layers.push_back(l2);
-	loadTexture(l2->tid, l2->filename);
+	l2->tid = textures.load(l2->filename, layerOptions);
 
 	Layer *l3 = new Layer;
 	l3->filename = "../src/ExemplosMoodle/M5_Material/w3.png";
@@ -117,7 +92,7 @@ int main()
 	l3->ratex = 0.6;
 	l3->ratey = 0;
 	layers.push_back(l3);
-	loadTexture(l3->tid, l3->filename);
+	l3->tid = textures.load(l3->filename, layerOptions);
 
 	Layer *l4 = new Layer;
 	l4->filename = "../src/ExemplosMoodle/M5_Material/w4.png";
@@ -127,7 +102,7 @@ int main()
 	l4->ratex = 0.8;
 	l4->ratey = 0;
 	layers.push_back(l4);
-	loadTexture(l4->tid, l4->filename);
+	l4->tid = textures.load(l4->filename, layerOptions);
 
 	// LOAD TEXTURES
 
@@ -217,9 +192,12 @@ int main()
 
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	// na captura os quadros já saem com as camadas carregadas
+	if (capture.active()) textures.finish();
 	while (!glfwWindowShouldClose(g_window))
 	{
 		_update_fps_counter(g_window);
+		textures.update();
 		double current_seconds = glfwGetTime();
 
 		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
@@ -259,6 +237,8 @@ int main()
 		{
 			PARALLAX_RATE -= 0.001f;
 		}
+		// na captura, grava o quadro antes da troca de buffers
+		capture.endFrame(g_window);
 		// put the stuff we've been drawing onto the display
 		glfwSwapBuffers(g_window);
 	}
@@ -1,6 +1,8 @@
 //#define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include "gl_utils.h"
+#include "FrameCapture.h"
+#include "TextureLoader.h"
 #include <glad/glad.h> // Carregamento dos ponteiros para funções OpenGL
 #include <GLFW/glfw3.h>
 #include <assert.h>
@@ -64,45 +66,6 @@ TileMap * readMap (char *filename) {
     return tmap;
 }
 
-int loadTexture(unsigned int &texture, char *filename)
-{
-	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_2D, texture);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-
-	GLfloat max_aniso = 0.0f;
-	glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &max_aniso);
-	// set the maximum!
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, max_aniso);
-
-	int width, height, nrChannels;
-
-	unsigned char *data = stbi_load(filename, &width, &height, &nrChannels, 0);
-	if (data)
-	{
-		if (nrChannels == 4)
-		{
-			cout << "Alpha channel" << endl;
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-		}
-		else
-		{
-			cout << "Without Alpha channel" << endl;
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		}
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture" << std::endl;
-	}
-	stbi_image_free(data);
-}
-
 void SRD2SRU(double &mx, double &my, float &x, float &y) {
 	x = xi + (mx / g_gl_width ) * w;
 	y = yi + (1 - (my / g_gl_height)) * h;
@@ -117,10 +80,10 @@ void mouse(double &mx, double &my) {
     float x = 0;
 	SRD2SRU(mx, my, x, y);
     
+    // mesmo espaço do computeDrawPosition: os tiles são desenhados com
+    // deslocamento (xi, yi + 1)
     int c, r;
-    tview->computeMouseMap(c, r, tw, th, x, y);
-	c += (tmap->getWidth()-1) / 2;
-	r += (tmap->getHeight()-1) / 2;
+    tview->computeMouseMap(c, r, tw, th, x - xi, y - (yi + 1.0f));
 	// cout << "\tDEBUG => r: " << r << " c: " << c << endl;
     
     // 2) Verificar se o ponto pertence ao tile indicado:
@@ -183,11 +146,15 @@ void mouse(double &mx, double &my) {
     cx = c; cy = r;
 }
 
-int main()
+int main(int argc, char **argv)
 {
+	// modo de captura dos testes de regressão (golden_check)
+	FrameCapture capture;
+	capture.parse(argc, argv, "exemplo_07");
+
 	restart_gl_log();
 	// all the GLFW and GLEW start-up code is moved to here in gl_utils.cpp
-	start_gl();
+	start_gl(&capture);
 	// tell GL to only draw onto a pixel if the shape is closer to the viewer
 	glEnable(GL_DEPTH_TEST); // enable depth-testing
 	glDepthFunc(GL_LESS);
@@ -208,8 +175,14 @@ int main()
         << " tileW2=" << tileW2 << " tileH2=" << tileH2
     << endl;
 
-	GLuint tid;
-	loadTexture(tid, "terrain.png");
+	// tileset decodificado em outra thread (TextureLoader.h)
+	TextureLoader textures;
+	TextureOptions tilesetOptions;
+	tilesetOptions.wrap = GL_CLAMP_TO_BORDER;
+	tilesetOptions.mipmaps = true;
+	tilesetOptions.minFilter = GL_LINEAR_MIPMAP_LINEAR;
+	tilesetOptions.anisotropy = true;
+	GLuint tid = textures.load("terrain.png", tilesetOptions);
 
     tmap->setTid(tid);
     cout << "Tmap inicializado" << endl;
@@ -312,9 +285,12 @@ int main()
 	glEnable (GL_BLEND);
 	glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	// glEnable(GL_DEPTH_TEST);
+	// na captura os quadros já saem com o tileset carregado
+	if (capture.active()) textures.finish();
 	while (!glfwWindowShouldClose(g_window))
 	{
 		_update_fps_counter(g_window);
+		textures.update();
 		double current_seconds = glfwGetTime();
 
 		// wipe the drawing surface clear
@@ -369,10 +345,12 @@ int main()
         
         const int state = glfwGetMouseButton(g_window, GLFW_MOUSE_BUTTON_LEFT);
         
-        if (state == GLFW_PRESS) {
+        if (state == GLFW_PRESS && capture.inputEnabled()) {
             mouse(mx, my);
         }
         
+		// na captura, grava o quadro antes da troca de buffers
+		capture.endFrame(g_window);
 		// put the stuff we've been drawing onto the display
 		glfwSwapBuffers(g_window);
 	}
@@ -5,6 +5,8 @@
 #include <GLFW/glfw3.h>
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
+#include "FrameCapture.h"
+#include "TextureLoader.h"
 
 #include <iostream>
 #include <fstream>
@@ -28,26 +30,16 @@ struct GameObject {
 
 int WIN_W = 800, WIN_H = 600;
 
-// FUNÇÃO PARA CARREGAR TEXTURAS
-GLuint loadTexture(const std::string& path, int& outW, int& outH) {
-    int nr;
-    unsigned char* data = stbi_load(path.c_str(), &outW, &outH, &nr, 4);
-    if(!data){ std::cerr<<"Falha ao ler "<<path<<"\n"; return 0; }
-    GLuint tex;
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
-    glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA, outW, outH, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
-    stbi_image_free(data);
-    return tex;
-}
-
-int main(){
+int main(int argc, char** argv){
+    // MODO DE CAPTURA PARA OS TESTES DE REGRESSÃO (golden_check)
+    FrameCapture capture;
+    capture.parse(argc, argv, "JogoTimelap");
+
     // INICIALIZAÇÃO DO OPENGL E GLFW
     if(!glfwInit()){ std::cerr<<"GLFW Init falhou\n"; return -1; }
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR,2);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR,1);
+    capture.windowHints();
     GLFWwindow* window = glfwCreateWindow(WIN_W, WIN_H, "Jogo Isométrico", nullptr, nullptr);
     if(!window){ std::cerr<<"Janela falhou\n"; return -1; }
     glfwMakeContextCurrent(window);
@@ -64,6 +56,11 @@ int main(){
     glOrtho(0, WIN_W, WIN_H, 0, -1, 1);
     glMatrixMode(GL_MODELVIEW);
 
+    // TEXTURAS: DECODIFICADAS EM PARALELO, ENVIADAS A CADA QUADRO (TextureLoader.h)
+    TextureLoader textures;
+    TextureOptions pixelArt;
+    pixelArt.minFilter = pixelArt.magFilter = GL_NEAREST;
+
     // CARREGAMENTO DAS CONFIGURAÇÕES DO TILESET
     std::ifstream inCfg("../assets/config/tileset.cfg.txt");
     std::string line, tilesetFile;
@@ -80,9 +77,7 @@ int main(){
     }
 
     // CARREGAMENTO DA TEXTURA DO TILESET
-    int texW, texH;
-    GLuint tilesetTex = loadTexture(tilesetFile, texW, texH);
-    int cols = texW / tileW;
+    GLuint tilesetTex = textures.load(tilesetFile, pixelArt);
 
     // PROPRIEDADES DOS TILES - TODOS CAMINHÁVEIS
     std::vector<TileProps> props(7);
@@ -127,11 +122,10 @@ int main(){
     std::map<std::string, GLuint> objTex;
 
     // CARREGAMENTO DAS TEXTURAS DOS OBJETOS
-    int w, h;
-    objTex["coin"] = loadTexture("../assets/coin.png", w, h);
-    objTex["trap"] = loadTexture("../assets/trap.png", w, h);
-    objTex["key"] = loadTexture("../assets/key.png", w, h);
-    objTex["exit"] = loadTexture("../assets/exit.png", w, h);
+    objTex["coin"] = textures.load("../assets/coin.png", pixelArt);
+    objTex["trap"] = textures.load("../assets/trap.png", pixelArt);
+    objTex["key"] = textures.load("../assets/key.png", pixelArt);
+    objTex["exit"] = textures.load("../assets/exit.png", pixelArt);
 
     // POSICIONAMENTO DOS OBJETOS NO MAPA
     for(const auto& obj : gameObjects) {
@@ -144,8 +138,7 @@ int main(){
     objectMap[13][13] = "exit"; // Porta posicionada em (13,13)
 
     // CARREGAMENTO DO PERSONAGEM
-    int pw, ph;
-    GLuint playerTex = loadTexture("../assets/Vampirinho.png", pw, ph);
+    GLuint playerTex = textures.load("../assets/Vampirinho.png", pixelArt);
     int px=1, py=1; // Posição inicial do player
 
     // VARIÁVEIS DO JOGO
@@ -159,13 +152,17 @@ int main(){
     std::cout << "=== JOGO INICIADO ===" << std::endl;
     std::cout << "Colete moeda + chave, vá para a porta no final!" << std::endl;
 
+    // NA CAPTURA TODOS OS QUADROS JÁ SAEM COM AS TEXTURAS PRONTAS
+    if(capture.active()) textures.finish();
+
     // LOOP PRINCIPAL DO JOGO
     while(!glfwWindowShouldClose(window)){
         glfwPollEvents();
+        textures.update();
 
         // SISTEMA DE MOVIMENTO - UMA TILE POR FRAME
         static bool moved = false;
-        if(!moved){
+        if(!moved && capture.inputEnabled()){
             int dx=0, dy=0;
             if(glfwGetKey(window,GLFW_KEY_UP   )==GLFW_PRESS) { dy=-1; moved=true; }
             if(glfwGetKey(window,GLFW_KEY_DOWN )==GLFW_PRESS) { dy=+1; moved=true; }
@@ -234,6 +231,9 @@ int main(){
         // RENDERIZAÇÃO DO MAPA ISOMÉTRICO
         glBindTexture(GL_TEXTURE_2D, tilesetTex);
         glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+        // ENQUANTO O TILESET CARREGA (PLACEHOLDER 1x1) cols É 0 E O MAPA NÃO APARECE
+        int texW = textures.info(tilesetTex)->width, texH = textures.info(tilesetTex)->height;
+        int cols = texW / tileW;
         
         for(int y=0; y<mapH; y++){
             for(int x=0; x<mapW; x++){
@@ -242,7 +242,7 @@ int main(){
                 // FILTRO: NÃO RENDERIZA LAVA, ÁGUAS E TERRENO ROSA
                 if(id == 3 || id == 4 || id == 5 || id == 6) continue;
                 
-                if(id < 0 || id >= tileCount) continue;
+                if(id < 0 || id >= tileCount || cols == 0) continue;
                 
                 // CÁLCULO DA TEXTURA DO TILE
                 float u0 = (id % cols) * (tileW / (float)texW);
@@ -312,8 +312,9 @@ int main(){
             
             // PLAYER COM ESCALA MAIOR
             float playerScale = 1.2f;
-            float w = pw * playerScale;
-            float h = ph * playerScale;
+            const TextureInfo* player = textures.info(playerTex);
+            float w = player->width * playerScale;
+            float h = player->height * playerScale;
             
             // POSICIONAMENTO CENTRALIZADO
             float x0 = pxscr + (tileW - w) * 0.5f;
@@ -329,6 +330,7 @@ int main(){
             glEnd();
         }
 
+        capture.endFrame(window);
         glfwSwapBuffers(window);
     }
 
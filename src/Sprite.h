@@ -11,6 +11,7 @@ class Sprite {
 public:
     Sprite() {
         position = glm::vec3(400.0f, 300.0f, 0.0f);
+        previousPosition = position;
         scale = glm::vec3(120.0f, 120.0f, 1.0f);
         angle = 0.0f;
         flipX = false;
@@ -20,12 +21,14 @@ public:
         iAnimation = 0;
         iFrame = 0;
         frameRate = 10.0f;
-        lastTime = 0.0;
+        frameTime = 0.0f;
         isMoving = false;
         
         VAO = VBO = EBO = 0;
         textureID = 0;
         shaderID = 0;
+        viewWidth = 800.0f;
+        viewHeight = 600.0f;
     }
     
     ~Sprite() {
@@ -75,31 +78,40 @@ public:
         glBindVertexArray(0);
     }
     
-    void update() {
+    // Guarda o estado do passo anterior para interpolar no render
+    void savePreviousState() {
+        previousPosition = position;
+    }
+    
+    // dt = passo fixo da simulação, em segundos
+    void update(float dt) {
         if (isMoving) {
-            updateFrame();
+            updateFrame(dt);
         }
         isMoving = false;
     }
     
-    void updateFrame() {
-        double currentTime = glfwGetTime();
+    void updateFrame(float dt) {
+        frameTime += dt;
         
-        if (currentTime - lastTime >= 1.0 / frameRate) {
+        if (frameTime >= 1.0f / frameRate) {
             iFrame = (iFrame + 1) % nFrames;
-            lastTime = currentTime;
+            frameTime -= 1.0f / frameRate;
         }
     }
     
-    void render() {
+    // alpha (0..1) = fração do passo fixo já decorrida desde o último update
+    void render(float alpha = 1.0f) {
         glUseProgram(shaderID);
         
+        glm::vec3 drawPosition = previousPosition + (position - previousPosition) * alpha;
+        
         glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, position);
+        model = glm::translate(model, drawPosition);
         model = glm::rotate(model, glm::radians(angle), glm::vec3(0.0f, 0.0f, 1.0f));
         model = glm::scale(model, scale);
         
-        glm::mat4 projection = glm::ortho(0.0f, 800.0f, 0.0f, 600.0f, -1.0f, 1.0f);
+        glm::mat4 projection = glm::ortho(0.0f, viewWidth, 0.0f, viewHeight, -1.0f, 1.0f);
         
         GLint modelLoc = glGetUniformLocation(shaderID, "model");
         GLint projLoc = glGetUniformLocation(shaderID, "projection");
@@ -130,11 +142,68 @@ public:
         glBindVertexArray(0);
     }
     
-    void setPosition(glm::vec3 pos) { position = pos; }
+    // Shaders esperados por render() (uniforms model, projection, offsetX/Y,
+    // nFrames, nAnimations e flipX). Sem discard: a transparência vem da
+    // textura com alfa pré-multiplicado (ver ColorKey.h).
+    static const char* vertexShaderSource() {
+        return R"(
+            #version 330 core
+            layout (location = 0) in vec3 aPos;
+            layout (location = 1) in vec2 aTexCoord;
+            
+            out vec2 TexCoord;
+            
+            uniform mat4 model;
+            uniform mat4 projection;
+            uniform float offsetX;
+            uniform float offsetY;
+            uniform float nFrames;
+            uniform float nAnimations;
+            uniform int flipX;
+            
+            void main() {
+                gl_Position = projection * model * vec4(aPos, 1.0);
+                
+                vec2 spriteSize = vec2(1.0 / nFrames, 1.0 / nAnimations);
+                
+                float texCoordX = aTexCoord.x;
+                if (flipX == 1) {
+                    texCoordX = 1.0 - aTexCoord.x;
+                }
+                
+                TexCoord = vec2(
+                    (texCoordX * spriteSize.x) + offsetX,
+                    (aTexCoord.y * spriteSize.y) + offsetY
+                );
+            }
+        )";
+    }
+    
+    static const char* fragmentShaderSource() {
+        return R"(
+            #version 330 core
+            out vec4 FragColor;
+            
+            in vec2 TexCoord;
+            uniform sampler2D texture1;
+            
+            void main() {
+                // cor-chave já convertida em alfa (pré-multiplicado) na carga
+                FragColor = texture(texture1, TexCoord);
+            }
+        )";
+    }
+    
+    void setPosition(glm::vec3 pos) { position = previousPosition = pos; }
     void setScale(glm::vec3 sc) { scale = sc; }
     void setTexture(GLuint tex) { textureID = tex; }
     void setAnimation(int anim) { if (anim >= 0 && anim < nAnimations) iAnimation = anim; }
     void setAngle(float newAngle) { angle = newAngle; }
+    // Tamanho em pixels da área de desenho (projeção ortográfica de render())
+    void setViewSize(float width, float height) { viewWidth = width; viewHeight = height; }
+    
+    glm::vec3 getPosition() const { return position; }
+    glm::vec3 getScale() const { return scale; }
     
     void setDirection(int key) {
         switch (key) {
@@ -182,8 +251,10 @@ private:
     GLuint VAO, VBO, EBO;
     GLuint textureID;
     GLuint shaderID;
+    float viewWidth, viewHeight;
     
     glm::vec3 position;
+    glm::vec3 previousPosition;
     glm::vec3 scale;
     float angle;
     bool flipX;
@@ -193,7 +264,7 @@ private:
     int iAnimation;
     int iFrame;
     float frameRate;
-    double lastTime;
+    float frameTime;
     bool isMoving;
 };
 
@@ -0,0 +1,432 @@
+#ifndef SPRITEWORLD_H
+#define SPRITEWORLD_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "CpuFeatures.h"
+
+// Mundo de sprites em estrutura-de-arrays (SoA): cada campo do Sprite fica
+// num array contíguo, o que permite atualizar posições e montar as matrizes
+// de modelo de vários sprites por instrução (SSE2/AVX2) e desenhar tudo com
+// uma única chamada instanciada.
+class SpriteWorld {
+public:
+    // Cada sprite gera uma mat4 (16 floats, column-major, igual à glm) e um
+    // vec4 com (offsetX, offsetY, flipX, 0) para o recorte do spritesheet.
+    static const int FLOATS_PER_TRANSFORM = 16;
+    static const int FLOATS_PER_FRAME = 4;
+
+    SpriteWorld() {
+        nAnimations = 1;
+        nFrames = 6;
+        frameRate = 10.0f;
+
+        VAO = VBO = EBO = 0;
+        instanceVBO = frameVBO = 0;
+        instanceCapacity = 0;
+        textureID = 0;
+        shaderID = 0;
+    }
+
+    ~SpriteWorld() {
+        if (VAO) glDeleteVertexArrays(1, &VAO);
+        if (VBO) glDeleteBuffers(1, &VBO);
+        if (EBO) glDeleteBuffers(1, &EBO);
+        if (instanceVBO) glDeleteBuffers(1, &instanceVBO);
+        if (frameVBO) glDeleteBuffers(1, &frameVBO);
+    }
+
+    void initialize(GLuint shaderID, int nAnimations, int nFrames) {
+        this->shaderID = shaderID;
+        this->nAnimations = nAnimations;
+        this->nFrames = nFrames;
+        setupMesh();
+    }
+
+    void reserve(size_t n) {
+        posX.reserve(n); posY.reserve(n); posZ.reserve(n);
+        velX.reserve(n); velY.reserve(n);
+        scaleX.reserve(n); scaleY.reserve(n);
+        angle.reserve(n); cosA.reserve(n); sinA.reserve(n);
+        flipX.reserve(n);
+        iAnimation.reserve(n); iFrame.reserve(n); frameTime.reserve(n);
+    }
+
+    size_t size() const { return posX.size(); }
+
+    void clear() {
+        posX.clear(); posY.clear(); posZ.clear();
+        velX.clear(); velY.clear();
+        scaleX.clear(); scaleY.clear();
+        angle.clear(); cosA.clear(); sinA.clear();
+        flipX.clear();
+        iAnimation.clear(); iFrame.clear(); frameTime.clear();
+    }
+
+    // Retorna o índice do novo sprite.
+    int add(glm::vec3 position, glm::vec3 scale, float angleDegrees = 0.0f) {
+        posX.push_back(position.x);
+        posY.push_back(position.y);
+        posZ.push_back(position.z);
+        velX.push_back(0.0f);
+        velY.push_back(0.0f);
+        scaleX.push_back(scale.x);
+        scaleY.push_back(scale.y);
+        angle.push_back(0.0f);
+        cosA.push_back(1.0f);
+        sinA.push_back(0.0f);
+        flipX.push_back(0);
+        iAnimation.push_back(0);
+        iFrame.push_back(0);
+        frameTime.push_back(0.0f);
+        int i = (int)size() - 1;
+        setAngle(i, angleDegrees);
+        return i;
+    }
+
+    void setPosition(int i, glm::vec3 pos) { posX[i] = pos.x; posY[i] = pos.y; posZ[i] = pos.z; }
+    void setVelocity(int i, glm::vec2 vel) { velX[i] = vel.x; velY[i] = vel.y; }
+    void setScale(int i, glm::vec3 sc) { scaleX[i] = sc.x; scaleY[i] = sc.y; }
+    void setFlipX(int i, bool flip) { flipX[i] = flip ? 1 : 0; }
+    void setAnimation(int i, int anim) { if (anim >= 0 && anim < nAnimations) iAnimation[i] = anim; }
+    void setTexture(GLuint tex) { textureID = tex; }
+    void setFrameRate(float fps) { frameRate = fps; }
+
+    // Seno e cosseno ficam em cache: o ângulo muda raramente e assim o
+    // kernel de transformações não precisa de trigonometria vetorial.
+    void setAngle(int i, float angleDegrees) {
+        float rad = glm::radians(angleDegrees);
+        angle[i] = angleDegrees;
+        cosA[i] = std::cos(rad);
+        sinA[i] = std::sin(rad);
+    }
+
+    glm::vec3 getPosition(int i) const { return glm::vec3(posX[i], posY[i], posZ[i]); }
+    float getAngle(int i) const { return angle[i]; }
+
+    // Integra posição = posição + velocidade * dt e avança a animação de
+    // quem está se movendo (mesma regra do Sprite::update).
+    void update(float dt) {
+        size_t n = size();
+        if (n == 0) return;
+        switch (activeSimdLevel()) {
+#if CPU_HAS_AVX2_TARGET
+            case SIMD_AVX2: integrateAVX2(dt, n); break;
+#endif
+#if CPU_HAS_SSE2
+            case SIMD_SSE2: integrateSSE2(dt, n); break;
+#endif
+            default: integrateScalar(dt, 0, n); break;
+        }
+
+        float period = 1.0f / frameRate;
+        for (size_t i = 0; i < n; i++) {
+            if (velX[i] == 0.0f && velY[i] == 0.0f) continue;
+            frameTime[i] += dt;
+            if (frameTime[i] >= period) {
+                frameTime[i] -= period;
+                iFrame[i] = (iFrame[i] + 1) % nFrames;
+            }
+        }
+    }
+
+    // Monta model = translate * rotate(z) * scale de todos os sprites.
+    void buildTransforms() {
+        size_t n = size();
+        transforms.resize(n * FLOATS_PER_TRANSFORM);
+        frames.resize(n * FLOATS_PER_FRAME);
+        if (n == 0) return;
+        switch (activeSimdLevel()) {
+#if CPU_HAS_AVX2_TARGET && CPU_HAS_SSE2
+            case SIMD_AVX2: buildTransformsAVX2(n); break;
+#endif
+#if CPU_HAS_SSE2
+            case SIMD_SSE2: buildTransformsSSE2(n); break;
+#endif
+            default: buildTransformsScalar(0, n); break;
+        }
+
+        float fw = 1.0f / (float)nFrames;
+        float fh = 1.0f / (float)nAnimations;
+        float *f = frames.data();
+        for (size_t i = 0; i < n; i++, f += FLOATS_PER_FRAME) {
+            f[0] = (float)iFrame[i] * fw;
+            f[1] = (float)iAnimation[i] * fh;
+            f[2] = (float)flipX[i];
+            f[3] = 0.0f;
+        }
+    }
+
+    const float *getTransforms() const { return transforms.data(); }
+    const float *getFrames() const { return frames.data(); }
+
+    // Envia as transformações como atributos por instância e desenha todos
+    // os sprites com uma única chamada.
+    void render(const glm::mat4 &projection) {
+        size_t n = size();
+        if (n == 0) return;
+        buildTransforms();
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        if (n > instanceCapacity) {
+            glBufferData(GL_ARRAY_BUFFER, n * FLOATS_PER_TRANSFORM * sizeof(float), transforms.data(), GL_STREAM_DRAW);
+        } else {
+            glBufferData(GL_ARRAY_BUFFER, instanceCapacity * FLOATS_PER_TRANSFORM * sizeof(float), NULL, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, n * FLOATS_PER_TRANSFORM * sizeof(float), transforms.data());
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, frameVBO);
+        if (n > instanceCapacity) {
+            glBufferData(GL_ARRAY_BUFFER, n * FLOATS_PER_FRAME * sizeof(float), frames.data(), GL_STREAM_DRAW);
+            instanceCapacity = n;
+        } else {
+            glBufferData(GL_ARRAY_BUFFER, instanceCapacity * FLOATS_PER_FRAME * sizeof(float), NULL, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, n * FLOATS_PER_FRAME * sizeof(float), frames.data());
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glUseProgram(shaderID);
+        glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, &projection[0][0]);
+        glUniform1f(glGetUniformLocation(shaderID, "nFrames"), (float)nFrames);
+        glUniform1f(glGetUniformLocation(shaderID, "nAnimations"), (float)nAnimations);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glUniform1i(glGetUniformLocation(shaderID, "texture1"), 0);
+
+        glBindVertexArray(VAO);
+        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, (GLsizei)n);
+        glBindVertexArray(0);
+    }
+
+    // Shaders compatíveis com o layout de atributos de render(). O fragment
+    // shader não usa discard: a transparência vem da textura (bakeColorKey
+    // em ColorKey.h) com alfa pré-multiplicado.
+    static const char *vertexShaderSource() {
+        return R"(
+            #version 330 core
+            layout (location = 0) in vec3 aPos;
+            layout (location = 1) in vec2 aTexCoord;
+            layout (location = 2) in mat4 aModel;
+            layout (location = 6) in vec4 aFrame;
+
+            out vec2 TexCoord;
+
+            uniform mat4 projection;
+            uniform float nFrames;
+            uniform float nAnimations;
+
+            void main() {
+                gl_Position = projection * aModel * vec4(aPos, 1.0);
+
+                vec2 spriteSize = vec2(1.0 / nFrames, 1.0 / nAnimations);
+                float texCoordX = aFrame.z > 0.5 ? 1.0 - aTexCoord.x : aTexCoord.x;
+                TexCoord = vec2(texCoordX * spriteSize.x + aFrame.x,
+                                aTexCoord.y * spriteSize.y + aFrame.y);
+            }
+        )";
+    }
+
+    static const char *fragmentShaderSource() {
+        return R"(
+            #version 330 core
+            out vec4 FragColor;
+
+            in vec2 TexCoord;
+            uniform sampler2D texture1;
+
+            void main() {
+                FragColor = texture(texture1, TexCoord);
+            }
+        )";
+    }
+
+private:
+    void setupMesh() {
+        float vertices[] = {
+            -0.5f, -0.5f, 0.0f,  0.0f, 1.0f,
+             0.5f, -0.5f, 0.0f,  1.0f, 1.0f,
+             0.5f,  0.5f, 0.0f,  1.0f, 0.0f,
+            -0.5f,  0.5f, 0.0f,  0.0f, 0.0f
+        };
+
+        unsigned int indices[] = {
+            0, 1, 2,
+            0, 2, 3
+        };
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        glGenBuffers(1, &instanceVBO);
+        glGenBuffers(1, &frameVBO);
+
+        glBindVertexArray(VAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+
+        // mat4 por instância ocupa as localizações 2..5 (uma coluna cada)
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        for (int c = 0; c < 4; c++) {
+            glVertexAttribPointer(2 + c, 4, GL_FLOAT, GL_FALSE, FLOATS_PER_TRANSFORM * sizeof(float),
+                                  (void*)(c * 4 * sizeof(float)));
+            glEnableVertexAttribArray(2 + c);
+            glVertexAttribDivisor(2 + c, 1);
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, frameVBO);
+        glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, FLOATS_PER_FRAME * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(6);
+        glVertexAttribDivisor(6, 1);
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void integrateScalar(float dt, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            posX[i] += velX[i] * dt;
+            posY[i] += velY[i] * dt;
+        }
+    }
+
+    // Escreve as 16 posições da mat4 do sprite i.
+    void buildTransformsScalar(size_t begin, size_t end) {
+        float *m = transforms.data() + begin * FLOATS_PER_TRANSFORM;
+        for (size_t i = begin; i < end; i++, m += FLOATS_PER_TRANSFORM) {
+            m[0]  =  cosA[i] * scaleX[i]; m[1]  = sinA[i] * scaleX[i]; m[2]  = 0.0f; m[3]  = 0.0f;
+            m[4]  = -sinA[i] * scaleY[i]; m[5]  = cosA[i] * scaleY[i]; m[6]  = 0.0f; m[7]  = 0.0f;
+            m[8]  = 0.0f;                 m[9]  = 0.0f;                m[10] = 1.0f; m[11] = 0.0f;
+            m[12] = posX[i];              m[13] = posY[i];             m[14] = posZ[i]; m[15] = 1.0f;
+        }
+    }
+
+#if CPU_HAS_SSE2
+    void integrateSSE2(float dt, size_t n) {
+        __m128 vdt = _mm_set1_ps(dt);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm_storeu_ps(&posX[i], _mm_add_ps(_mm_loadu_ps(&posX[i]), _mm_mul_ps(_mm_loadu_ps(&velX[i]), vdt)));
+            _mm_storeu_ps(&posY[i], _mm_add_ps(_mm_loadu_ps(&posY[i]), _mm_mul_ps(_mm_loadu_ps(&velY[i]), vdt)));
+        }
+        integrateScalar(dt, i, n);
+    }
+
+    // Recebe as colunas 0/1 (a, b, d, e) e a translação (x, y, z) de 4
+    // sprites em formato SoA e as transpõe para 4 mat4 consecutivas.
+    static inline void storeTransforms4(float *m, __m128 a, __m128 b, __m128 d, __m128 e,
+                                        __m128 x, __m128 y, __m128 z) {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 col2 = _mm_setr_ps(0.0f, 0.0f, 1.0f, 0.0f);
+        __m128 one = _mm_set1_ps(1.0f);
+        _MM_TRANSPOSE4_PS(a, b, d, e);
+        _MM_TRANSPOSE4_PS(x, y, z, one);
+        __m128 rot[4] = { a, b, d, e };
+        __m128 tr[4] = { x, y, z, one };
+        for (int k = 0; k < 4; k++, m += FLOATS_PER_TRANSFORM) {
+            _mm_storeu_ps(m,      _mm_movelh_ps(rot[k], zero));
+            _mm_storeu_ps(m + 4,  _mm_movehl_ps(zero, rot[k]));
+            _mm_storeu_ps(m + 8,  col2);
+            _mm_storeu_ps(m + 12, tr[k]);
+        }
+    }
+
+    void buildTransformsSSE2(size_t n) {
+        float *m = transforms.data();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4, m += 4 * FLOATS_PER_TRANSFORM) {
+            __m128 c = _mm_loadu_ps(&cosA[i]);
+            __m128 s = _mm_loadu_ps(&sinA[i]);
+            __m128 sx = _mm_loadu_ps(&scaleX[i]);
+            __m128 sy = _mm_loadu_ps(&scaleY[i]);
+            storeTransforms4(m,
+                             _mm_mul_ps(c, sx), _mm_mul_ps(s, sx),
+                             _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), s), sy), _mm_mul_ps(c, sy),
+                             _mm_loadu_ps(&posX[i]), _mm_loadu_ps(&posY[i]), _mm_loadu_ps(&posZ[i]));
+        }
+        buildTransformsScalar(i, n);
+    }
+#endif
+
+#if CPU_HAS_AVX2_TARGET
+    TARGET_AVX2 void integrateAVX2(float dt, size_t n) {
+        __m256 vdt = _mm256_set1_ps(dt);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            _mm256_storeu_ps(&posX[i], _mm256_fmadd_ps(_mm256_loadu_ps(&velX[i]), vdt, _mm256_loadu_ps(&posX[i])));
+            _mm256_storeu_ps(&posY[i], _mm256_fmadd_ps(_mm256_loadu_ps(&velY[i]), vdt, _mm256_loadu_ps(&posY[i])));
+        }
+        integrateScalar(dt, i, n);
+    }
+#endif
+
+#if CPU_HAS_AVX2_TARGET && CPU_HAS_SSE2
+    // Calcula 8 sprites por vez e escreve cada metade com a transposição SSE
+    // (storeTransforms4 só existe com SSE2).
+    TARGET_AVX2 void buildTransformsAVX2(size_t n) {
+        float *m = transforms.data();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8, m += 8 * FLOATS_PER_TRANSFORM) {
+            __m256 c = _mm256_loadu_ps(&cosA[i]);
+            __m256 s = _mm256_loadu_ps(&sinA[i]);
+            __m256 sx = _mm256_loadu_ps(&scaleX[i]);
+            __m256 sy = _mm256_loadu_ps(&scaleY[i]);
+            __m256 a = _mm256_mul_ps(c, sx);
+            __m256 b = _mm256_mul_ps(s, sx);
+            __m256 d = _mm256_mul_ps(_mm256_sub_ps(_mm256_setzero_ps(), s), sy);
+            __m256 e = _mm256_mul_ps(c, sy);
+            __m256 x = _mm256_loadu_ps(&posX[i]);
+            __m256 y = _mm256_loadu_ps(&posY[i]);
+            __m256 z = _mm256_loadu_ps(&posZ[i]);
+            storeTransforms4(m,
+                             _mm256_castps256_ps128(a), _mm256_castps256_ps128(b),
+                             _mm256_castps256_ps128(d), _mm256_castps256_ps128(e),
+                             _mm256_castps256_ps128(x), _mm256_castps256_ps128(y),
+                             _mm256_castps256_ps128(z));
+            storeTransforms4(m + 4 * FLOATS_PER_TRANSFORM,
+                             _mm256_extractf128_ps(a, 1), _mm256_extractf128_ps(b, 1),
+                             _mm256_extractf128_ps(d, 1), _mm256_extractf128_ps(e, 1),
+                             _mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1),
+                             _mm256_extractf128_ps(z, 1));
+        }
+        buildTransformsScalar(i, n);
+    }
+#endif
+
+    GLuint VAO, VBO, EBO;
+    GLuint instanceVBO, frameVBO;
+    size_t instanceCapacity;
+    GLuint textureID;
+    GLuint shaderID;
+
+    int nAnimations;
+    int nFrames;
+    float frameRate;
+
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> velX, velY;
+    std::vector<float> scaleX, scaleY;
+    std::vector<float> angle, cosA, sinA;
+    std::vector<uint8_t> flipX;
+    std::vector<int> iAnimation, iFrame;
+    std::vector<float> frameTime;
+
+    std::vector<float> transforms;
+    std::vector<float> frames;
+};
+
+#endif
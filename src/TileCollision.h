@@ -0,0 +1,164 @@
+#ifndef TILECOLLISION_H
+#define TILECOLLISION_H
+
+#include <glm/glm.hpp>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Propriedades por id de tile, lidas de tileProps.cfg.txt
+struct TileProps {
+    bool walkable;
+    int  swapTo;
+};
+
+// Caixa alinhada aos eixos, no mesmo espaço em pixels do sprite
+struct AABB {
+    glm::vec2 min;
+    glm::vec2 max;
+};
+
+// Resultado de um movimento varrido
+struct SweepResult {
+    glm::vec2 delta;   // deslocamento efetivamente aplicado
+    bool hitX, hitY;   // bateu em parede em cada eixo
+};
+
+// Formato: "id walkable swapTo  # comentário", uma linha por tile.
+inline bool loadTileProps(const std::string &path, std::vector<TileProps> &props) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line = line.substr(0, hash);
+        std::stringstream ss(line);
+        int id, swapTo;
+        std::string walkable;
+        if (!(ss >> id >> walkable >> swapTo) || id < 0) continue;
+        if ((int)props.size() <= id) props.resize(id + 1, TileProps{ true, -1 });
+        props[id].walkable = (walkable == "true" || walkable == "1");
+        props[id].swapTo = swapTo;
+    }
+    return true;
+}
+
+// Colisão de AABB contra os tiles não caminháveis de uma grade retangular.
+// O movimento é varrido um eixo por vez (X e depois Y), testando apenas as
+// colunas/linhas que a borda dianteira da caixa atravessa; o custo depende
+// do deslocamento e do tamanho do sprite, nunca do tamanho do mapa. Separar
+// os eixos faz o sprite deslizar ao longo das paredes.
+// As caixas estão no espaço do sprite (y para cima, origem no canto
+// inferior esquerdo do mapa); a linha 0 do mapa, como no map.txt, é a de
+// cima, então a linha de um ponto é rows - 1 - floor(y / tileH).
+class TileCollisionMap {
+public:
+    TileCollisionMap() : cols(0), rows(0), tileW(1.0f), tileH(1.0f) {}
+
+    TileCollisionMap(int cols, int rows, float tileW, float tileH)
+        : cols(cols), rows(rows), tileW(tileW), tileH(tileH), solid(cols * rows, 0) {}
+
+    // Lê o mapa no formato de map.txt ("cols rows" seguido dos ids por linha)
+    // e marca como sólidos os ids não caminháveis em props.
+    bool loadMap(const std::string &path, const std::vector<TileProps> &props, float tileW, float tileH) {
+        std::ifstream in(path);
+        int w, h;
+        if (!(in >> w >> h) || w <= 0 || h <= 0) return false;
+        *this = TileCollisionMap(w, h, tileW, tileH);
+        for (int r = 0; r < h; r++) {
+            for (int c = 0; c < w; c++) {
+                int id;
+                if (!(in >> id)) return false;
+                setTile(c, r, id, props);
+            }
+        }
+        return true;
+    }
+
+    void setTile(int col, int row, int id, const std::vector<TileProps> &props) {
+        bool walkable = id >= 0 && id < (int)props.size() && props[id].walkable;
+        solid[col + row * cols] = walkable ? 0 : 1;
+    }
+
+    void setSolid(int col, int row, bool isSolid) { solid[col + row * cols] = isSolid ? 1 : 0; }
+
+    // Linha e coluna do mapa (linha 0 em cima). Fora do mapa conta como sólido.
+    bool isSolid(int col, int row) const {
+        if (col < 0 || row < 0 || col >= cols || row >= rows) return true;
+        return solid[col + row * cols] != 0;
+    }
+
+    // Célula de um ponto no espaço do sprite: cellX = floor(x / tileW),
+    // cellY = floor(y / tileH), contada de baixo para cima
+    bool isSolidCell(int cellX, int cellY) const { return isSolid(cellX, rows - 1 - cellY); }
+
+    int getCols() const { return cols; }
+    int getRows() const { return rows; }
+
+    // Move a caixa por delta, parando rente ao primeiro tile sólido de cada eixo.
+    SweepResult sweep(AABB &box, glm::vec2 delta) const {
+        SweepResult res;
+        res.hitX = res.hitY = false;
+        res.delta.x = sweepAxis(box, delta.x, 0, res.hitX);
+        box.min.x += res.delta.x;
+        box.max.x += res.delta.x;
+        res.delta.y = sweepAxis(box, delta.y, 1, res.hitY);
+        box.min.y += res.delta.y;
+        box.max.y += res.delta.y;
+        return res;
+    }
+
+    // Caixa de um sprite centrado em position com tamanho size (como o quad
+    // de -0.5..0.5 escalado do Sprite)
+    static AABB boxAt(glm::vec2 position, glm::vec2 size) {
+        AABB box;
+        box.min = glm::vec2(position.x - size.x * 0.5f, position.y - size.y * 0.5f);
+        box.max = glm::vec2(position.x + size.x * 0.5f, position.y + size.y * 0.5f);
+        return box;
+    }
+
+private:
+    // Folga para a caixa não ficar exatamente sobre a borda do tile
+    static constexpr float SKIN = 1e-3f;
+
+    float sweepAxis(const AABB &box, float d, int axis, bool &hit) const {
+        if (d == 0.0f) return 0.0f;
+        float size = axis == 0 ? tileW : tileH;
+        float otherSize = axis == 0 ? tileH : tileW;
+        float lo = axis == 0 ? box.min.x : box.min.y;
+        float hi = axis == 0 ? box.max.x : box.max.y;
+        float otherLo = axis == 0 ? box.min.y : box.min.x;
+        float otherHi = axis == 0 ? box.max.y : box.max.x;
+
+        // Faixa de células ocupada no eixo perpendicular
+        int firstOther = (int)std::floor((otherLo + SKIN) / otherSize);
+        int lastOther = (int)std::floor((otherHi - SKIN) / otherSize);
+
+        // Células atravessadas pela borda dianteira
+        float edge = d > 0.0f ? hi : lo;
+        int step = d > 0.0f ? 1 : -1;
+        int from = (int)std::floor((edge - step * SKIN) / size) + step;
+        int to = (int)std::floor((edge + d + step * SKIN) / size);
+        for (int cell = from; step > 0 ? cell <= to : cell >= to; cell += step) {
+            for (int o = firstOther; o <= lastOther; o++) {
+                bool blocked = axis == 0 ? isSolidCell(cell, o) : isSolidCell(o, cell);
+                if (blocked) {
+                    hit = true;
+                    float wall = d > 0.0f ? cell * size : (cell + 1) * size;
+                    float allowed = wall - edge;
+                    // Nunca recua: se já está encostado, fica onde está
+                    return d > 0.0f ? std::fmax(allowed - SKIN, 0.0f) : std::fmin(allowed + SKIN, 0.0f);
+                }
+            }
+        }
+        return d;
+    }
+
+    int cols, rows;
+    float tileW, tileH;
+    std::vector<unsigned char> solid;
+};
+
+#endif
@@ -0,0 +1,235 @@
+// TESTE DE REGRESSÃO DE RENDER (GOLDEN IMAGES)
+// Roda cada demo em modo de captura (FrameCapture.h: quadros fixos, relógio
+// fixo, janela invisível), lê os quadros gravados e compara cada um com a
+// imagem de referência de mesmo nome em --golden. Um pixel difere se algum
+// canal passa de --tolerance; o quadro falha se mais de --max-different
+// pixels diferirem, e então é gravado <quadro>_diff.ppm com o mapa de
+// calor (ImageDiff.h). A comparação é SIMD e os quadros são comparados em
+// paralelo, para rodar a cada build.
+//
+// uso: golden_check [--golden DIR] [--out DIR] [--tolerance T] [--max-different N]
+//                   [--update] [--no-run] [--headless] [--threads N] [demo ...]
+//
+// Roda no diretório de build (os demos procuram ../assets). --update grava
+// as capturas como novas referências; --no-run só compara as capturas que
+// já estão em --out. Sem GPU, use o Mesa e a plataforma nula da GLFW:
+//   LIBGL_ALWAYS_SOFTWARE=1 ./golden_check --headless
+//
+// As referências não vêm no repositório: o render depende do driver, então
+// cada máquina de CI gera as suas uma vez, a partir de um build conferido:
+//   LIBGL_ALWAYS_SOFTWARE=1 ./golden_check --headless --update
+// confere os quadros em ../assets/golden e faz commit deles. Sem referência
+// o quadro sai como SEM REFERÊNCIA e o teste falha. Um demo da lista que não
+// foi compilado, que falha ou que não grava nenhum quadro também falha.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ImageDiff.h"
+#include "ThreadPool.h"
+#include "ExemplosMoodle/M3_material/PPM.h"
+
+namespace fs = std::filesystem;
+
+#ifdef _WIN32
+static const char *EXE_SUFFIX = ".exe";
+#else
+static const char *EXE_SUFFIX = "";
+#endif
+
+// Demo, diretório de trabalho (relativo ao build), quadros e intervalo de gravação
+struct GoldenDemo {
+    const char *name;
+    const char *workDir;
+    int frames, every;
+};
+
+static const GoldenDemo DEMOS[] = {
+    { "JogoTimelap", ".", 3, 0 },
+    { "spriteMoving", ".", 120, 30 },
+    { "exemplo_05", ".", 240, 60 }, // parallax
+    { "exemplo_07", "../src/ExemplosMoodle/M6_material/exemplo", 3, 0 },
+};
+
+struct GoldenConfig {
+    std::string goldenDir = "../assets/golden";
+    std::string outDir = "golden_out";
+    int tolerance = 2;
+    size_t maxDifferent = 0;
+    bool update = false;
+    bool run = true;
+    bool headless = false;
+    unsigned threads = 0;
+    std::vector<std::string> demos;
+};
+
+enum GoldenResult { GOLDEN_OK, GOLDEN_DIFFERENT, GOLDEN_MISSING, GOLDEN_ERROR };
+
+struct FrameReport {
+    std::string name;
+    GoldenResult result = GOLDEN_ERROR;
+    ImageDiffStats stats;
+    std::string message;
+};
+
+static void usage() {
+    std::cout << "uso: golden_check [--golden DIR] [--out DIR] [--tolerance T] [--max-different N]\n"
+              << "                    [--update] [--no-run] [--headless] [--threads N] [demo ...]" << std::endl;
+}
+
+static bool parseArgs(int argc, char **argv, GoldenConfig &cfg) {
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (a == "--golden" && hasValue) cfg.goldenDir = argv[++i];
+        else if (a == "--out" && hasValue) cfg.outDir = argv[++i];
+        else if (a == "--tolerance" && hasValue) cfg.tolerance = atoi(argv[++i]);
+        else if (a == "--max-different" && hasValue) cfg.maxDifferent = (size_t)atol(argv[++i]);
+        else if (a == "--threads" && hasValue) cfg.threads = (unsigned)atoi(argv[++i]);
+        else if (a == "--update") cfg.update = true;
+        else if (a == "--no-run") cfg.run = false;
+        else if (a == "--headless") cfg.headless = true;
+        else if (a[0] == '-') return false;
+        else cfg.demos.push_back(a);
+    }
+    return cfg.tolerance >= 0 && cfg.tolerance <= 255;
+}
+
+static bool selected(const GoldenConfig &cfg, const std::string &name) {
+    return cfg.demos.empty() || std::find(cfg.demos.begin(), cfg.demos.end(), name) != cfg.demos.end();
+}
+
+// Roda o demo em modo de captura; false se o executável não existe ou se
+// o demo falhou
+static bool captureDemo(const GoldenDemo &demo, const GoldenConfig &cfg, bool &missing) {
+    fs::path exe = fs::absolute(std::string(demo.name) + EXE_SUFFIX);
+    missing = !fs::exists(exe);
+    if (missing) return false;
+    // capturas antigas do demo saem antes de rodar de novo
+    std::error_code ec;
+    for (const fs::directory_entry &e : fs::directory_iterator(cfg.outDir, ec)) {
+        std::string file = e.path().filename().string();
+        if (file.rfind(std::string(demo.name) + "_", 0) == 0 && e.path().extension() == ".ppm") fs::remove(e.path(), ec);
+    }
+    fs::path out = fs::absolute(cfg.outDir), log = out / (std::string(demo.name) + ".log");
+    std::string command = "cd \"" + fs::absolute(demo.workDir).string() + "\" && \"" + exe.string() + "\" --capture \"" +
+                          out.string() + "\" --frames " + std::to_string(demo.frames) + " --every " +
+                          std::to_string(demo.every) + (cfg.headless ? " --headless" : "") + " > \"" + log.string() +
+                          "\" 2>&1";
+    return std::system(command.c_str()) == 0;
+}
+
+static FrameReport compareFrame(const fs::path &capture, const GoldenConfig &cfg) {
+    FrameReport r;
+    r.name = capture.filename().string();
+    fs::path golden = fs::path(cfg.goldenDir) / r.name;
+    if (cfg.update) {
+        std::error_code ec;
+        fs::copy_file(capture, golden, fs::copy_options::overwrite_existing, ec);
+        r.result = ec ? GOLDEN_ERROR : GOLDEN_OK;
+        r.message = ec ? "erro ao gravar a referência" : "referência atualizada";
+        return r;
+    }
+    if (!fs::exists(golden)) {
+        r.result = GOLDEN_MISSING;
+        r.message = "sem referência (rode com --update)";
+        return r;
+    }
+    PPMImage a, b;
+    if (!a.load(golden.string()) || !b.load(capture.string())) {
+        r.message = "erro de leitura";
+        return r;
+    }
+    a.toRGB();
+    b.toRGB();
+    if (a.width != b.width || a.height != b.height || a.bytesPerSample() != 1 || b.bytesPerSample() != 1) {
+        r.result = GOLDEN_DIFFERENT;
+        r.message = "tamanho " + std::to_string(b.width) + "x" + std::to_string(b.height) + ", referência " +
+                    std::to_string(a.width) + "x" + std::to_string(a.height);
+        return r;
+    }
+    r.stats = compareImages(a.data, b.data, a.width, a.height, 3, cfg.tolerance);
+    r.result = r.stats.different > cfg.maxDifferent ? GOLDEN_DIFFERENT : GOLDEN_OK;
+    if (r.result == GOLDEN_DIFFERENT) {
+        std::vector<unsigned char> heat;
+        diffHeatmap(a.data, b.data, a.width, a.height, 3, cfg.tolerance, heat);
+        fs::path heatPath = fs::path(cfg.outDir) / (capture.stem().string() + "_diff.ppm");
+        bool saved = savePPMBinary(heatPath.string(), heat.data(), a.width, a.height, 3, "golden_check: mapa de calor");
+        r.message = saved ? "mapa de calor em " + heatPath.string() : "erro ao gravar o mapa de calor";
+    }
+    return r;
+}
+
+int main(int argc, char **argv) {
+    GoldenConfig cfg;
+    if (!parseArgs(argc, argv, cfg)) {
+        usage();
+        return EXIT_FAILURE;
+    }
+    std::error_code ec;
+    fs::create_directories(cfg.outDir, ec);
+    if (cfg.update) fs::create_directories(cfg.goldenDir, ec);
+
+    bool ok = true;
+    if (cfg.run) {
+        for (const GoldenDemo &demo : DEMOS) {
+            if (!selected(cfg, demo.name)) continue;
+            bool missing;
+            bool ran = captureDemo(demo, cfg, missing);
+            std::cout << demo.name << ": "
+                      << (missing ? "FALHOU (executável não encontrado)" : ran ? "capturado" : "FALHOU (ver o .log)")
+                      << std::endl;
+            ok = ok && ran;
+        }
+    }
+
+    // quadros capturados dos demos escolhidos (sem os mapas de calor)
+    std::vector<fs::path> captures;
+    std::vector<size_t> perDemo(sizeof(DEMOS) / sizeof(DEMOS[0]), 0);
+    for (const fs::directory_entry &e : fs::directory_iterator(cfg.outDir, ec)) {
+        std::string stem = e.path().stem().string();
+        if (e.path().extension() != ".ppm" || stem.size() < 5 || stem.compare(stem.size() - 5, 5, "_diff") == 0) continue;
+        for (size_t d = 0; d < perDemo.size(); d++) {
+            if (selected(cfg, DEMOS[d].name) && stem.rfind(std::string(DEMOS[d].name) + "_", 0) == 0) {
+                captures.push_back(e.path());
+                perDemo[d]++;
+            }
+        }
+    }
+    std::sort(captures.begin(), captures.end());
+    for (size_t d = 0; d < perDemo.size(); d++) {
+        if (selected(cfg, DEMOS[d].name) && perDemo[d] == 0) {
+            std::cout << DEMOS[d].name << ": FALHOU (nenhum quadro em " << cfg.outDir << ")" << std::endl;
+            ok = false;
+        }
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<FrameReport> reports(captures.size());
+    ThreadPool pool(cfg.threads);
+    pool.run(captures.size(), [&](size_t i) { reports[i] = compareFrame(captures[i], cfg); });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    size_t passed = 0;
+    double megapixels = 0.0;
+    for (const FrameReport &r : reports) {
+        static const char *labels[] = { "ok", "DIFERENTE", "SEM REFERÊNCIA", "ERRO" };
+        std::printf("%-32s %-14s", r.name.c_str(), labels[r.result]);
+        if (r.stats.pixels) {
+            std::printf(" %zu px diferentes, máx %d, média %.3f", r.stats.different, r.stats.maxDiff, r.stats.meanDiff);
+        }
+        std::printf("%s%s\n", r.message.empty() ? "" : "  ", r.message.c_str());
+        passed += r.result == GOLDEN_OK;
+        megapixels += r.stats.pixels / 1e6;
+    }
+    std::printf("%zu de %zu quadros ok, SIMD: %s, %.1f MP comparados em %.3f s\n", passed, reports.size(),
+                simdLevelName(activeSimdLevel()), megapixels, seconds);
+    if (reports.empty()) std::cout << "Nenhuma captura em " << cfg.outDir << std::endl;
+    return ok && passed == reports.size() && !reports.empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <string>
+#include <vector>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
@@ -8,21 +9,42 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 #include "Sprite.h"
+#include "TileCollision.h"
+#include "FrameCapture.h"
+#include "TextureLoader.h"
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
-GLuint loadTexture(const char* path);
+void processInput(GLFWwindow* window, float dt);
+void drawWalls();
 GLuint createShaderProgram();
 
 const GLuint WIDTH = 800, HEIGHT = 600;
 
+// Simulação em passo fixo: a velocidade não depende da taxa de
+// repetição de teclas do SO nem da taxa de quadros
+const double SIM_DT = 1.0 / 120.0;
+const double MAX_FRAME_TIME = 0.25;
+
 Sprite sprite;
-float moveSpeed = 5.0f;
+float moveSpeed = 150.0f; // pixels por segundo
+
+// Paredes: tiles não caminháveis do map.txt, com a linha 0 no alto da tela
+const float TILE_SIZE = 40.0f;
+const glm::vec2 PLAYER_BOX(30.0f, 30.0f); // caixa de colisão, menor que o quadro do sprite
+TileCollisionMap walls;
+bool hasWalls = false;
+Sprite wall;
+
+int main(int argc, char** argv) {
+    // Modo de captura dos testes de regressão (golden_check)
+    FrameCapture capture;
+    capture.parse(argc, argv, "spriteMoving");
 
-int main() {
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    capture.windowHints();
     
     GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "Sprite Controller - Use WASD para mover e rotacionar", nullptr, nullptr);
     if (!window) {
@@ -33,6 +55,7 @@ int main() {
     
     glfwMakeContextCurrent(window);
     glfwSetKeyCallback(window, key_callback);
+    glfwSwapInterval(capture.active() ? 0 : 1); // vsync; com 0 o render fica livre e a velocidade não muda
     
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
         std::cout << "Failed to initialize GLAD" << std::endl;
@@ -41,32 +64,79 @@ int main() {
     
     glViewport(0, 0, WIDTH, HEIGHT);
     glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Texturas com alfa pré-multiplicado (cor-chave na carga)
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
     
     GLuint shaderProgram = createShaderProgram();
     
-    GLuint texture = loadTexture("../assets/sprites/Walk.png");
-    if (texture == 0) {
-        std::cout << "Aviso: Textura não carregada. Verifique o caminho da imagem." << std::endl;
-    }
+    // Decodificada em outra thread; até chegar o sprite usa o placeholder
+    // transparente. O fundo branco vira alfa real na carga, uma vez só, e o
+    // fragment shader não precisa de discard.
+    TextureLoader textures;
+    TextureOptions spriteOptions;
+    spriteOptions.flipVertically = true;
+    spriteOptions.colorKey = true;
+    spriteOptions.mipmaps = true;
+    GLuint texture = textures.load("../assets/sprites/Walk.png", spriteOptions);
+    if (capture.active()) textures.finish();
     
     sprite.initialize(shaderProgram, 1, 6);
     sprite.setTexture(texture);
+    sprite.setViewSize((float)WIDTH, (float)HEIGHT);
     sprite.setScale(glm::vec3(120.0f, 120.0f, 1.0f));
     sprite.setPosition(glm::vec3(400.0f, 300.0f, 0.0f));
     
+    std::vector<TileProps> tileProps;
+    hasWalls = loadTileProps("../assets/config/tileProps.cfg.txt", tileProps) &&
+               walls.loadMap("../assets/config/map.txt", tileProps, TILE_SIZE, TILE_SIZE);
+    if (!hasWalls) {
+        std::cout << "Aviso: mapa não carregado, o sprite anda sem paredes." << std::endl;
+    }
+    // Cada parede é um quad de cor sólida (textura 1x1 opaca)
+    const unsigned char wallColor[4] = { 70, 70, 80, 255 };
+    GLuint wallTexture;
+    glGenTextures(1, &wallTexture);
+    glBindTexture(GL_TEXTURE_2D, wallTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, wallColor);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    wall.initialize(shaderProgram, 1, 1);
+    wall.setTexture(wallTexture);
+    wall.setViewSize((float)WIDTH, (float)HEIGHT);
+    wall.setScale(glm::vec3(TILE_SIZE, TILE_SIZE, 1.0f));
+    
     std::cout << "Use WASD ou setas para mover o sprite!" << std::endl;
     
+    double previousTime = capture.time();
+    double accumulator = 0.0;
+    
     while (!glfwWindowShouldClose(window)) {
         glfwPollEvents();
+        textures.update();
+        
+        double currentTime = capture.time();
+        double frameTime = currentTime - previousTime;
+        previousTime = currentTime;
+        if (frameTime > MAX_FRAME_TIME) {
+            frameTime = MAX_FRAME_TIME; // evita a "espiral da morte" após travadas
+        }
+        accumulator += frameTime;
         
-        sprite.update();
+        while (accumulator >= SIM_DT) {
+            sprite.savePreviousState();
+            if (capture.inputEnabled()) processInput(window, (float)SIM_DT);
+            sprite.update((float)SIM_DT);
+            accumulator -= SIM_DT;
+        }
         
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
         
-        sprite.render();
+        if (hasWalls) drawWalls();
+        // Interpola entre o estado anterior e o atual
+        sprite.render((float)(accumulator / SIM_DT));
         
+        capture.endFrame(window);
         glfwSwapBuffers(window);
     }
     
@@ -79,123 +149,62 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         glfwSetWindowShouldClose(window, GL_TRUE);
         return;
     }
+}
+
+// Amostra as teclas pressionadas a cada passo fixo da simulação. O passo é
+// varrido contra as paredes do mapa: o sprite para rente a elas e desliza
+// no eixo livre.
+void processInput(GLFWwindow* window, float dt) {
+    float step = moveSpeed * dt;
+    glm::vec2 delta(0.0f, 0.0f);
+    bool pressed = false;
+    
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) {
+        sprite.setDirection(GLFW_KEY_W);
+        delta.y += step;
+        pressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) {
+        sprite.setDirection(GLFW_KEY_S);
+        delta.y -= step;
+        pressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) {
+        sprite.setDirection(GLFW_KEY_A);
+        delta.x -= step;
+        pressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) {
+        sprite.setDirection(GLFW_KEY_D);
+        delta.x += step;
+        pressed = true;
+    }
+    if (!pressed) return;
     
-    if (action == GLFW_PRESS || action == GLFW_REPEAT) {
-        sprite.setDirection(key);
-        
-        switch (key) {
-            case GLFW_KEY_W:
-            case GLFW_KEY_UP:
-                sprite.moveUp(moveSpeed);
-                sprite.setAnimation(0);
-                break;
-            case GLFW_KEY_S:
-            case GLFW_KEY_DOWN:
-                sprite.moveDown(moveSpeed);
-                sprite.setAnimation(0);
-                break;
-            case GLFW_KEY_A:
-            case GLFW_KEY_LEFT:
-                sprite.moveLeft(moveSpeed);
-                sprite.setAnimation(0);
-                break;
-            case GLFW_KEY_D:
-            case GLFW_KEY_RIGHT:
-                sprite.moveRight(moveSpeed);
-                sprite.setAnimation(0);
-                break;
-        }
+    sprite.setAnimation(0);
+    if (hasWalls) {
+        AABB box = TileCollisionMap::boxAt(glm::vec2(sprite.getPosition()), PLAYER_BOX);
+        delta = walls.sweep(box, delta).delta;
     }
+    sprite.moveRight(delta.x);
+    sprite.moveUp(delta.y);
 }
 
-GLuint loadTexture(const char* path) {
-    GLuint textureID;
-    glGenTextures(1, &textureID);
-    
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 0);
-    
-    if (data) {
-        GLenum format;
-        if (nrChannels == 1)
-            format = GL_RED;
-        else if (nrChannels == 3)
-            format = GL_RGB;
-        else if (nrChannels == 4)
-            format = GL_RGBA;
-        
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        
-        std::cout << "Textura carregada: " << width << "x" << height << " canais: " << nrChannels << std::endl;
-    } else {
-        std::cout << "Falha ao carregar textura: " << path << std::endl;
-        textureID = 0;
+// Tiles sólidos; a linha 0 do mapa fica no alto da tela
+void drawWalls() {
+    int rows = walls.getRows();
+    for (int row = 0; row < rows; row++) {
+        for (int col = 0; col < walls.getCols(); col++) {
+            if (!walls.isSolid(col, row)) continue;
+            wall.setPosition(glm::vec3((col + 0.5f) * TILE_SIZE, (rows - 1 - row + 0.5f) * TILE_SIZE, 0.0f));
+            wall.render();
+        }
     }
-    
-    stbi_image_free(data);
-    return textureID;
 }
 
 GLuint createShaderProgram() {
-    const char* vertexShaderSource = R"(
-        #version 330 core
-        layout (location = 0) in vec3 aPos;
-        layout (location = 1) in vec2 aTexCoord;
-        
-        out vec2 TexCoord;
-        
-        uniform mat4 model;
-        uniform mat4 projection;
-        uniform float offsetX;
-        uniform float offsetY;
-        uniform float nFrames;
-        uniform float nAnimations;
-        uniform int flipX;
-        
-        void main() {
-            gl_Position = projection * model * vec4(aPos, 1.0);
-            
-            vec2 spriteSize = vec2(1.0 / nFrames, 1.0 / nAnimations);
-            
-            float texCoordX = aTexCoord.x;
-            if (flipX == 1) {
-                texCoordX = 1.0 - aTexCoord.x;
-            }
-            
-            TexCoord = vec2(
-                (texCoordX * spriteSize.x) + offsetX,
-                (aTexCoord.y * spriteSize.y) + offsetY
-            );
-        }
-    )";
-    
-    const char* fragmentShaderSource = R"(
-        #version 330 core
-        out vec4 FragColor;
-        
-        in vec2 TexCoord;
-        uniform sampler2D texture1;
-        
-        void main() {
-            vec4 texColor = texture(texture1, TexCoord);
-            
-            if(texColor.a < 0.1)
-                discard;
-                
-            if(texColor.r > 0.95 && texColor.g > 0.95 && texColor.b > 0.95)
-                discard;
-                
-            FragColor = texColor;
-        }
-    )";
+    const char* vertexShaderSource = Sprite::vertexShaderSource();
+    const char* fragmentShaderSource = Sprite::fragmentShaderSource();
     
     GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
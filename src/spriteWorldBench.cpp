@@ -0,0 +1,125 @@
+// BENCHMARK DO SPRITEWORLD
+// Compara a montagem das matrizes de modelo objeto a objeto com glm
+// (como em Sprite::render) com o caminho em lote do SpriteWorld, nos níveis
+// escalar, SSE2 e AVX2, para 1k até 1M sprites. Não precisa de contexto GL.
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+#include "SpriteWorld.h"
+
+// Layout "array de structs" equivalente aos campos do Sprite
+struct SpriteAoS {
+    glm::vec3 position;
+    glm::vec3 scale;
+    float angle;
+};
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double secondsSince(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+// Repete a medição até somar pelo menos ~0.2 s e devolve o melhor tempo
+template <typename F>
+static double bestOf(F func) {
+    double best = 1e30, total = 0.0;
+    int runs = 0;
+    while (runs < 3 || (total < 0.2 && runs < 1000)) {
+        Clock::time_point t0 = Clock::now();
+        func();
+        double t = secondsSince(t0);
+        best = std::min(best, t);
+        total += t;
+        runs++;
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    std::vector<size_t> counts = { 1000, 10000, 100000, 1000000 };
+    if (argc > 1) {
+        counts.clear();
+        for (int i = 1; i < argc; i++) counts.push_back((size_t)atol(argv[i]));
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> px(0.0f, 800.0f), py(0.0f, 600.0f);
+    std::uniform_real_distribution<float> sc(16.0f, 128.0f), ang(-180.0f, 180.0f), vel(-100.0f, 100.0f);
+
+    std::cout << "cpu simd: " << simdLevelName(detectSimdLevel()) << std::endl;
+    std::cout << std::setw(9) << "sprites" << std::setw(10) << "caminho"
+              << std::setw(14) << "ns/sprite" << std::setw(12) << "speedup" << std::setw(14) << "erro max" << std::endl;
+
+    for (size_t n : counts) {
+        std::vector<SpriteAoS> aos(n);
+        SpriteWorld world;
+        world.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            aos[i].position = glm::vec3(px(rng), py(rng), 0.0f);
+            aos[i].scale = glm::vec3(sc(rng), sc(rng), 1.0f);
+            aos[i].angle = ang(rng);
+            int id = world.add(aos[i].position, aos[i].scale, aos[i].angle);
+            world.setVelocity(id, glm::vec2(vel(rng), vel(rng)));
+        }
+
+        // Referência: uma mat4 por objeto, como Sprite::render()
+        std::vector<float> reference(n * SpriteWorld::FLOATS_PER_TRANSFORM);
+        double tGlm = bestOf([&]() {
+            float *out = reference.data();
+            for (size_t i = 0; i < n; i++, out += SpriteWorld::FLOATS_PER_TRANSFORM) {
+                glm::mat4 model = glm::mat4(1.0f);
+                model = glm::translate(model, aos[i].position);
+                model = glm::rotate(model, glm::radians(aos[i].angle), glm::vec3(0.0f, 0.0f, 1.0f));
+                model = glm::scale(model, aos[i].scale);
+                memcpy(out, glm::value_ptr(model), sizeof(float) * SpriteWorld::FLOATS_PER_TRANSFORM);
+            }
+        });
+        std::cout << std::setw(9) << n << std::setw(10) << "glm"
+                  << std::setw(14) << std::fixed << std::setprecision(2) << tGlm * 1e9 / n
+                  << std::setw(12) << "1.00x" << std::setw(14) << "-" << std::endl;
+
+        SimdLevel levels[] = { SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2 };
+        for (SimdLevel level : levels) {
+            if (level > detectSimdLevel()) continue;
+            setSimdLevel(level);
+            double t = bestOf([&]() { world.buildTransforms(); });
+
+            const float *m = world.getTransforms();
+            double maxErr = 0.0;
+            for (size_t i = 0; i < n * SpriteWorld::FLOATS_PER_TRANSFORM; i++) {
+                maxErr = std::max(maxErr, (double)std::fabs(m[i] - reference[i]));
+            }
+            std::cout << std::setw(9) << n << std::setw(10) << simdLevelName(level)
+                      << std::setw(14) << std::setprecision(2) << t * 1e9 / n
+                      << std::setw(11) << std::setprecision(2) << tGlm / t << "x"
+                      << std::setw(14) << std::scientific << std::setprecision(1) << maxErr
+                      << std::fixed << std::endl;
+        }
+
+        // Integração de posições (um passo de 1/60 s)
+        for (SimdLevel level : levels) {
+            if (level > detectSimdLevel()) continue;
+            setSimdLevel(level);
+            double t = bestOf([&]() { world.update(1.0f / 60.0f); });
+            std::cout << std::setw(9) << n << std::setw(10) << simdLevelName(level)
+                      << std::setw(14) << std::setprecision(2) << t * 1e9 / n
+                      << std::setw(12) << "update" << std::setw(14) << "-" << std::endl;
+        }
+        setSimdLevel(detectSimdLevel());
+    }
+    return 0;
+}
@@ -0,0 +1,387 @@
+// BENCHMARK DE ESTRESSE DE SPRITES
+// Cria N sprites animados com movimento aleatório e roda um número fixo de
+// quadros num framebuffer offscreen, medindo:
+//   - tempo de CPU por quadro (update + submissão dos comandos GL)
+//   - tempo de GPU por quadro (GL_TIME_ELAPSED, lido com atraso para não travar)
+//   - número de draw calls por quadro
+// e reporta percentis em CSV ou JSON.
+//
+// Modos:
+//   --mode sprite   um Sprite (Sprite.h) por objeto, um draw call cada
+//   --mode world    SpriteWorld (SoA + instancing), um draw call no total
+//
+// Para rodar sem GPU (CI), use o driver de software do Mesa:
+//   LIBGL_ALWAYS_SOFTWARE=1 GALLIUM_DRIVER=llvmpipe ./sprite_bench --headless
+// --headless usa a plataforma "null" da GLFW 3.4 com contexto OSMesa, sem
+// servidor gráfico; sem essa opção é criada uma janela invisível.
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Sprite.h"
+#include "SpriteWorld.h"
+
+struct BenchConfig {
+    int sprites = 1000;
+    int frames = 600;
+    int warmup = 60;
+    int width = 800, height = 600;
+    std::string mode = "sprite";
+    std::string format = "csv";
+    std::string output;
+    bool headless = false;
+    unsigned seed = 42;
+};
+
+// Amostras por quadro
+struct FrameSample {
+    double cpuMs;
+    double gpuMs;
+    int drawCalls;
+};
+
+static const int QUERY_LATENCY = 4; // quadros de atraso na leitura do timer
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static void usage() {
+    std::cout << "uso: sprite_bench [--sprites N] [--frames F] [--warmup W] [--mode sprite|world]\n"
+              << "                    [--size LxA] [--format csv|json] [--out arquivo] [--headless] [--seed S]"
+              << std::endl;
+}
+
+static bool parseArgs(int argc, char **argv, BenchConfig &cfg) {
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (a == "--sprites" && hasValue) cfg.sprites = atoi(argv[++i]);
+        else if (a == "--frames" && hasValue) cfg.frames = atoi(argv[++i]);
+        else if (a == "--warmup" && hasValue) cfg.warmup = atoi(argv[++i]);
+        else if (a == "--mode" && hasValue) cfg.mode = argv[++i];
+        else if (a == "--format" && hasValue) cfg.format = argv[++i];
+        else if (a == "--out" && hasValue) cfg.output = argv[++i];
+        else if (a == "--seed" && hasValue) cfg.seed = (unsigned)atoi(argv[++i]);
+        else if (a == "--size" && hasValue) {
+            if (sscanf(argv[++i], "%dx%d", &cfg.width, &cfg.height) != 2) return false;
+        }
+        else if (a == "--headless") cfg.headless = true;
+        else return false;
+    }
+    return cfg.sprites > 0 && cfg.frames > 0 && cfg.warmup >= 0 && cfg.width > 0 && cfg.height > 0 &&
+           (cfg.mode == "sprite" || cfg.mode == "world") &&
+           (cfg.format == "csv" || cfg.format == "json");
+}
+
+static GLuint compileProgram(const char *vertexShaderSource, const char *fragmentShaderSource) {
+    int success;
+    char infoLog[512];
+
+    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
+    glCompileShader(vertexShader);
+    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
+        std::cerr << "Erro vertex shader: " << infoLog << std::endl;
+    }
+
+    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
+    glCompileShader(fragmentShader);
+    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
+        std::cerr << "Erro fragment shader: " << infoLog << std::endl;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        std::cerr << "Erro linking shader: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    return program;
+}
+
+// Spritesheet procedural (6 quadros x 1 animação) para não depender de assets
+static GLuint createSheetTexture() {
+    const int frameW = 32, frameH = 32, nFrames = 6;
+    const int w = frameW * nFrames, h = frameH;
+    std::vector<unsigned char> rgba(w * h * 4);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            unsigned char *p = &rgba[(y * w + x) * 4];
+            int f = x / frameW;
+            int lx = x % frameW - frameW / 2, ly = y - frameH / 2;
+            bool inside = lx * lx + ly * ly < (frameW / 2 - 1) * (frameW / 2 - 1);
+            p[0] = inside ? (unsigned char)(40 * f) : 0;
+            p[1] = inside ? (unsigned char)(255 - 30 * f) : 0;
+            p[2] = inside ? 128 : 0;
+            p[3] = inside ? 255 : 0;
+        }
+    }
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return tex;
+}
+
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    double idx = p / 100.0 * (v.size() - 1);
+    size_t lo = (size_t)idx;
+    size_t hi = std::min(lo + 1, v.size() - 1);
+    double t = idx - lo;
+    return v[lo] * (1.0 - t) + v[hi] * t;
+}
+
+static void writeReport(std::ostream &out, const BenchConfig &cfg, const std::vector<FrameSample> &samples,
+                        const char *renderer, bool gpuTimer) {
+    std::vector<double> cpu, gpu, draws;
+    for (const FrameSample &s : samples) {
+        cpu.push_back(s.cpuMs);
+        if (gpuTimer) gpu.push_back(s.gpuMs);
+        draws.push_back(s.drawCalls);
+    }
+    const double pcts[] = { 50.0, 90.0, 99.0 };
+
+    struct Metric { const char *name; const std::vector<double> *v; };
+    Metric metrics[] = { { "cpu_ms", &cpu }, { "gpu_ms", &gpu }, { "draw_calls", &draws } };
+
+    if (cfg.format == "csv") {
+        out << "mode,sprites,frames,renderer,metric,min,p50,p90,p99,max,mean\n";
+        for (const Metric &m : metrics) {
+            if (m.v->empty()) continue;
+            double sum = 0.0;
+            for (double x : *m.v) sum += x;
+            out << cfg.mode << "," << cfg.sprites << "," << samples.size() << ",\"" << renderer << "\","
+                << m.name << "," << percentile(*m.v, 0.0);
+            for (double p : pcts) out << "," << percentile(*m.v, p);
+            out << "," << percentile(*m.v, 100.0) << "," << sum / m.v->size() << "\n";
+        }
+    } else {
+        out << "{\n  \"mode\": \"" << cfg.mode << "\",\n  \"sprites\": " << cfg.sprites
+            << ",\n  \"frames\": " << samples.size() << ",\n  \"renderer\": \"" << renderer << "\"";
+        for (const Metric &m : metrics) {
+            if (m.v->empty()) continue;
+            double sum = 0.0;
+            for (double x : *m.v) sum += x;
+            out << ",\n  \"" << m.name << "\": { \"min\": " << percentile(*m.v, 0.0);
+            for (double p : pcts) out << ", \"p" << (int)p << "\": " << percentile(*m.v, p);
+            out << ", \"max\": " << percentile(*m.v, 100.0) << ", \"mean\": " << sum / m.v->size() << " }";
+        }
+        out << "\n}\n";
+    }
+}
+
+int main(int argc, char **argv) {
+    BenchConfig cfg;
+    if (!parseArgs(argc, argv, cfg)) {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    if (cfg.headless) {
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    }
+    if (!glfwInit()) {
+        std::cerr << "GLFW Init falhou" << std::endl;
+        return EXIT_FAILURE;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    if (cfg.headless) {
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+    }
+
+    GLFWwindow *window = glfwCreateWindow(cfg.width, cfg.height, "sprite_bench", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Falha ao criar contexto GL" << (cfg.headless ? " (OSMesa disponível?)" : "") << std::endl;
+        glfwTerminate();
+        return EXIT_FAILURE;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const char *renderer = (const char *)glGetString(GL_RENDERER);
+
+    // Framebuffer offscreen com tamanho fixo, independente da janela
+    GLuint fbo, colorTex;
+    glGenFramebuffers(1, &fbo);
+    glGenTextures(1, &colorTex);
+    glBindTexture(GL_TEXTURE_2D, colorTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, cfg.width, cfg.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTex, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Framebuffer incompleto" << std::endl;
+        return EXIT_FAILURE;
+    }
+    glViewport(0, 0, cfg.width, cfg.height);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    GLuint sheet = createSheetTexture();
+    const int nFrames = 6;
+
+    // Estado de movimento aleatório (compartilhado pelos dois modos)
+    std::mt19937 rng(cfg.seed);
+    const float viewW = (float)cfg.width, viewH = (float)cfg.height;
+    std::uniform_real_distribution<float> px(0.0f, viewW), py(0.0f, viewH);
+    std::uniform_real_distribution<float> vel(-200.0f, 200.0f), size(16.0f, 64.0f);
+    std::vector<glm::vec3> positions(cfg.sprites);
+    std::vector<glm::vec2> velocities(cfg.sprites);
+
+    std::vector<Sprite *> sprites;
+    SpriteWorld *world = new SpriteWorld(); // destruído antes do contexto
+    GLuint program;
+    if (cfg.mode == "sprite") {
+        program = compileProgram(Sprite::vertexShaderSource(), Sprite::fragmentShaderSource());
+        sprites.reserve(cfg.sprites);
+    } else {
+        program = compileProgram(SpriteWorld::vertexShaderSource(), SpriteWorld::fragmentShaderSource());
+        world->initialize(program, 1, nFrames);
+        world->setTexture(sheet);
+        world->reserve(cfg.sprites);
+    }
+    for (int i = 0; i < cfg.sprites; i++) {
+        positions[i] = glm::vec3(px(rng), py(rng), 0.0f);
+        velocities[i] = glm::vec2(vel(rng), vel(rng));
+        float s = size(rng);
+        if (cfg.mode == "sprite") {
+            Sprite *sp = new Sprite();
+            sp->initialize(program, 1, nFrames);
+            sp->setTexture(sheet);
+            sp->setViewSize(viewW, viewH);
+            sp->setScale(glm::vec3(s, s, 1.0f));
+            sp->setPosition(positions[i]);
+            sprites.push_back(sp);
+        } else {
+            int id = world->add(positions[i], glm::vec3(s, s, 1.0f));
+            world->setVelocity(id, velocities[i]);
+        }
+    }
+    glm::mat4 projection = glm::ortho(0.0f, viewW, 0.0f, viewH, -1.0f, 1.0f);
+
+    GLuint queries[QUERY_LATENCY];
+    glGenQueries(QUERY_LATENCY, queries);
+
+    const float dt = 1.0f / 60.0f;
+    int totalFrames = cfg.warmup + cfg.frames;
+    std::vector<FrameSample> samples;
+    samples.reserve(totalFrames);
+    bool gpuTimer = true;
+
+    for (int frame = 0; frame < totalFrames; frame++) {
+        Clock::time_point t0 = Clock::now();
+        glBeginQuery(GL_TIME_ELAPSED, queries[frame % QUERY_LATENCY]);
+
+        int drawCalls = 0;
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        if (cfg.mode == "sprite") {
+            // Movimento com rebatimento nas bordas, um objeto por vez
+            for (int i = 0; i < cfg.sprites; i++) {
+                glm::vec3 &p = positions[i];
+                glm::vec2 &v = velocities[i];
+                p.x += v.x * dt;
+                p.y += v.y * dt;
+                if (p.x < 0.0f || p.x > viewW) v.x = -v.x;
+                if (p.y < 0.0f || p.y > viewH) v.y = -v.y;
+                if (v.x > 0.0f) sprites[i]->moveRight(v.x * dt); else sprites[i]->moveLeft(-v.x * dt);
+                if (v.y > 0.0f) sprites[i]->moveUp(v.y * dt); else sprites[i]->moveDown(-v.y * dt);
+                sprites[i]->update(dt);
+                sprites[i]->render();
+                drawCalls++;
+            }
+        } else {
+            world->update(dt);
+            for (int i = 0; i < cfg.sprites; i++) {
+                glm::vec3 p = world->getPosition(i);
+                glm::vec2 &v = velocities[i];
+                if ((p.x < 0.0f && v.x < 0.0f) || (p.x > viewW && v.x > 0.0f)) v.x = -v.x;
+                if ((p.y < 0.0f && v.y < 0.0f) || (p.y > viewH && v.y > 0.0f)) v.y = -v.y;
+                world->setVelocity(i, v);
+            }
+            world->render(projection);
+            drawCalls++;
+        }
+
+        glEndQuery(GL_TIME_ELAPSED);
+        glFlush();
+        double cpuMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+        FrameSample s;
+        s.cpuMs = cpuMs;
+        s.gpuMs = 0.0;
+        s.drawCalls = drawCalls;
+        samples.push_back(s);
+
+        // Lê o timer de QUERY_LATENCY-1 quadros atrás (já deve estar pronto)
+        int older = frame - (QUERY_LATENCY - 1);
+        if (older >= 0) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(queries[older % QUERY_LATENCY], GL_QUERY_RESULT, &ns);
+            samples[older].gpuMs = ns / 1e6;
+        }
+        glfwPollEvents();
+    }
+    // Resultados pendentes
+    for (int older = std::max(0, totalFrames - (QUERY_LATENCY - 1)); older < totalFrames; older++) {
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(queries[older % QUERY_LATENCY], GL_QUERY_RESULT, &ns);
+        samples[older].gpuMs = ns / 1e6;
+    }
+    if (glGetError() != GL_NO_ERROR) {
+        gpuTimer = false;
+    }
+
+    std::vector<FrameSample> measured(samples.begin() + cfg.warmup, samples.end());
+    if (cfg.output.empty()) {
+        writeReport(std::cout, cfg, measured, renderer ? renderer : "?", gpuTimer);
+    } else {
+        std::ofstream out(cfg.output);
+        writeReport(out, cfg, measured, renderer ? renderer : "?", gpuTimer);
+    }
+
+    for (Sprite *sp : sprites) delete sp;
+    delete world;
+    glDeleteQueries(QUERY_LATENCY, queries);
+    glDeleteTextures(1, &sheet);
+    glDeleteTextures(1, &colorTex);
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteProgram(program);
+    glfwTerminate();
+    return EXIT_SUCCESS;
+}